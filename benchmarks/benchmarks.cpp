@@ -14,10 +14,14 @@
 // You should have received a copy of the GNU General Public License
 // along with Optimet. If not, see <http://www.gnu.org/licenses/>.
 
+#include "AuxCoefficients.h"
+#include "FMMBelosSolver.h"
+#include "FMMKrylovSolver.h"
 #include "Geometry.h"
 #include "PreconditionedMatrix.h"
 #include "Scatterer.h"
 #include "Solver.h"
+#include "Threads.h"
 #include "Tools.h"
 #include "Types.h"
 #include "cmdl.h"
@@ -27,6 +31,7 @@
 #include "mpi/Communicator.h"
 #include "mpi/FastMatrixMultiply.h"
 #include "mpi/Session.h"
+#include "scalapack/Tuning.h"
 #include <benchmark/benchmark.h>
 #include <chrono>
 #include <iostream>
@@ -51,6 +56,12 @@ OPTIMET_BENCHMARK(serial_problem_setup) {
 }
 #endif
 
+OPTIMET_BENCHMARK(source_vector_setup) {
+  OPTIMET_BENCHMARK_TIME_START;
+  source_vector(*input.geometry, input.excitation);
+  OPTIMET_BENCHMARK_TIME_END;
+}
+
 #ifdef OPTIMET_SCALAPACK
 OPTIMET_BENCHMARK(scalapack_problem_setup) {
   scalapack::Sizes const block_size = {64, 64};
@@ -139,6 +150,78 @@ OPTIMET_BENCHMARK(fmm_solver) {
   OPTIMET_BENCHMARK_TIME_END;
 }
 
+#ifdef OPTIMET_MPI
+//! Same as fmm_solver, with a block-Jacobi preconditioner
+OPTIMET_BENCHMARK(fmm_preconditioned_solver) {
+  input.belos_params->set("Solver", "GMRES");
+  input.belos_params->set("fmm", true);
+  Result result(input.geometry, input.excitation);
+  solver::FMMBelos const unpreconditioned(input);
+  input.solver_params.preconditioner = "block-jacobi";
+  solver::FMMBelos const solver(input);
+  unpreconditioned.solve(result.scatter_coef, result.internal_coef);
+  solver.solve(result.scatter_coef, result.internal_coef);
+  if(input.communicator.rank() == input.communicator.root_id())
+    std::cerr << "fmm_preconditioned_solver/" << state.range(0) << "/" << state.range(1) << ": "
+              << solver.iterations() << " iterations vs " << unpreconditioned.iterations()
+              << " unpreconditioned\n";
+
+  OPTIMET_BENCHMARK_TIME_START;
+  result.internal_coef.fill(0);
+  solver.solve(result.scatter_coef, result.internal_coef);
+  OPTIMET_BENCHMARK_TIME_END;
+}
+#endif
+
+#ifdef OPTIMET_MPI
+//! Same as fmm_solver, with s-step GMRES: run over several process counts for strong scaling
+OPTIMET_BENCHMARK(fmm_sstep_solver) {
+  input.belos_params->set("Solver", "s-step GMRES");
+  input.belos_params->set("fmm", true);
+  Result result(input.geometry, input.excitation);
+  solver::FMMBelos const solver(input);
+  solver.solve(result.scatter_coef, result.internal_coef);
+  if(input.communicator.rank() == input.communicator.root_id())
+    std::cerr << "fmm_sstep_solver/" << state.range(0) << "/" << state.range(1) << ": "
+              << solver.iterations() << " iterations on " << input.communicator.size()
+              << " processes, s = " << input.solver_params.sstep << "\n";
+
+  OPTIMET_BENCHMARK_TIME_START;
+  result.internal_coef.fill(0);
+  solver.solve(result.scatter_coef, result.internal_coef);
+  OPTIMET_BENCHMARK_TIME_END;
+}
+#endif
+
+//! Iteration counts with and without the p-multigrid preconditioner, as nMax grows
+OPTIMET_BENCHMARK(fmm_multigrid_solver) {
+  input.solver_params.preconditioner = "none";
+#ifdef OPTIMET_MPI
+  input.belos_params->set("Solver", "GMRES");
+  input.belos_params->set("fmm", true);
+  solver::FMMBelos const unpreconditioned(input);
+  input.solver_params.preconditioner = "p-multigrid";
+  solver::FMMBelos const solver(input);
+#else
+  input.solver_params.method = "fmm";
+  solver::FMMKrylov const unpreconditioned(input);
+  input.solver_params.preconditioner = "p-multigrid";
+  solver::FMMKrylov const solver(input);
+#endif
+  Result result(input.geometry, input.excitation);
+  unpreconditioned.solve(result.scatter_coef, result.internal_coef);
+  solver.solve(result.scatter_coef, result.internal_coef);
+  if(input.communicator.rank() == input.communicator.root_id())
+    std::cerr << "fmm_multigrid_solver/" << state.range(0) << "/" << state.range(1) << ": "
+              << solver.iterations() << " iterations vs " << unpreconditioned.iterations()
+              << " unpreconditioned, coarse nMax " << input.solver_params.coarse_nmax << "\n";
+
+  OPTIMET_BENCHMARK_TIME_START;
+  result.internal_coef.fill(0);
+  solver.solve(result.scatter_coef, result.internal_coef);
+  OPTIMET_BENCHMARK_TIME_END;
+}
+
 #ifndef OPTIMET_MPI
 OPTIMET_BENCHMARK(eigen_multiplication) {
   auto const Q = source_vector(*input.geometry, input.excitation);
@@ -158,8 +241,12 @@ OPTIMET_BENCHMARK(scalapack_multiplication) {
     return;
   }
   auto const N = input.geometry->scatterer_size();
-  auto const &context = input.context;
-  scalapack::Sizes const block_size = {64, 64};
+  auto const parallel = input.parallel_params.autotune ?
+                            scalapack::autotune(N, scalapack::Workload::multiplication,
+                                                input.communicator, input.parallel_params) :
+                            input.parallel_params;
+  auto const context = parallel.autotune ? scalapack::Context(parallel.grid) : input.context;
+  scalapack::Sizes const block_size = {parallel.block_size, parallel.block_size};
   auto const Q = distributed_source_vector(source_vector(*input.geometry, input.excitation),
                                            context, block_size);
   auto const S =
@@ -185,8 +272,7 @@ OPTIMET_BENCHMARK(fmm_multiplication) {
   mpi::FastMatrixMultiply const fmm(input.geometry->bground, input.excitation->wavenumber(),
                                     input.geometry->objects, input.fmm_subdiagonals,
                                     input.communicator);
-  auto const distribution =
-      mpi::details::vector_distribution(input.geometry->objects.size(), input.communicator.size());
+  auto const &distribution = fmm.distribution();
   auto const first = std::find(distribution.data(), distribution.data() + distribution.size(),
                                input.communicator.rank()) -
                      distribution.data();
@@ -207,6 +293,41 @@ OPTIMET_BENCHMARK(fmm_multiplication) {
   fmm(Q, result);
   OPTIMET_BENCHMARK_TIME_END;
 }
+
+//! Grid of points over which to compute vector spherical functions
+std::vector<Spherical<t_real>> field_grid(Run const &input, t_uint n = 10) {
+  auto const extent = 4 * input.geometry->objects.front().radius;
+  std::vector<Spherical<t_real>> result;
+  for(t_uint i(0); i < n; ++i)
+    for(t_uint j(0); j < n; ++j)
+      for(t_uint k(0); k < n; ++k)
+        result.push_back(Spherical<t_real>::toSpherical(
+            Cartesian<t_real>(extent * (2.0 * i / n - 1), extent * (2.0 * j / n - 1),
+                              extent * (2.0 * k / n - 1 + 0.5 / n))));
+  return result;
+}
+
+OPTIMET_BENCHMARK(aux_coefficients) {
+  auto const points = field_grid(input);
+  auto const nMax = input.geometry->nMax();
+  auto const waveK = input.excitation->waveK;
+
+  OPTIMET_BENCHMARK_TIME_START;
+  for(auto const &point : points)
+    benchmark::DoNotOptimize(AuxCoefficients(point, waveK, false, nMax).M(0));
+  OPTIMET_BENCHMARK_TIME_END;
+}
+
+OPTIMET_BENCHMARK(aux_coefficients_workspace) {
+  auto const points = field_grid(input);
+  auto const waveK = input.excitation->waveK;
+  AuxCoefficientsWorkspace workspace(input.geometry->nMax());
+
+  OPTIMET_BENCHMARK_TIME_START;
+  for(auto const &point : points)
+    benchmark::DoNotOptimize(workspace.compute(point, waveK, false).M()(0, 0));
+  OPTIMET_BENCHMARK_TIME_END;
+}
 }
 }
 
@@ -221,12 +342,14 @@ int main(int argc, char **argv) {
       convert_string<t_uint>(parameters->get<std::string>("nharmonics")));
   nparticles = std::make_shared<const std::vector<t_uint>>(
       convert_string<t_uint>(parameters->get<std::string>("nparticles")));
+  dense_threads(parameters->get<t_int>("threads"));
 
 #ifndef OPTIMET_MPI
   OPTIMET_REGISTER_BENCHMARK(serial_problem_setup)->Unit(benchmark::kMicrosecond);
 #elif defined(OPTIMET_SCALAPACK)
   OPTIMET_REGISTER_BENCHMARK(scalapack_problem_setup)->Unit(benchmark::kMicrosecond);
 #endif
+  OPTIMET_REGISTER_BENCHMARK(source_vector_setup)->Unit(benchmark::kMicrosecond);
   OPTIMET_REGISTER_BENCHMARK(fmm_problem_setup)->Unit(benchmark::kMicrosecond);
 
 #ifndef OPTIMET_MPI
@@ -237,7 +360,10 @@ int main(int argc, char **argv) {
     OPTIMET_REGISTER_BENCHMARK(gmres_solver)->Unit(benchmark::kMicrosecond);
 #endif
     OPTIMET_REGISTER_BENCHMARK(fmm_solver)->Unit(benchmark::kMicrosecond);
+    OPTIMET_REGISTER_BENCHMARK(fmm_preconditioned_solver)->Unit(benchmark::kMicrosecond);
+    OPTIMET_REGISTER_BENCHMARK(fmm_sstep_solver)->Unit(benchmark::kMicrosecond);
 #endif
+  OPTIMET_REGISTER_BENCHMARK(fmm_multigrid_solver)->Unit(benchmark::kMicrosecond);
 
 #ifndef OPTIMET_MPI
   OPTIMET_REGISTER_BENCHMARK(eigen_multiplication)->Unit(benchmark::kMicrosecond);
@@ -246,6 +372,9 @@ int main(int argc, char **argv) {
 #endif
   OPTIMET_REGISTER_BENCHMARK(fmm_multiplication)->Unit(benchmark::kMicrosecond);
 
+  OPTIMET_REGISTER_BENCHMARK(aux_coefficients)->Unit(benchmark::kMicrosecond);
+  OPTIMET_REGISTER_BENCHMARK(aux_coefficients_workspace)->Unit(benchmark::kMicrosecond);
+
   ::benchmark::Initialize(&argc, argv);
   ::benchmark::RunSpecifiedBenchmarks(&reporter);
   mpi::finalize();
@@ -32,6 +32,7 @@ struct Cmdl {
   t_int verbosity = 0;
   t_int num_blocks = 50;
   t_int num_recycled_blocks = 5;
+  t_int sstep = 5;
   t_real radius = 1e-8;
   t_real epsilon_r = 13.1;
   t_real epsilon_i = 0;
@@ -41,6 +42,8 @@ struct Cmdl {
   std::string nharmonics = "4 8 12 16 20";
   t_int iterations;
   t_int warmup;
+  t_int threads = 0;
+  bool autotune = false;
 };
 }
 Teuchos::RCP<Teuchos::ParameterList> parse_cmdl(int argc, char *argv[]) {
@@ -58,6 +61,7 @@ Teuchos::RCP<Teuchos::ParameterList> parse_cmdl(int argc, char *argv[]) {
   clp.setOption("num_blocks", &cmdl.num_blocks);
   clp.setOption("num_recycled_blocks", &cmdl.num_recycled_blocks);
   clp.setOption("num_recycled_blocks", &cmdl.num_recycled_blocks);
+  clp.setOption("sstep", &cmdl.sstep, "Iterations between synchronizations of s-step GMRES");
   clp.setOption("radius", &cmdl.radius, "of the particles");
   clp.setOption("epsilon_r", &cmdl.epsilon_r, "Real part of the relative dielectric constant");
   clp.setOption("epsilon_i", &cmdl.epsilon_i, "Imaginary part of the relative dielectric constant");
@@ -68,6 +72,9 @@ Teuchos::RCP<Teuchos::ParameterList> parse_cmdl(int argc, char *argv[]) {
   clp.setOption("nharmonics", &cmdl.nharmonics, "Space separated number of harmonics to trial");
   clp.setOption("iterations", &cmdl.iterations);
   clp.setOption("warmup", &cmdl.warmup);
+  clp.setOption("threads", &cmdl.threads, "Threads for dense linear algebra, 0 for the default");
+  clp.setOption("autotune", "noautotune", &cmdl.autotune,
+                "Whether to tune scalapack block size and grid from trial runs");
 
   std::string dummy;
   clp.setOption("benchmark_filter", &dummy);
@@ -84,6 +91,7 @@ Teuchos::RCP<Teuchos::ParameterList> parse_cmdl(int argc, char *argv[]) {
   result->set("Maximum Iterations", cmdl.itermax);
   result->set("Num Blocks", cmdl.num_blocks);
   result->set("Num Recycled Blocks", cmdl.num_recycled_blocks);
+  result->set("sstep", cmdl.sstep);
   result->set("Block Size", cmdl.block_size);
   result->set("Adaptive Block Size", cmdl.adaptive_block_size);
   result->set("Verbosity", cmdl.verbosity);
@@ -95,6 +103,8 @@ Teuchos::RCP<Teuchos::ParameterList> parse_cmdl(int argc, char *argv[]) {
   result->set("nharmonics", cmdl.nharmonics);
   result->set("iterations", cmdl.iterations);
   result->set("warmup", cmdl.warmup);
+  result->set("threads", cmdl.threads);
+  result->set("autotune", cmdl.autotune);
   return result;
 }
 }
@@ -83,6 +83,9 @@ Run fcc_input(Teuchos::RCP<Teuchos::ParameterList> const &parameters) {
   result.belos_params = parameters;
   result.do_fmm = parameters->get<bool>("do_fmm");
   result.fmm_subdiagonals = parameters->get<t_int>("fmm_subdiagonals");
+  result.parallel_params.autotune = parameters->get<bool>("autotune", false);
+  result.solver_params.sstep =
+      parameters->get<t_int>("sstep", static_cast<t_int>(result.solver_params.sstep));
 
   return result;
 }
@@ -105,6 +105,9 @@ int main(int argc, char *argv[]) {
 	input.do_fmm = input.belos_params->get<bool>("do fmm", true);
   if(input.do_fmm and input.belos_params->get("Solver", "scalapack") == "scalapack")
     input.belos_params->set("Solver", "GMRES");
+  // --solver "s-step GMRES" --sstep s compares communication-avoiding GMRES across nprocs
+  input.solver_params.sstep =
+      input.belos_params->get<t_int>("sstep", static_cast<t_int>(input.solver_params.sstep));
 
   Result result(input.geometry, input.excitation);
   auto const solver = solver::factory(input);
@@ -150,6 +153,9 @@ int main(int argc, char *argv[]) {
     std::cout << "    tolerance: " << input.belos_params->get<t_real>("Convergence Tolerance")
               << "\n";
     std::cout << "    solver: " << input.belos_params->get<std::string>("Solver") << "\n";
+    if(input.belos_params->get<std::string>("Solver") == "s-step GMRES")
+      std::cout << "    sstep: " << input.solver_params.sstep << "\n";
+    std::cout << "    Krylov iterations: " << solver->iterations() << "\n";
     std::cout << "    Total time: " << elapsed << " seconds\n";
     std::cout << "    Timing: " << elapsed / iterations << " seconds\n";
     std::cout << "---\n";
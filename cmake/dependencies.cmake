@@ -40,6 +40,44 @@ if(dobenchmarks)
   find_or_add_hunter_package(GBenchmark)
 endif()
 
+# Background reads of the out-of-core solver
+find_package(Threads REQUIRED)
+
+# Multi-threading over scatterers
+set(OPTIMET_OPENMP FALSE)
+if(doopenmp)
+  find_package(OpenMP)
+  if(OPENMP_FOUND)
+    set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} ${OpenMP_C_FLAGS}")
+    set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} ${OpenMP_CXX_FLAGS}")
+    set(OPTIMET_OPENMP TRUE)
+  else()
+    message(STATUS "Compiling without OpenMP")
+  endif()
+endif()
+
+# Optimized BLAS/LAPACK for Eigen's dense products and factorizations
+set(OPTIMET_BLAS FALSE)
+if(doblas)
+  find_package(BLAS)
+  find_package(LAPACK)
+  find_library(LAPACKE_LIBRARY NAMES lapacke mkl_rt)
+  if(BLAS_FOUND AND LAPACK_FOUND)
+    set(OPTIMET_BLAS TRUE)
+    add_definitions(-DEIGEN_USE_BLAS)
+    set(DENSE_LIBRARIES ${LAPACK_LIBRARIES} ${BLAS_LIBRARIES})
+    if(LAPACKE_LIBRARY)
+      add_definitions(-DEIGEN_USE_LAPACKE)
+      set(DENSE_LIBRARIES ${LAPACKE_LIBRARY} ${DENSE_LIBRARIES})
+    else()
+      message(STATUS "LAPACKE not found: factorizations use Eigen's kernels")
+    endif()
+    message(STATUS "Using BLAS/LAPACK libraries: ${DENSE_LIBRARIES}")
+  else()
+    message(STATUS "No optimized BLAS/LAPACK found: using Eigen's kernels")
+  endif()
+endif()
+
 set(OPTIMET_SCALAPACK FALSE)
 if(dompi AND "$ENV{CRAYOS_VERSION}" STREQUAL "")
   find_package(MPI REQUIRED)
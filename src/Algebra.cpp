@@ -16,8 +16,28 @@
 
 #include "Algebra.h"
 
+#include "Types.h"
 #include <stddef.h>
+#ifdef OPTIMET_BLAS
+#include <Eigen/Core>
+#else
 #include <gsl/gsl_cblas.h>
+#endif
+
+#ifdef OPTIMET_BLAS
+namespace {
+// Eigen forwards products to the optimized BLAS
+typedef Eigen::Matrix<std::complex<double>, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+    RowMatrix;
+
+RowMatrix to_matrix(std::complex<double> **T_, int rows_, int columns_) {
+  RowMatrix result(rows_, columns_);
+  for (int i = 0; i < rows_; i++)
+    result.row(i) = Eigen::Map<RowMatrix const>(T_[i], 1, columns_);
+  return result;
+}
+}
+#endif
 
 Algebra::Algebra() {
   //
@@ -34,6 +54,14 @@ void Algebra::multiplyMatrixMatrix(std::complex<double> **A, int rows_A_,
                                    std::complex<double> alpha_,
                                    std::complex<double> beta_) {
 
+#ifdef OPTIMET_BLAS
+  RowMatrix C_eigen = to_matrix(C, rows_A_, cols_B_);
+  C_eigen *= beta_;
+  C_eigen.noalias() +=
+      alpha_ * to_matrix(A, rows_A_, cols_A_) * to_matrix(B, rows_B_, cols_B_);
+  for (int i = 0; i < rows_A_; i++)
+    Eigen::Map<RowMatrix>(C[i], 1, cols_B_) = C_eigen.row(i);
+#else
   // GNU Scientific Library CBLas implementation
   std::complex<double> *A_cblas = new std::complex<double>[rows_A_ * cols_A_];
   std::complex<double> *B_cblas = new std::complex<double>[rows_B_ * cols_B_];
@@ -51,6 +79,7 @@ void Algebra::multiplyMatrixMatrix(std::complex<double> **A, int rows_A_,
   delete[] A_cblas;
   delete[] B_cblas;
   delete[] C_cblas;
+#endif
 }
 
 void Algebra::multiplyVectorMatrix(std::complex<double> **A, int rows_A_,
@@ -58,6 +87,12 @@ void Algebra::multiplyVectorMatrix(std::complex<double> **A, int rows_A_,
                                    std::complex<double> *Y,
                                    std::complex<double> alpha_,
                                    std::complex<double> beta_) {
+#ifdef OPTIMET_BLAS
+  Eigen::Map<Eigen::VectorXcd> y(Y, rows_A_);
+  y *= beta_;
+  y.noalias() += alpha_ * to_matrix(A, rows_A_, cols_A_) *
+                 Eigen::Map<Eigen::VectorXcd const>(X, cols_A_);
+#else
   std::complex<double> *A_cblas = new std::complex<double>[rows_A_ * cols_A_];
 
   matrixToVector(rows_A_, cols_A_, A, A_cblas);
@@ -66,6 +101,7 @@ void Algebra::multiplyVectorMatrix(std::complex<double> **A, int rows_A_,
               rows_A_, X, 1, &beta_, Y, 1);
 
   delete[] A_cblas;
+#endif
 }
 
 void Algebra::matrixToVector(long rows_, long columns_,
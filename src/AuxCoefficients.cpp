@@ -161,9 +161,17 @@ std::vector<SphericalP<t_complex>> AuxCoefficients::compute_Nn(
 
 std::tuple<std::vector<t_real>, std::vector<t_real>>
 AuxCoefficients::VIGdVIG(t_uint nMax, t_int m, const Spherical<t_real> &R) {
+  std::vector<t_real> Wigner, dWigner;
+  VIGdVIG(nMax, m, R, Wigner, dWigner);
+  return std::make_tuple(Wigner, dWigner);
+}
+
+void AuxCoefficients::VIGdVIG(t_uint nMax, t_int m, const Spherical<t_real> &R,
+                              std::vector<t_real> &Wigner, std::vector<t_real> &dWigner) {
   assert(std::abs(m) <= nMax);
 
-  std::vector<t_real> Wigner(nMax + 1, 0.0), dWigner(nMax + 1, 0.0);
+  Wigner.assign(nMax + 1, 0.0);
+  dWigner.assign(nMax + 1, 0.0);
 
   // I and II - determine n_min and obtain vig_d_n_min
   const bool check_m_negative = (m < 0);
@@ -228,8 +236,6 @@ AuxCoefficients::VIGdVIG(t_uint nMax, t_int m, const Spherical<t_real> &R) {
       dWigner[i] *= -c; // obtain final VIG_d
     }
   }
-
-  return std::make_tuple(Wigner, dWigner);
 }
 
 AuxCoefficients::AuxCoefficients(const Spherical<t_real> &R, t_complex waveK,
@@ -273,4 +279,65 @@ AuxCoefficients::AuxCoefficients(const Spherical<t_real> &R, t_complex waveK,
   }
 }
 
+AuxCoefficientsWorkspace &AuxCoefficientsWorkspace::nMax(t_uint nMax) {
+  if(nMax == nMax_ and dn_.size() == nMax + 1)
+    return *this;
+  nMax_ = nMax;
+  dn_ = AuxCoefficients::compute_dn(nMax);
+  auto const pMax = Tools::iteratorMax(nMax);
+  M_.resize(3, pMax);
+  N_.resize(3, pMax);
+  B_.resize(3, pMax);
+  C_.resize(3, pMax);
+  wigner_.resize(nMax + 1);
+  dwigner_.resize(nMax + 1);
+  return *this;
+}
+
+AuxCoefficientsWorkspace &
+AuxCoefficientsWorkspace::compute(Spherical<t_real> const &R, t_complex waveK, bool regular) {
+  const BESSEL_TYPE besselType = (regular) ? Bessel : Hankel1;
+  // Bessel functions depend only on the radial coordinate: compute once for all m
+  std::tie(bessel_, dbessel_) = optimet::bessel(R.rrr * waveK, besselType, 0, nMax_);
+  const t_complex Kr = waveK * R.rrr;
+
+  // Same as Tools::toProjection, as a matrix acting on (rrr, the, phi)
+  const t_real sin_the = std::sin(R.the), cos_the = std::cos(R.the);
+  const t_real sin_phi = std::sin(R.phi), cos_phi = std::cos(R.phi);
+  Eigen::Matrix<t_complex, 3, 3> projection;
+  projection << sin_the * cos_phi, cos_the * cos_phi, -sin_phi, sin_the * sin_phi,
+      cos_the * sin_phi, cos_phi, cos_the, -sin_the, 0;
+  const bool is_pole =
+      std::abs(R.the) < 1e-10 || (std::abs(R.the) - consPi + 1e-10) > 0.0;
+
+  Eigen::Matrix<t_complex, 3, 1> Bn, Cn;
+  auto const max = static_cast<t_int>(nMax_);
+  for(t_int m = -max; m <= max; ++m) {
+    AuxCoefficients::VIGdVIG(nMax_, m, R, wigner_, dwigner_);
+
+    const t_real dm = std::pow(-1.0, m); // Legendre to Wigner function
+    const t_complex exp_imphi(std::cos(m * R.phi), std::sin(m * R.phi));
+
+    for(t_uint n = std::max<t_uint>(std::abs(m), 1); n <= nMax_; ++n) {
+      const t_real A = m == 0 ? 0.0 : (is_pole ? m / cos_the * dwigner_[n] :
+                                                 m / sin_the * wigner_[n]);
+      const t_uint p = flatten_indices(n, m);
+
+      Bn << 0.0, dwigner_[n], t_complex(0.0, A);
+      Cn << 0.0, t_complex(0.0, A), -dwigner_[n];
+      B_.col(p) = projection * Bn;
+      C_.col(p) = projection * Cn;
+
+      // projection is linear, so M and N can be computed directly from the projected B and C
+      const t_complex factor = dm * dn_[n] * exp_imphi;
+      M_.col(p) = (factor * bessel_[n]) * C_.col(p);
+      N_.col(p) =
+          (factor / Kr) *
+          ((static_cast<t_real>(n * (n + 1)) * bessel_[n] * wigner_[n]) * projection.col(0) +
+           (Kr * dbessel_[n] + bessel_[n]) * B_.col(p));
+    }
+  }
+  return *this;
+}
+
 } // namespace optimet
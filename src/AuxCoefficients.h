@@ -53,6 +53,17 @@ public:
   static std::tuple<std::vector<t_real>, std::vector<t_real>>
   VIGdVIG(t_uint nMax, t_int m, const Spherical<t_real> &R);
 
+  /**
+   * Compute the Wigner functions and their derivatives in place.
+   * @param nMax the maximum value of the n iterator.
+   * @param m the value of the m iterator.
+   * @param R the Spherical vector.
+   * @param Wigner output Wigner functions, resized to nMax + 1.
+   * @param dWigner output derivatives of the Wigner functions, resized to nMax + 1.
+   */
+  static void VIGdVIG(t_uint nMax, t_int m, const Spherical<t_real> &R,
+                      std::vector<t_real> &Wigner, std::vector<t_real> &dWigner);
+
   /**
    * Initializing constructor for the AuxCoefficients class.
    * @param R_ the Spherical vector.
@@ -151,6 +162,65 @@ private:
       _dn; /**< The dn symbols (required for the Excitation class). */
 };
 
+//! \brief Reusable structure-of-arrays version of AuxCoefficients
+//! \details Computes the same M, N, B and C functions as AuxCoefficients, but stores them in
+//! column-per-harmonic matrices owned by the workspace. The d_n symbols are computed once for a
+//! given nMax, and the Bessel functions once per point. Memory is reused from one call to
+//! compute() to the next, so that a single workspace can be used to evaluate fields over a whole
+//! grid of points.
+class AuxCoefficientsWorkspace {
+public:
+  //! Type of the buffers: one row per cartesian component, one column per harmonic
+  typedef Eigen::Matrix<t_complex, 3, Eigen::Dynamic> Buffer;
+
+  //! Allocates buffers for the given maximum n iterator
+  AuxCoefficientsWorkspace(t_uint nMax = 0) : nMax_(0) { this->nMax(nMax); }
+
+  //! Maximum value of the n iterator
+  t_uint nMax() const { return nMax_; }
+  //! Resizes the workspace if needed
+  AuxCoefficientsWorkspace &nMax(t_uint nMax);
+
+  //! \brief Computes M, N, B and C at a given point
+  //! \param[in] R: point at which to compute the functions
+  //! \param[in] waveK: wave number
+  //! \param[in] regular: type of coefficients (regular or not)
+  AuxCoefficientsWorkspace &compute(Spherical<t_real> const &R, t_complex waveK, bool regular);
+
+  //! M functions, column i is the i-th harmonic
+  Buffer const &M() const { return M_; }
+  //! N functions, column i is the i-th harmonic
+  Buffer const &N() const { return N_; }
+  //! B functions, column i is the i-th harmonic
+  Buffer const &B() const { return B_; }
+  //! C functions, column i is the i-th harmonic
+  Buffer const &C() const { return C_; }
+
+  //! M function for harmonic i
+  SphericalP<t_complex> M(t_uint i) const { return {M_(0, i), M_(1, i), M_(2, i)}; }
+  //! N function for harmonic i
+  SphericalP<t_complex> N(t_uint i) const { return {N_(0, i), N_(1, i), N_(2, i)}; }
+  //! B function for harmonic i
+  SphericalP<t_complex> B(t_uint i) const { return {B_(0, i), B_(1, i), B_(2, i)}; }
+  //! C function for harmonic i
+  SphericalP<t_complex> C(t_uint i) const { return {C_(0, i), C_(1, i), C_(2, i)}; }
+
+  //! d_n symbols
+  t_real dn(t_uint i) const { return dn_[i]; }
+
+private:
+  //! Maximum value of the n iterator
+  t_uint nMax_;
+  //! d_n symbols for current nMax
+  std::vector<t_real> dn_;
+  //! Buffers for the vector spherical functions
+  Buffer M_, N_, B_, C_;
+  //! Scratch space for Wigner functions and their derivatives
+  std::vector<t_real> wigner_, dwigner_;
+  //! Scratch space for Bessel functions and their derivatives
+  std::vector<t_complex> bessel_, dbessel_;
+};
+
 } // namespace optimet
 
 #endif /*AUX_COEFFICIENTS_H_*/
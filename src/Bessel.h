@@ -20,6 +20,7 @@
 #include "constants.h"
 #include <complex>
 #include <iostream>
+#include <mutex>
 #include <tuple>
 #include <vector>
 
@@ -34,6 +35,14 @@ namespace optimet {
 
 enum BESSEL_TYPE { Bessel = 0, Hankel1 = 1, Hankel2 = 2 };
 
+//! \brief Serializes calls to the AMOS routines
+//! \details The f2c translation in amos.c keeps its state in function-local statics, so it is not
+//! reentrant. Threads assembling matrices concurrently must take turns.
+inline std::mutex &amos_mutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
 /*!
  * The bessel function implements the Spherical Bessel and Hankel functions
  * and their derivatives, calculated from the zeroth order up to the maximum
@@ -85,13 +94,16 @@ bessel(const std::complex<double> &z, long int max_order) {
 
     long int zeroUnderflow, ierr;
 
-    if(BesselType == Bessel)
-      // Calculate the Bessel function of the first kind
-      zbesj_(&zr, &zi, &order, &scaling, &size, cyr.data(), cyi.data(), &zeroUnderflow, &ierr);
-    else
-      // Calculate the Hankel function of the first or second kind
-      zbesh_(&zr, &zi, &order, &scaling, &bessel_type, &size, cyr.data(), cyi.data(),
-             &zeroUnderflow, &ierr);
+    {
+      std::lock_guard<std::mutex> lock(amos_mutex());
+      if(BesselType == Bessel)
+        // Calculate the Bessel function of the first kind
+        zbesj_(&zr, &zi, &order, &scaling, &size, cyr.data(), cyi.data(), &zeroUnderflow, &ierr);
+      else
+        // Calculate the Hankel function of the first or second kind
+        zbesh_(&zr, &zi, &order, &scaling, &bessel_type, &size, cyr.data(), cyi.data(),
+               &zeroUnderflow, &ierr);
+    }
 
     switch(ierr) {
     case 0:
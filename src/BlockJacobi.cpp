@@ -0,0 +1,84 @@
+// (C) University College London 2017
+// This file is part of Optimet, licensed under the terms of the GNU Public License
+//
+// Optimet is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Optimet is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Optimet. If not, see <http://www.gnu.org/licenses/>.
+
+#include "BlockJacobi.h"
+#include "Clustering.h"
+#include "PreconditionedMatrix.h"
+#include <algorithm>
+#include <numeric>
+
+namespace optimet {
+namespace {
+//! Splits scatterers into clusters by recursive bisection of their bounding box
+void bisect(std::vector<Scatterer>::const_iterator const &objects, std::vector<t_uint> &order,
+            t_uint first, t_uint last, t_uint block_size,
+            std::vector<std::vector<t_uint>> &result) {
+  auto const middle = bisect_scatterers(objects, order, first, last, block_size);
+  if(middle == last) {
+    result.emplace_back(order.begin() + first, order.begin() + last);
+    return;
+  }
+  bisect(objects, order, first, middle, block_size, result);
+  bisect(objects, order, middle, last, block_size, result);
+}
+}
+
+BlockJacobi::BlockJacobi(std::vector<Scatterer>::const_iterator const &first,
+                         std::vector<Scatterer>::const_iterator const &last,
+                         ElectroMagnetic const &bground, std::shared_ptr<Excitation const> incWave,
+                         t_uint block_size)
+    : offsets_(scatterer_offsets(first, last)) {
+  std::vector<t_uint> order(last - first);
+  std::iota(order.begin(), order.end(), 0);
+  std::vector<std::vector<t_uint>> clusters;
+  if(not order.empty())
+    bisect(first, order, 0, order.size(), block_size, clusters);
+
+  clusters_.resize(clusters.size());
+  for(t_uint c(0); c < clusters.size(); ++c) {
+    auto &cluster = clusters_[c];
+    cluster.scatterers = clusters[c];
+    std::sort(cluster.scatterers.begin(), cluster.scatterers.end());
+    std::vector<Scatterer> members;
+    for(auto const i : cluster.scatterers)
+      members.push_back(*(first + i));
+    cluster.lu.compute(preconditioned_scattering_matrix(
+        members.begin(), members.end(), members.begin(), members.end(), bground, incWave));
+  }
+}
+
+void BlockJacobi::operator()(Vector<t_complex> const &in, Vector<t_complex> &out) const {
+  if(static_cast<t_uint>(in.size()) != rows())
+    throw std::runtime_error("Incorrect input vector size for the block-Jacobi preconditioner");
+  out.resize(in.size());
+  for(auto const &cluster : clusters_) {
+    Vector<t_complex> local(cluster.lu.rows());
+    t_uint k(0);
+    for(auto const i : cluster.scatterers) {
+      auto const n = offsets_[i + 1] - offsets_[i];
+      local.segment(k, n) = in.segment(offsets_[i], n);
+      k += n;
+    }
+    local = cluster.lu.solve(local);
+    k = 0;
+    for(auto const i : cluster.scatterers) {
+      auto const n = offsets_[i + 1] - offsets_[i];
+      out.segment(offsets_[i], n) = local.segment(k, n);
+      k += n;
+    }
+  }
+}
+} // namespace optimet
@@ -0,0 +1,77 @@
+// (C) University College London 2017
+// This file is part of Optimet, licensed under the terms of the GNU Public License
+//
+// Optimet is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Optimet is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Optimet. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef OPTIMET_BLOCK_JACOBI_H
+#define OPTIMET_BLOCK_JACOBI_H
+
+#include "ElectroMagnetic.h"
+#include "Excitation.h"
+#include "Scatterer.h"
+#include "Types.h"
+#include <Eigen/Dense>
+#include <memory>
+#include <vector>
+
+namespace optimet {
+//! \brief Block-Jacobi preconditioner built from clusters of near-neighbour scatterers
+//! \details Scatterers are grouped by recursive bisection of their bounding box. The dense block
+//! of the preconditioned scattering matrix coupling the scatterers of each cluster is
+//! LU-factorized once. Applying the preconditioner solves each cluster's block independently,
+//! i.e. it approximates the inverse of S by that of its near-field block-diagonal.
+class BlockJacobi {
+public:
+  //! \brief Assembles and factorizes the cluster blocks
+  //! \param[in] first, last: scatterers for which this object is responsible. Input and output
+  //! vectors of the preconditioner are restricted to the coefficients of these scatterers, in
+  //! order.
+  //! \param[in] block_size: maximum number of unknowns in a cluster, unless it is a single
+  //! scatterer
+  BlockJacobi(std::vector<Scatterer>::const_iterator const &first,
+              std::vector<Scatterer>::const_iterator const &last, ElectroMagnetic const &bground,
+              std::shared_ptr<Excitation const> incWave, t_uint block_size = 512);
+  BlockJacobi(std::vector<Scatterer> const &objects, ElectroMagnetic const &bground,
+              std::shared_ptr<Excitation const> incWave, t_uint block_size = 512)
+      : BlockJacobi(objects.begin(), objects.end(), bground, incWave, block_size) {}
+
+  //! Applies the inverse of the cluster blocks
+  void operator()(Vector<t_complex> const &in, Vector<t_complex> &out) const;
+  //! Applies the inverse of the cluster blocks
+  Vector<t_complex> operator*(Vector<t_complex> const &in) const {
+    Vector<t_complex> out;
+    operator()(in, out);
+    return out;
+  }
+
+  //! Number of rows and columns
+  t_uint rows() const { return offsets_.back(); }
+  //! Number of clusters
+  t_uint clusters() const { return clusters_.size(); }
+
+protected:
+  //! Factorized dense block of a cluster
+  struct Cluster {
+    //! Indices of the scatterers in the cluster
+    std::vector<t_uint> scatterers;
+    //! LU factors of the cluster block
+    Eigen::PartialPivLU<Matrix<t_complex>> lu;
+  };
+  //! Offset of each scatterer in the input vector, followed by the total size
+  std::vector<t_uint> offsets_;
+  //! Clusters of near-neighbour scatterers
+  std::vector<Cluster> clusters_;
+};
+} // namespace optimet
+#endif
@@ -0,0 +1,46 @@
+// (C) University College London 2017
+// This file is part of Optimet, licensed under the terms of the GNU Public License
+//
+// Optimet is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Optimet is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Optimet. If not, see <http://www.gnu.org/licenses/>.
+
+#include "Clustering.h"
+#include <algorithm>
+
+namespace optimet {
+t_uint bisect_scatterers(std::vector<Scatterer>::const_iterator const &objects,
+                         std::vector<t_uint> &order, t_uint first, t_uint last,
+                         t_uint max_unknowns) {
+  t_uint unknowns(0);
+  for(t_uint i(first); i < last; ++i)
+    unknowns += 2 * objects[order[i]].nMax * (objects[order[i]].nMax + 2);
+  if(last - first <= 1 or unknowns <= max_unknowns)
+    return last;
+
+  Eigen::Matrix<t_real, 3, 1> lower = objects[order[first]].vR.toEigenCartesian(), upper = lower;
+  for(t_uint i(first + 1); i < last; ++i) {
+    auto const x = objects[order[i]].vR.toEigenCartesian();
+    lower = lower.cwiseMin(x);
+    upper = upper.cwiseMax(x);
+  }
+  Eigen::Matrix<t_real, 3, 1>::Index axis;
+  (upper - lower).maxCoeff(&axis);
+  auto const middle = first + (last - first) / 2;
+  std::nth_element(order.begin() + first, order.begin() + middle, order.begin() + last,
+                   [&objects, axis](t_uint a, t_uint b) {
+                     return objects[a].vR.toEigenCartesian()(axis) <
+                            objects[b].vR.toEigenCartesian()(axis);
+                   });
+  return middle;
+}
+} // namespace optimet
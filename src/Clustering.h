@@ -0,0 +1,36 @@
+// (C) University College London 2017
+// This file is part of Optimet, licensed under the terms of the GNU Public License
+//
+// Optimet is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Optimet is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Optimet. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef OPTIMET_CLUSTERING_H
+#define OPTIMET_CLUSTERING_H
+
+#include "Scatterer.h"
+#include "Types.h"
+#include <vector>
+
+namespace optimet {
+//! \brief Splits a range of scatterers in two along the longest side of their bounding box
+//! \details Reorders order[first, last) so that the scatterers in [first, middle) lie below those
+//! in [middle, last) along that side.
+//! \param[in] objects: scatterers indexed by the elements of order
+//! \param[in] max_unknowns: ranges with at most this many unknowns are not split
+//! \returns middle, or last if the range is a single scatterer or has at most max_unknowns
+//! unknowns. In the latter case, the range is left untouched.
+t_uint bisect_scatterers(std::vector<Scatterer>::const_iterator const &objects,
+                         std::vector<t_uint> &order, t_uint first, t_uint last,
+                         t_uint max_unknowns);
+} // namespace optimet
+#endif
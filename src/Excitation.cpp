@@ -16,15 +16,14 @@
 
 #include "Excitation.h"
 
-#include "Algebra.h"
 #include "AuxCoefficients.h"
 #include "CompoundIterator.h"
-#include "Coupling.h"
 #include "Tools.h"
 #include "constants.h"
 
 #include <cmath>
 #include <iostream>
+#include <stdexcept>
 
 namespace optimet {
 Excitation::Excitation(unsigned long type, SphericalP<std::complex<double>> Einc,
@@ -71,45 +70,43 @@ int Excitation::populate() {
 
 int Excitation::getIncLocal(Spherical<double> point_, std::complex<double> *Inc_local_,
                             int nMax_) const {
-  Spherical<double> Rrel = point_ - Spherical<double>(0.0, 0.0, 0.0);
-  optimet::Coupling const coupling(Rrel, waveK, nMax_, false);
-
-  CompoundIterator p, q;
-
-  int pMax = p.max(nMax_);
-  int qMax = q.max(nMax_);
-
-  std::complex<double> *Inc_direct = new std::complex<double>[2 * pMax];
-  std::complex<double> **T_AB = new std::complex<double> *[2 * (p.max(nMax))];
-  for(p = 0; p < (int)(2 * p.max(nMax)); p++) {
-    T_AB[p] = new std::complex<double>[2 * p.max(nMax)];
-  }
-
-  for(p = 0; p < pMax; p++) {
-    Inc_direct[p] = dataIncAp[p];
-    Inc_direct[p + pMax] = dataIncBp[p];
-  }
-
-  for(p = 0; p < pMax; p++) {
-    for(q = 0; q < qMax; q++) {
-      T_AB[p][q] = coupling.diagonal(q, p);
-      T_AB[p + pMax][q + qMax] = coupling.diagonal(q, p);
-      T_AB[p + pMax][q] = coupling.offdiagonal(q, p);
-      T_AB[p][q + qMax] = coupling.offdiagonal(q, p);
-    }
+  if(nMax_ > nMax) {
+    // coefficients at the origin do not depend on truncation, but we need more of them
+    Excitation larger(type, Einc, vKInc, nMax_);
+    larger.populate();
+    return larger.getIncLocal(point_, Inc_local_, nMax_);
   }
 
-  Algebra::multiplyVectorMatrix(T_AB, 2 * pMax, 2 * pMax, Inc_direct, Inc_local_, consC1, consC0);
+  // For a plane wave, translating the regular expansion from the origin to point_ only adds a
+  // phase exp(i k.r). This is exact, whereas the translation-addition theorem has to be truncated.
+  auto const direction = Tools::toCartesian(Spherical<double>(1e0, vKInc.the, vKInc.phi));
+  auto const position = Tools::toCartesian(point_);
+  t_complex const phase =
+      std::exp(consCi * waveK *
+               (direction.x * position.x + direction.y * position.y + direction.z * position.z));
 
-  delete[] Inc_direct;
+  auto const pMax = Tools::iteratorMax(nMax_);
+  Eigen::Map<Vector<t_complex>> local(Inc_local_, 2 * pMax);
+  local.head(pMax) = phase * dataIncAp.head(pMax);
+  local.tail(pMax) = phase * dataIncBp.head(pMax);
 
-  for(p = 0; p < 2 * pMax; p++) {
-    delete[] T_AB[p];
-  }
+  return 0;
+}
 
-  delete[] T_AB;
+void Excitation::add_wave(Spherical<double> const &direction_,
+                          SphericalP<std::complex<double>> const &Einc_) {
+  directions.push_back(direction_);
+  fields.push_back(Einc_);
+}
 
-  return 0;
+Excitation Excitation::wave(t_uint i) const {
+  if(i >= nwaves())
+    throw std::out_of_range("No such incident wave");
+  auto const direction = i == 0 ? vKInc : directions[i - 1];
+  Excitation result(type, i == 0 ? Einc : fields[i - 1],
+                    Spherical<double>(vKInc.rrr, direction.the, direction.phi), nMax);
+  result.populate();
+  return result;
 }
 
 void Excitation::updateWavelength(double lambda_) {
@@ -22,6 +22,7 @@
 #include "Types.h"
 #include "constants.h"
 #include <complex>
+#include <vector>
 
 namespace optimet {
 /**
@@ -80,8 +81,9 @@ public:
   int populate();
 
   /**
-   * Returns the Incoming Local matrix converting the a,b coefficients into
-   * local ones.
+   * Returns the incoming wave coefficients in the frame centered at point_.
+   * For a plane wave, this is the expansion at the origin times the phase exp(i k.r), in
+   * O(nMax^2) operations.
    * @param point_ the new origin of the coordinate system.
    * @param Inc_local_ the incoming local matrix.
    * @param nMax_ the maximum value of the n iterator.
@@ -103,6 +105,25 @@ public:
   //! The incoming wave frequency (calculated)
   optimet::t_real omega() const { return constant::c * wavenumber(); }
 
+  /**
+   * Adds an incident plane wave, solved for alongside the main wave by solvers that handle
+   * several right-hand sides at once. All waves share the wavenumber and nMax of the main wave.
+   * @param direction_ the incoming wavevector angular values, the radius is ignored.
+   * @param Einc_ the incoming wave values, as for Einc.
+   */
+  void
+  add_wave(Spherical<double> const &direction_, SphericalP<std::complex<double>> const &Einc_);
+  //! Number of incident plane waves, including the main wave
+  t_uint nwaves() const { return 1 + directions.size(); }
+  //! \brief Single plane wave, with its coefficients populated
+  //! \details The main wave has index zero.
+  Excitation wave(t_uint i) const;
+
+protected:
+  //! Angular values of the additional wavevectors
+  std::vector<Spherical<double>> directions;
+  //! Fields of the additional waves
+  std::vector<SphericalP<std::complex<double>>> fields;
 };
 }
 #endif /* EXCITATION_H_ */
@@ -15,7 +15,9 @@
 // along with Optimet. If not, see <http://www.gnu.org/licenses/>.
 
 #include "FMMBelosSolver.h"
+#include "Krylov.h"
 #include "PreconditionedMatrix.h"
+#include "ResidualHistory.h"
 #include "scalapack/LinearSystemSolver.h"
 #include <Kokkos_View.hpp>
 #include <Teuchos_RCP.hpp>
@@ -24,8 +26,18 @@
 namespace optimet {
 namespace solver {
 namespace {
-//! Type for belos to figure out how to apply FMM
-typedef std::reference_wrapper<mpi::FastMatrixMultiply const> FMMOperator;
+//! \brief Type for belos to figure out how to apply FMM and its preconditioner
+//! \details Belos requires the operator and the preconditioner to share the same type.
+struct FMMOperator {
+  //! Applies the operator
+  krylov::Operator apply;
+  //! Applies the transpose of the operator, if available
+  krylov::Operator transpose;
+  //! Applies the adjoint of the operator, if available
+  krylov::Operator adjoint;
+  //! Applies the operator to several columns at once, if available
+  std::function<void(Matrix<t_complex> const &, Matrix<t_complex> &)> block;
+};
 //! Type for belos to figure out how to apply FMM
 typedef Tpetra::MultiVector<t_complex> TpetraVector;
 }
@@ -45,31 +57,50 @@ public:
       throw std::runtime_error("Local lengths of X and Y are different");
     if(X.getLocalLength() == 0)
       return;
-    auto const input =
-        Eigen::Map<Vector<t_complex> const>(X.getData(0).getRawPtr(), X.getLocalLength());
-    auto output = Vector<t_complex>::Map(Y.getDataNonConst(0).getRawPtr(), Y.getLocalLength());
-    if(trans == Belos::TRANS)
-      output = Op.get().transpose(input);
-    else if(trans == Belos::CONJTRANS)
-      output = Op.get().adjoint(input);
-    else
-      output = Op.get() * input;
+    auto const n = X.getNumVectors();
+    if(trans == NOTRANS and n > 1 and Op.block) {
+      Matrix<t_complex> input(X.getLocalLength(), n), result;
+      for(std::size_t i(0); i < n; ++i)
+        input.col(i) =
+            Eigen::Map<Vector<t_complex> const>(X.getData(i).getRawPtr(), X.getLocalLength());
+      Op.block(input, result);
+      for(std::size_t i(0); i < n; ++i)
+        Vector<t_complex>::Map(Y.getDataNonConst(i).getRawPtr(), Y.getLocalLength()) =
+            result.col(i);
+      return;
+    }
+    auto const &apply =
+        trans == Belos::TRANS ? Op.transpose : trans == Belos::CONJTRANS ? Op.adjoint : Op.apply;
+    if(not apply)
+      throw std::runtime_error("Operator cannot be transposed");
+    Vector<t_complex> result(Y.getLocalLength());
+    for(std::size_t i(0); i < n; ++i) {
+      auto const input =
+          Eigen::Map<Vector<t_complex> const>(X.getData(i).getRawPtr(), X.getLocalLength());
+      apply(input, result);
+      Vector<t_complex>::Map(Y.getDataNonConst(i).getRawPtr(), Y.getLocalLength()) = result;
+    }
   }
 
-  static bool HasApplyTranspose(optimet::solver::FMMOperator const &) { return true; }
+  static bool HasApplyTranspose(optimet::solver::FMMOperator const &Op) {
+    return static_cast<bool>(Op.transpose);
+  }
 };
 }
 
 namespace optimet {
 namespace solver {
+struct FMMBelos::BelosState {
+  //! Solver manager, with its recycled space
+  Teuchos::RCP<Belos::SolverManager<t_complex, TpetraVector, FMMOperator>> solver;
+};
+
 namespace {
 Teuchos::RCP<const Teuchos::Comm<int>> teuchos_communicator(mpi::Communicator const &comm);
-Teuchos::RCP<Tpetra::MultiVector<t_complex>>
-tpetra_vector(t_uint nglobals, Vector<t_complex> &x,
-              Teuchos::RCP<const Teuchos::Comm<int>> const &comm);
-Teuchos::RCP<Tpetra::MultiVector<t_complex>>
-tpetra_vector(t_uint nglobals, Vector<t_complex> const &x,
-              Teuchos::RCP<const Teuchos::Comm<int>> const &comm);
+//! One Tpetra vector per column of x, distributed like the rows of x
+template <class T>
+Teuchos::RCP<TpetraVector> tpetra_vector(t_uint nglobals, Eigen::PlainObjectBase<T> const &x,
+                                         Teuchos::RCP<const Teuchos::Comm<int>> const &comm);
 }
 
 void FMMBelos::update() {
@@ -77,10 +108,35 @@ void FMMBelos::update() {
     auto const diags = subdiagonals == std::numeric_limits<t_int>::max() ?
                            std::max<int>(1, geometry->objects.size() / 2 - 2) :
                            subdiagonals;
+    auto const previous = fmm_;
     fmm_ = std::make_shared<mpi::FastMatrixMultiply>(geometry->bground, incWave->wavenumber(),
                                                      geometry->objects, diags, communicator());
-    auto const distribution =
-        mpi::details::vector_distribution(geometry->objects.size(), communicator().size());
+    auto const same_distribution =
+        previous and previous->distribution().size() == fmm_->distribution().size() and
+        previous->distribution() == fmm_->distribution();
+    if(belos_state_ and not(same_distribution and previous->cols() == fmm_->cols()))
+      belos_state_ = nullptr;
+    else if(belos_state_) {
+      // the probe is local, the norms are global
+      Vector<t_complex> const probe = Vector<t_complex>::Random(fmm_->cols());
+      Vector<t_complex> const before = (*previous) * probe;
+      auto const norm = communicator().all_reduce(before.squaredNorm(), MPI_SUM);
+      auto const change =
+          communicator().all_reduce((*fmm_ * probe - before).squaredNorm(), MPI_SUM);
+      if(change > parameters_.recycle_threshold * parameters_.recycle_threshold * norm)
+        belos_state_->solver->reset(Belos::RecycleSubspace);
+    }
+    if(((belos_params_->get<int>("Verbosity", 0) & Belos::MsgType::FinalSummary) or
+        parameters_.verbosity != 0) and
+       communicator().rank() == communicator().root_id()) {
+      auto const &loads = fmm_->loads();
+      std::cout << "FMM load per process, relative to the mean:";
+      for(t_uint i(0); i < static_cast<t_uint>(loads.size()); ++i)
+        std::cout << " " << loads(i) / loads.mean();
+      std::cout << "\nFMM load imbalance: " << fmm_->imbalance() << "\n";
+    }
+    // scatterers are distributed according to the cost of their couplings
+    auto const &distribution = fmm_->distribution();
     auto const first = std::find(distribution.data(), distribution.data() + distribution.size(),
                                  communicator().rank()) -
                        distribution.data();
@@ -89,36 +145,126 @@ void FMMBelos::update() {
                      [this](t_int value) { return value != communicator().rank(); }) -
         distribution.data();
     Q = source_vector(geometry->objects.begin() + first, geometry->objects.begin() + last, incWave);
+    sources_ = incWave->nwaves() > 1 ?
+                   source_vectors(geometry->objects.begin() + first,
+                                  geometry->objects.begin() + last, incWave) :
+                   Matrix<t_complex>(0, 0);
+    // built from the local scatterers only, so that only the fine operator communicates
+    auto const fmm = fmm_;
+    preconditioner_ = solver::preconditioner(
+        parameters_, geometry->objects.begin() + first, geometry->objects.begin() + last,
+        geometry->bground, incWave,
+        [fmm](Vector<t_complex> const &in, Vector<t_complex> &out) { (*fmm)(in, out); });
   } else {
     fmm_ = nullptr;
+    preconditioner_ = krylov::Operator();
     Q = Vector<t_complex>::Zero(0);
+    sources_.resize(0, 0);
   }
 }
 
 void FMMBelos::solve(Vector<t_complex> &X_sca_, Vector<t_complex> &X_int_) const {
-  auto const distribution =
-      mpi::details::vector_distribution(geometry->objects.size(), communicator().size());
+  auto const &distribution = fmm_->distribution();
 
   // used to create vector
   auto const nglobals = geometry->scatterer_size();
   auto const nlocals = Q.size();
-  X_sca_.resize(nlocals);
-  X_sca_.fill(0);
+  if(static_cast<t_uint>(initial_guess_.size()) == nglobals) {
+    auto const first = std::find(distribution.data(), distribution.data() + distribution.size(),
+                                 communicator().rank()) -
+                       distribution.data();
+    auto const offset =
+        scatterer_offsets(geometry->objects.begin(), geometry->objects.begin() + first).back();
+    X_sca_ = initial_guess_.segment(offset, nlocals);
+  } else {
+    X_sca_.resize(nlocals);
+    X_sca_.fill(0);
+  }
+
+  telemetry_.clear();
+  Matrix<t_complex> const local = iterate(Q, X_sca_);
+  X_sca_ = communicator().all_gather(Vector<t_complex>(local.col(0)));
+  solution_ = X_sca_;
+  X_sca_ = AbstractSolver::convertIndirect(X_sca_);
+  X_int_ = AbstractSolver::solveInternal(X_sca_);
+}
 
+void FMMBelos::solve_waves(Matrix<t_complex> &X_sca_, Matrix<t_complex> &X_int_) const {
+  if(incWave->nwaves() == 1)
+    return AbstractSolver::solve_waves(X_sca_, X_int_);
+
+  telemetry_.clear();
+  Matrix<t_complex> const local =
+      iterate(sources_, Matrix<t_complex>::Zero(sources_.rows(), sources_.cols()));
+  X_sca_.resize(geometry->scatterer_size(), local.cols());
+  X_int_.resize(geometry->scatterer_size(), local.cols());
+  for(t_uint i(0); i < static_cast<t_uint>(local.cols()); ++i) {
+    Vector<t_complex> const column = local.col(i);
+    Vector<t_complex> const solution = communicator().all_gather(column);
+    Vector<t_complex> const scattered = AbstractSolver::convertIndirect(solution);
+    X_sca_.col(i) = scattered;
+    X_int_.col(i) = AbstractSolver::solveInternal(scattered);
+  }
+}
+
+Matrix<t_complex>
+FMMBelos::iterate(Matrix<t_complex> const &sources, Matrix<t_complex> const &guess) const {
+  std::string const name = belos_params_->get("Solver", "GMRES");
+  if(name == "s-step GMRES")
+    return iterate_sstep(sources, guess);
+  auto const nglobals = geometry->scatterer_size();
   auto const tcom = teuchos_communicator(communicator());
-  auto const x = tpetra_vector(nglobals, X_sca_, tcom);
-  auto const b = tpetra_vector(nglobals, Q, tcom);
-  auto Aptr = Teuchos::rcp(new FMMOperator(*fmm_));
+  auto const x = tpetra_vector(nglobals, guess, tcom);
+  auto const b = tpetra_vector(nglobals, sources, tcom);
+  // captures shared pointers since a recycling solver manager outlives this call
+  auto const fmm = fmm_;
+  auto const record = std::make_shared<Telemetry>(name);
+  auto const start = TelemetryClock::now();
+  auto Aptr = Teuchos::rcp(new FMMOperator{
+      [fmm, record](Vector<t_complex> const &in, Vector<t_complex> &out) {
+        auto const start = TelemetryClock::now();
+        out = *fmm * in;
+        record->apply += seconds_since(start);
+      },
+      [fmm](Vector<t_complex> const &in, Vector<t_complex> &out) { out = fmm->transpose(in); },
+      [fmm](Vector<t_complex> const &in, Vector<t_complex> &out) { out = fmm->adjoint(in); },
+      [fmm, record](Matrix<t_complex> const &in, Matrix<t_complex> &out) {
+        auto const start = TelemetryClock::now();
+        (*fmm)(in, out);
+        record->apply += seconds_since(start);
+      }});
 
   typedef Belos::LinearProblem<t_complex, TpetraVector, FMMOperator> BelosLinearProblem;
   auto const problem = rcp(new BelosLinearProblem(Aptr, x, b));
+  if(preconditioner_) {
+    auto const preconditioner = preconditioner_;
+    auto const M = [preconditioner, record](Vector<t_complex> const &in, Vector<t_complex> &out) {
+      auto const start = TelemetryClock::now();
+      preconditioner(in, out);
+      record->preconditioner += seconds_since(start);
+    };
+    problem->setRightPrec(Teuchos::rcp(new FMMOperator{M, nullptr, nullptr, nullptr}));
+  }
   // Tell the solver what problem you want to solve.
   if(not problem->setProblem())
     throw std::runtime_error("Could not setup up Belos problem");
 
   typedef Belos::SolverFactory<t_complex, TpetraVector, FMMOperator> BelosSolverFactory;
-  auto solver = BelosSolverFactory().create(belos_params_->get("Solver", "GMRES"), belos_params_);
+  auto const recycling = name == "GCRODR" and sources.cols() == 1;
+  if(recycling and not belos_params_->isParameter("Num Recycled Blocks"))
+    belos_params_->set("Num Recycled Blocks", static_cast<int>(parameters_.recycle));
+  // block methods iterate over all incident waves at once, unless told otherwise
+  auto params = belos_params_;
+  if(sources.cols() > 1 and (name == "GMRES" or name == "Block GMRES") and
+     not belos_params_->isParameter("Block Size")) {
+    params = Teuchos::rcp(new Teuchos::ParameterList(*belos_params_));
+    params->set("Block Size", static_cast<int>(sources.cols()));
+  }
+  auto solver = recycling and belos_state_ ? belos_state_->solver :
+                                             BelosSolverFactory().create(name, params);
   solver->setProblem(problem);
+  if(recycling and not belos_state_)
+    belos_state_ = std::make_shared<BelosState>(BelosState{solver});
 
   // Print out parameters for given verbosity
   if(belos_params_->get<int>("Verbosity", 0) & Belos::MsgType::FinalSummary) {
@@ -128,13 +274,80 @@ void FMMBelos::solve(Vector<t_complex> &X_sca_, Vector<t_complex> &X_int_) const
       solver->getCurrentParameters()->print(*out);
   }
 
-  if(solver->solve() != Belos::Converged)
+  auto const history = monitor_residuals(*solver);
+  auto const converged = solver->solve() == Belos::Converged;
+  iterations_ = solver->getNumIters();
+
+  Matrix<t_complex> result(x->getLocalLength(), x->getNumVectors());
+  for(t_uint i(0); i < static_cast<t_uint>(result.cols()); ++i)
+    result.col(i) =
+        Eigen::Map<Vector<t_complex> const>(x->getData(i).getRawPtr(), x->getLocalLength());
+
+  record->total = seconds_since(start);
+  record->iterations = iterations_;
+  record->converged = converged;
+  record->residuals = *history;
+  record->orthogonalization = std::max(0e0, record->total - record->apply - record->preconditioner);
+  if(parameters_.telemetry)
+    record->true_residual = true_residual(sources, result);
+  telemetry_.push_back(*record);
+  if(not converged)
     throw std::runtime_error("Belos optimizer did not converge");
+  return result;
+}
 
-  X_sca_ = Eigen::Map<Vector<t_complex> const>(x->getData(0).getRawPtr(), x->getLocalLength());
-  X_sca_ = communicator().all_gather(X_sca_);
-  X_sca_ = AbstractSolver::convertIndirect(X_sca_);
-  X_int_ = AbstractSolver::solveInternal(X_sca_);
+t_real FMMBelos::true_residual(Matrix<t_complex> const &sources,
+                               Matrix<t_complex> const &solution) const {
+  Matrix<t_complex> product;
+  (*fmm_)(solution, product);
+  Matrix<t_real> norms(2, sources.cols());
+  norms.row(0) = (sources - product).colwise().squaredNorm();
+  norms.row(1) = sources.colwise().squaredNorm();
+  norms = communicator().all_reduce(norms, MPI_SUM);
+  t_real result = 0;
+  for(t_uint i(0); i < static_cast<t_uint>(norms.cols()); ++i)
+    if(norms(1, i) > 0)
+      result = std::max(result, std::sqrt(norms(0, i) / norms(1, i)));
+  return result;
+}
+
+Matrix<t_complex>
+FMMBelos::iterate_sstep(Matrix<t_complex> const &sources, Matrix<t_complex> const &guess) const {
+  auto const fmm = fmm_;
+  auto const A = [fmm](Vector<t_complex> const &in, Vector<t_complex> &out) { out = *fmm * in; };
+  auto const comm = communicator();
+  auto const reduce = [comm](Matrix<t_complex> &partial) {
+    partial = comm.all_reduce(partial, MPI_SUM);
+  };
+  auto const tolerance = belos_params_->get("Convergence Tolerance", parameters_.tolerance);
+  auto const max_iterations =
+      belos_params_->get("Maximum Iterations", static_cast<int>(parameters_.max_iterations));
+  auto const restart = belos_params_->get("Num Blocks", static_cast<int>(parameters_.restart));
+
+  Matrix<t_complex> result(sources.rows(), sources.cols());
+  iterations_ = 0;
+  for(t_uint i(0); i < static_cast<t_uint>(sources.cols()); ++i) {
+    Telemetry record("s-step GMRES");
+    auto const start = TelemetryClock::now();
+    Vector<t_complex> x = guess.col(i);
+    auto const convergence = krylov::sstep_gmres(timed(A, record.apply), sources.col(i), x,
+                                                 tolerance, max_iterations, restart,
+                                                 parameters_.sstep,
+                                                 timed(preconditioner_, record.preconditioner),
+                                                 reduce);
+    record.finish(convergence, seconds_since(start));
+    telemetry_.push_back(record);
+    iterations_ += convergence.iterations;
+    if((belos_params_->get<int>("Verbosity", 0) & Belos::MsgType::FinalSummary) and
+       communicator().rank() == communicator().root_id())
+      std::cout << "s-step GMRES " << (convergence.converged ? "converged" : "failed")
+                << " after " << convergence.iterations << " iterations, relative residual "
+                << convergence.residual << "\n";
+    if(not convergence.converged)
+      throw std::runtime_error("s-step GMRES did not converge");
+    result.col(i) = x;
+  }
+  return result;
 }
 
 namespace {
@@ -147,20 +360,12 @@ Teuchos::RCP<const Teuchos::Comm<int>> teuchos_communicator(mpi::Communicator co
   return Teuchos::rcp(new Teuchos::MpiComm<int>(opaque_comm));
 }
 
-Teuchos::RCP<Tpetra::MultiVector<t_complex>>
-tpetra_vector(t_uint nglobals, Vector<t_complex> &x,
-              Teuchos::RCP<const Teuchos::Comm<int>> const &comm) {
-  Teuchos::ArrayView<t_complex> const array_view(x.data(), x.size());
-  auto const array_map = Teuchos::rcp(new Tpetra::Map<>(nglobals, x.size(), 0, comm));
-  return Teuchos::rcp(new Tpetra::MultiVector<t_complex>(array_map, array_view, x.size(), 1));
-}
-
-Teuchos::RCP<Tpetra::MultiVector<t_complex>>
-tpetra_vector(t_uint nglobals, Vector<t_complex> const &x,
-              Teuchos::RCP<const Teuchos::Comm<int>> const &comm) {
+template <class T>
+Teuchos::RCP<TpetraVector> tpetra_vector(t_uint nglobals, Eigen::PlainObjectBase<T> const &x,
+                                         Teuchos::RCP<const Teuchos::Comm<int>> const &comm) {
   Teuchos::ArrayView<t_complex const> const array_view(x.data(), x.size());
-  auto const array_map = Teuchos::rcp(new Tpetra::Map<>(nglobals, x.size(), 0, comm));
-  return Teuchos::rcp(new Tpetra::MultiVector<t_complex>(array_map, array_view, x.size(), 1));
+  auto const array_map = Teuchos::rcp(new Tpetra::Map<>(nglobals, x.rows(), 0, comm));
+  return Teuchos::rcp(new TpetraVector(array_map, array_view, x.rows(), x.cols()));
 }
 }
 }
@@ -17,6 +17,7 @@
 #ifndef OPTIMET_FMM_BELOS_SOLVER_H
 #define OPTIMET_FMM_BELOS_SOLVER_H
 
+#include "Preconditioner.h"
 #include "Run.h"
 #include "Solver.h"
 #include "Types.h"
@@ -28,22 +29,27 @@ namespace solver {
 
 #ifdef OPTIMET_MPI
 #ifdef OPTIMET_BELOS
-//! Belos optimizer using the Fast Matrix Multiply
+//! \brief Belos optimizer using the Fast Matrix Multiply
+//! \details With Belos' "GCRODR" solver, the solver manager and its recycled space persist
+//! across solves. The space is discarded when an update changes the operator by more than the
+//! recycle_threshold parameter. With "s-step GMRES", the solve bypasses Belos for
+//! krylov::sstep_gmres, which synchronizes the processes twice every sstep iterations only.
 class FMMBelos : public AbstractSolver {
 public:
   FMMBelos(
       std::shared_ptr<Geometry> geometry, std::shared_ptr<Excitation const> incWave,
       mpi::Communicator const &comm = mpi::Communicator(),
       Teuchos::RCP<Teuchos::ParameterList> belos_params = Teuchos::rcp(new Teuchos::ParameterList),
-      t_int subdiagonals = std::numeric_limits<t_int>::max())
+      t_int subdiagonals = std::numeric_limits<t_int>::max(),
+      Parameters const &parameters = Parameters())
       : AbstractSolver(geometry, incWave, comm), fmm_(nullptr), belos_params_(belos_params),
-        subdiagonals(subdiagonals) {
+        subdiagonals(subdiagonals), parameters_(parameters), iterations_(0) {
     update();
   }
 
   FMMBelos(Run const &run)
       : FMMBelos(run.geometry, run.excitation, run.communicator, run.belos_params,
-                 run.fmm_subdiagonals) {}
+                 run.fmm_subdiagonals, run.solver_params) {}
 
   ~FMMBelos(){};
 
@@ -55,6 +61,11 @@ public:
    * @return 0 if successful, 1 otherwise.
    */
   void solve(Vector<t_complex> &X_sca_, Vector<t_complex> &X_int_) const override;
+  //! \brief Solves for all incident waves at once
+  //! \details Belos' block methods iterate over a block of right-hand sides, one per wave. With
+  //! "GMRES", the block size defaults to the number of waves. Each iteration applies the FMM to
+  //! all columns together.
+  void solve_waves(Matrix<t_complex> &X_sca_, Matrix<t_complex> &X_int_) const override;
   //! \brief Update after internal parameters changed externally
   //! \details Because that's how the original implementation rocked.
   virtual void update() override;
@@ -63,16 +74,40 @@ public:
   //! \note Mere access to the parameters requires the Teuchos::ParameterList to be modifiable. So
   //! the constness is not quite respected here.
   Teuchos::RCP<Teuchos::ParameterList> belos_parameters() const { return belos_params_; }
+  //! \brief Preconditioner over the scatterers local to this process
+  //! \details Empty if the preconditioner parameter is "none".
+  krylov::Operator const &preconditioner() const { return preconditioner_; }
+  t_uint iterations() const override { return iterations_; }
 
 protected:
+  //! Belos objects kept alive across solves
+  struct BelosState;
+  //! Solves for the local part of each column, starting from the given guess
+  Matrix<t_complex> iterate(Matrix<t_complex> const &sources, Matrix<t_complex> const &guess) const;
+  //! Solves for each column in turn with s-step GMRES
+  Matrix<t_complex>
+  iterate_sstep(Matrix<t_complex> const &sources, Matrix<t_complex> const &guess) const;
+  //! Largest relative residual ||b - A x|| / ||b|| over the columns, computed explicitly
+  t_real true_residual(Matrix<t_complex> const &sources, Matrix<t_complex> const &solution) const;
+
   //! Fast-matrix multiply operator
   std::shared_ptr<mpi::FastMatrixMultiply> fmm_;
+  //! Preconditioner, or empty if none
+  krylov::Operator preconditioner_;
   //! Parameter list of the belos solvers
   Teuchos::RCP<Teuchos::ParameterList> belos_params_;
   //! The local field matrix Q = T*AB*a
   Vector<t_complex> Q;
+  //! Local source vector of each incident wave, when there are several
+  Matrix<t_complex> sources_;
   //! The number of subdiagonals when distributing calculations
   t_int subdiagonals;
+  //! Preconditioner parameters
+  Parameters parameters_;
+  //! Number of iterations of the last solve
+  mutable t_uint iterations_;
+  //! Solver manager holding the recycled space, if any
+  mutable std::shared_ptr<BelosState> belos_state_;
 };
 #endif
 #endif
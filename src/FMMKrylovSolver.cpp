@@ -0,0 +1,180 @@
+// (C) University College London 2017
+// This file is part of Optimet, licensed under the terms of the GNU Public License
+//
+// Optimet is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Optimet is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Optimet. If not, see <http://www.gnu.org/licenses/>.
+
+#include "FMMKrylovSolver.h"
+#include "PreconditionedMatrix.h"
+#include <algorithm>
+#include <iostream>
+
+namespace optimet {
+namespace solver {
+namespace {
+//! Couplings between scatterers at most range apart, including self-interactions
+Matrix<bool> couplings_within(std::vector<Scatterer> const &objects, t_real range) {
+  Matrix<bool> result(objects.size(), objects.size());
+  for(std::size_t i(0); i < objects.size(); ++i)
+    for(std::size_t j(0); j < objects.size(); ++j)
+      result(i, j) = (objects[i].vR.toEigenCartesian() - objects[j].vR.toEigenCartesian())
+                         .stableNorm() <= range;
+  return result;
+}
+
+//! Largest distance between two scatterers
+t_real largest_distance(std::vector<Scatterer> const &objects) {
+  t_real result = 0;
+  for(std::size_t i(0); i < objects.size(); ++i)
+    for(std::size_t j(i + 1); j < objects.size(); ++j)
+      result = std::max(result, (objects[i].vR.toEigenCartesian() -
+                                 objects[j].vR.toEigenCartesian()).stableNorm());
+  return result;
+}
+}
+
+void FMMKrylov::update_relaxed() {
+  relaxed_.clear();
+  relaxed_errors_.clear();
+  if(parameters_.inexact_levels == 0)
+    return;
+  auto const &objects = geometry->objects;
+  auto const exact = fmm_;
+  auto range = largest_distance(objects);
+  auto ncouplings = objects.size() * objects.size();
+  for(t_uint level(0); level < parameters_.inexact_levels; ++level) {
+    range *= 0.5;
+    auto const couplings = couplings_within(objects, range);
+    // a level which drops no coupling is no cheaper than the previous one
+    if(static_cast<std::size_t>(couplings.count()) == ncouplings)
+      continue;
+    ncouplings = couplings.count();
+    auto const relaxed = std::make_shared<FastMatrixMultiply const>(
+        geometry->bground, incWave->wavenumber(), objects, couplings);
+    relaxed_errors_.push_back(krylov::relative_change(
+        [exact](Vector<t_complex> const &in, Vector<t_complex> &out) { (*exact)(in, out); },
+        [relaxed](Vector<t_complex> const &in, Vector<t_complex> &out) { (*relaxed)(in, out); },
+        exact->cols()));
+    relaxed_.push_back(relaxed);
+    if(ncouplings == objects.size())
+      break;
+  }
+}
+
+void FMMKrylov::update() {
+  if(geometry and incWave) {
+    auto const previous = fmm_;
+    fmm_ = std::make_shared<FastMatrixMultiply>(geometry->bground, incWave->wavenumber(),
+                                                geometry->objects);
+    if(recycled_.cols() > 0) {
+      auto const recycle = previous and previous->cols() == fmm_->cols() and
+                           krylov::relative_change(
+                               [&previous](Vector<t_complex> const &in, Vector<t_complex> &out) {
+                                 (*previous)(in, out);
+                               },
+                               [this](Vector<t_complex> const &in, Vector<t_complex> &out) {
+                                 (*fmm_)(in, out);
+                               },
+                               fmm_->cols()) <= parameters_.recycle_threshold;
+      if(not recycle)
+        recycled_.resize(0, 0);
+    }
+    update_relaxed();
+    Q = source_vector(*geometry, incWave);
+    auto const fmm = fmm_;
+    preconditioner_ = solver::preconditioner(
+        parameters_, geometry->objects.begin(), geometry->objects.end(), geometry->bground,
+        incWave, [fmm](Vector<t_complex> const &in, Vector<t_complex> &out) { (*fmm)(in, out); });
+  } else {
+    fmm_ = nullptr;
+    preconditioner_ = krylov::Operator();
+    recycled_.resize(0, 0);
+    relaxed_.clear();
+    relaxed_errors_.clear();
+    Q = Vector<t_complex>::Zero(0);
+  }
+}
+
+void FMMKrylov::iterate(Vector<t_complex> const &b, Vector<t_complex> &x) const {
+  auto const inexact =
+      relaxed_.size() > 0 and (parameters_.krylov == "GMRES" or parameters_.krylov == "gmres");
+  Telemetry record(inexact ? "inexact GMRES" : parameters_.krylov);
+  auto const start = TelemetryClock::now();
+  auto const fmm = fmm_;
+  auto const A = timed(
+      [fmm](Vector<t_complex> const &in, Vector<t_complex> &out) { (*fmm)(in, out); },
+      record.apply);
+  auto const M = timed(preconditioner_, record.preconditioner);
+  applications_.clear();
+  if(inexact) {
+    std::vector<krylov::Operator> levels{A};
+    std::vector<t_real> errors{0};
+    for(std::size_t i(0); i < relaxed_.size(); ++i) {
+      auto const relaxed = relaxed_[i];
+      auto const level = [relaxed](Vector<t_complex> const &in, Vector<t_complex> &out) {
+        (*relaxed)(in, out);
+      };
+      levels.push_back(timed(level, record.apply));
+      errors.push_back(relaxed_errors_[i]);
+    }
+    convergence_ = krylov::solve_inexact(levels, errors, b, x, parameters_.tolerance,
+                                         parameters_.max_iterations, parameters_.restart, M,
+                                         &applications_);
+  } else if(parameters_.krylov == "s-step GMRES")
+    convergence_ = krylov::sstep_gmres(A, b, x, parameters_.tolerance, parameters_.max_iterations,
+                                       parameters_.restart, parameters_.sstep, M);
+  else
+    convergence_ = krylov::solve(parameters_.krylov, A, b, x, parameters_.tolerance,
+                                 parameters_.max_iterations, parameters_.restart, M,
+                                 parameters_.recycle, &recycled_);
+  record.finish(convergence_, seconds_since(start));
+  telemetry_.push_back(record);
+  if(parameters_.verbosity != 0 and communicator().rank() == communicator().root_id())
+    std::cout << parameters_.krylov << " " << (convergence_.converged ? "converged" : "failed")
+              << " after " << convergence_.iterations << " iterations, relative residual "
+              << convergence_.residual << "\n";
+  if(not convergence_.converged)
+    throw std::runtime_error(parameters_.krylov + " solver did not converge");
+}
+
+void FMMKrylov::solve(Vector<t_complex> &X_sca_, Vector<t_complex> &X_int_) const {
+  if(initial_guess_.size() == Q.size())
+    X_sca_ = initial_guess_;
+  else
+    X_sca_ = Vector<t_complex>::Zero(Q.size());
+  telemetry_.clear();
+  iterate(Q, X_sca_);
+
+  solution_ = X_sca_;
+  X_sca_ = AbstractSolver::convertIndirect(X_sca_);
+  X_int_ = AbstractSolver::solveInternal(X_sca_);
+}
+
+void FMMKrylov::solve_waves(Matrix<t_complex> &X_sca_, Matrix<t_complex> &X_int_) const {
+  auto const sources = source_vectors(*geometry, incWave);
+  X_sca_.resize(sources.rows(), sources.cols());
+  X_int_.resize(sources.rows(), sources.cols());
+  t_uint iterations = 0;
+  telemetry_.clear();
+  for(t_uint i(0); i < static_cast<t_uint>(sources.cols()); ++i) {
+    Vector<t_complex> x = Vector<t_complex>::Zero(sources.rows());
+    iterate(sources.col(i), x);
+    iterations += convergence_.iterations;
+    Vector<t_complex> const scattered = AbstractSolver::convertIndirect(x);
+    X_sca_.col(i) = scattered;
+    X_int_.col(i) = AbstractSolver::solveInternal(scattered);
+  }
+  convergence_.iterations = iterations;
+}
+}
+}
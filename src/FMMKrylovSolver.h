@@ -0,0 +1,108 @@
+// (C) University College London 2017
+// This file is part of Optimet, licensed under the terms of the GNU Public License
+//
+// Optimet is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Optimet is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Optimet. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef OPTIMET_FMM_KRYLOV_SOLVER_H
+#define OPTIMET_FMM_KRYLOV_SOLVER_H
+
+#include "FastMatrixMultiply.h"
+#include "Krylov.h"
+#include "Preconditioner.h"
+#include "Run.h"
+#include "Solver.h"
+#include "Types.h"
+#include <memory>
+#include <vector>
+
+namespace optimet {
+namespace solver {
+
+//! \brief Serial matrix-free Krylov solver using the Fast Matrix Multiply
+//! \details Does not require Belos. The method and its convergence criteria are given by the
+//! krylov, tolerance, max_iterations and restart parameters. The system can be preconditioned
+//! with a block-Jacobi operator built from clusters of near neighbours, or with a two-level
+//! p-multigrid cycle over the order of the harmonics. With "GCRODR", the
+//! recycled space is kept from one solve to the next, unless an update changes the operator by
+//! more than the recycle_threshold parameter. With inexact_levels, GMRES relaxes the accuracy of
+//! the operator as it converges, by dropping the couplings between distant scatterers.
+class FMMKrylov : public AbstractSolver {
+public:
+  FMMKrylov(std::shared_ptr<Geometry> geometry, std::shared_ptr<Excitation const> incWave,
+            mpi::Communicator const &communicator = mpi::Communicator(),
+            Parameters const &parameters = Parameters())
+      : AbstractSolver(geometry, incWave, communicator), parameters_(parameters),
+        convergence_{0, 0, false, {}} {
+    update();
+  }
+  FMMKrylov(Run const &run)
+      : FMMKrylov(run.geometry, run.excitation, run.communicator, run.solver_params) {}
+
+  void solve(Vector<t_complex> &X_sca_, Vector<t_complex> &X_int_) const override;
+  //! \brief Solves for each incident wave in turn, with the same operator and preconditioner
+  //! \details With "GCRODR", each wave benefits from the space recycled by the previous ones.
+  void solve_waves(Matrix<t_complex> &X_sca_, Matrix<t_complex> &X_int_) const override;
+
+  using AbstractSolver::update;
+  void update() override;
+
+  //! Fast-matrix multiply operator
+  std::shared_ptr<FastMatrixMultiply const> fmm() const { return fmm_; }
+  //! Preconditioner, or empty if none
+  krylov::Operator const &preconditioner() const { return preconditioner_; }
+  //! Parameters of the solver
+  Parameters const &parameters() const { return parameters_; }
+  //! Convergence of the last solve
+  krylov::Convergence const &convergence() const { return convergence_; }
+  t_uint iterations() const override { return convergence_.iterations; }
+  //! Space recycled by GCRODR from the previous solves, possibly empty
+  Matrix<t_complex> const &recycled() const { return recycled_; }
+  //! Approximations of the operator used by inexact GMRES, from most to least accurate
+  std::vector<std::shared_ptr<FastMatrixMultiply const>> const &relaxed() const {
+    return relaxed_;
+  }
+  //! Estimated relative error of each approximation of the operator
+  std::vector<t_real> const &relaxed_errors() const { return relaxed_errors_; }
+  //! \brief Applications of the exact operator and of each approximation during the last solve
+  //! \details Empty unless inexact GMRES was used.
+  std::vector<t_uint> const &applications() const { return applications_; }
+
+protected:
+  //! Solves S x = b, starting from x
+  void iterate(Vector<t_complex> const &b, Vector<t_complex> &x) const;
+  //! Recomputes the approximations of the operator used by inexact GMRES
+  void update_relaxed();
+
+  //! Fast-matrix multiply operator
+  std::shared_ptr<FastMatrixMultiply> fmm_;
+  //! Preconditioner, or empty if none
+  krylov::Operator preconditioner_;
+  //! The local field matrix Q = T*AB*a
+  Vector<t_complex> Q;
+  //! Krylov method and convergence criteria
+  Parameters parameters_;
+  //! Convergence of the last solve
+  mutable krylov::Convergence convergence_;
+  //! Space recycled by GCRODR across solves
+  mutable Matrix<t_complex> recycled_;
+  //! Approximations of the operator with fewer couplings
+  std::vector<std::shared_ptr<FastMatrixMultiply const>> relaxed_;
+  //! Estimated relative error of each approximation
+  std::vector<t_real> relaxed_errors_;
+  //! Applications of each level of the operator during the last solve
+  mutable std::vector<t_uint> applications_;
+};
+}
+}
+#endif
@@ -17,11 +17,11 @@
 #include "Coupling.h"
 #include "Geometry.h"
 
-#include "Algebra.h"
 #include "Bessel.h"
 #include "CompoundIterator.h"
 #include "HarmonicsIterator.h"
 #include "Symbol.h"
+#include "Threads.h"
 #include "Tools.h"
 #include "Types.h"
 #include "constants.h"
@@ -134,11 +134,11 @@ int Geometry::getNLSources(double omega_, int objectIndex_, int nMax_,
     // obtain diagonal source matrices --------------------------------
     // SRC_2w_p - TE Part
     sourceU[p] = x_b2 * dpsi2 / (xsi2 * dpsi2 - zeta_boj2 * psi2 * dxsi2);                    // u'
-    sourceU[p + nMax_] = zeta_boj2 * x_b2 * psi2 / (zeta_boj2 * psi2 * dxsi2 - xsi2 * dpsi2); // u''
+    sourceU[p + pMax] = zeta_boj2 * x_b2 * psi2 / (zeta_boj2 * psi2 * dxsi2 - xsi2 * dpsi2); // u''
 
     // SRC_2w_p - TM part
     sourceV[p] = x_b2 * psi2 / (zeta_boj2 * xsi2 * dpsi2 - psi2 * dxsi2); // v'
-    sourceV[p + nMax_] = std::complex<double>(0., 0.);                    // v''
+    sourceV[p + pMax] = std::complex<double>(0., 0.);                     // v''
   }
 
   return 0;
@@ -223,39 +223,39 @@ int Geometry::checkInner(Spherical<double> R_) {
 }
 
 int Geometry::setSourcesSingle(std::shared_ptr<optimet::Excitation const> incWave_,
-                               std::complex<double> const *internalCoef_FF_, int nMax_) {
-  CompoundIterator p;
-  int pMax = p.max(nMax_);
-
-  std::complex<double> *sourceU = new std::complex<double>[2 * pMax];
-  std::complex<double> *sourceV = new std::complex<double>[2 * pMax];
-
+                               std::complex<double> const *internalCoef_FF_) {
+  int const nObjects = objects.size();
   auto const omega = incWave_->omega();
-  for(size_t j = 0; j < objects.size(); j++) {
-    getNLSources(omega, j, nMax_, sourceU, sourceV);
-
-    for(p = 0; p < pMax; p++) {
-      objects[j].sourceCoef[static_cast<int>(p)] =
-          sourceU[p] * optimet::symbol::up_mn(p.second, p.first, nMax_,
-                                              internalCoef_FF_[j * 2 * pMax + p.compound],
-                                              internalCoef_FF_[pMax + j * 2 * pMax + p.compound],
-                                              omega, objects[j], bground) +
-          sourceV[p] * optimet::symbol::vp_mn(p.second, p.first, nMax_,
-                                              internalCoef_FF_[j * 2 * pMax + p.compound],
-                                              internalCoef_FF_[pMax + j * 2 * pMax + p.compound],
-                                              omega, objects[j], bground);
-
-      objects[j].sourceCoef[static_cast<int>(p) + pMax] =
-          sourceU[p + pMax] *
-              optimet::symbol::upp_mn(
-                  p.second, p.first, nMax_, internalCoef_FF_[j * 2 * pMax + p.compound],
-                  internalCoef_FF_[pMax + j * 2 * pMax + p.compound], omega, objects[j]) +
-          sourceV[p + pMax]; //<- this last bit is zero for the moment
+  std::vector<int> offsets(1, 0);
+  for(auto const &object : objects)
+    offsets.push_back(offsets.back() + 2 * CompoundIterator::max(object.nMax));
+
+  optimet::parallel_for(nObjects, [&](int j) {
+    int const nMax_ = objects[j].nMax;
+    int const pMax = CompoundIterator::max(nMax_);
+    optimet::Vector<optimet::t_complex> sourceU(2 * pMax), sourceV(2 * pMax);
+    getNLSources(omega, j, nMax_, sourceU.data(), sourceV.data());
+
+    Eigen::Map<optimet::Vector<optimet::t_complex> const> const internal(
+        internalCoef_FF_ + offsets[j], 2 * pMax);
+    auto const te = internal.head(pMax);
+    auto const tm = internal.tail(pMax);
+    for(CompoundIterator p = 0; p < pMax; p++) {
+      objects[j].sourceCoef[p.compound] =
+          sourceU[p.compound] * optimet::symbol::up_mn(p.second, p.first, nMax_,
+                                                       te[p.compound], tm[p.compound], omega,
+                                                       objects[j], bground) +
+          sourceV[p.compound] * optimet::symbol::vp_mn(p.second, p.first, nMax_,
+                                                       te[p.compound], tm[p.compound], omega,
+                                                       objects[j], bground);
+
+      objects[j].sourceCoef[p.compound + pMax] =
+          sourceU[p.compound + pMax] * optimet::symbol::upp_mn(p.second, p.first, nMax_,
+                                                               te[p.compound], tm[p.compound],
+                                                               omega, objects[j]) +
+          sourceV[p.compound + pMax]; //<- this last bit is zero for the moment
     }
-  }
-
-  delete[] sourceU;
-  delete[] sourceV;
+  });
 
   return 0;
 }
@@ -272,55 +272,28 @@ optimet::Vector<optimet::t_complex> Geometry::getTLocal(optimet::t_real omega_,
 
 int Geometry::getSourceLocal(int objectIndex_, std::shared_ptr<optimet::Excitation const> incWave_,
                              int nMax_, std::complex<double> *Q_SH_local_) const {
-  CompoundIterator p;
-  CompoundIterator q;
-
-  int pMax = p.max(nMax_);
-  int qMax = q.max(nMax_);
-
-  // Make sure Q_SH_local_ is zero
-  for(p = 0; p < pMax; p++) {
-    Q_SH_local_[p] = std::complex<double>(0.0, 0.0);
-    Q_SH_local_[p + pMax] = std::complex<double>(0.0, 0.0);
-  }
-
-  std::complex<double> **T_AB = Tools::Get_2D_c_double(2 * pMax, 2 * qMax);
-  std::complex<double> *Q_interm = new std::complex<double>[pMax + qMax];
+  auto const pMax = CompoundIterator::max(nMax_);
+  Eigen::Map<optimet::Vector<optimet::t_complex>> result(Q_SH_local_, 2 * pMax);
+  result.fill(0);
 
   for(size_t j = 0; j < objects.size(); j++) {
     if(static_cast<int>(j) == objectIndex_)
       continue;
 
-    // Build the T_AB matrix
-    optimet::Coupling const AB(objects[objectIndex_].vR - objects[j].vR, incWave_->waveK, nMax_);
-
-    for(p = 0; p < pMax; p++) {
-      for(q = 0; q < qMax; q++) {
-        T_AB[p][q] = AB.diagonal(p, q);
-        T_AB[p + pMax][q + qMax] = AB.diagonal(p, q);
-        T_AB[p + pMax][q] = AB.offdiagonal(p, q);
-        T_AB[p][q + qMax] = AB.offdiagonal(p, q);
-      }
-    }
-
-    // Multiply T_AB with the single local sources
-    Algebra::multiplyVectorMatrix(T_AB, 2 * pMax, 2 * qMax, objects[j].sourceCoef.data(), Q_interm,
-                                  consC1, consC1);
-
-    // Finally, add Q_interm to Q_SH_local
-    for(p = 0; p < pMax; p++) {
-      Q_SH_local_[p] += Q_interm[p];
-      Q_SH_local_[p + pMax] += Q_interm[p + pMax];
-    }
+    int const qMax = CompoundIterator::max(objects[j].nMax);
+    optimet::Coupling const AB(objects[objectIndex_].vR - objects[j].vR, incWave_->waveK,
+                               std::max<int>(nMax_, objects[j].nMax));
+    // outgoing to regular translation, transposed as in the scattering matrix
+    auto const A = AB.diagonal.topLeftCorner(qMax, pMax).transpose();
+    auto const B = AB.offdiagonal.topLeftCorner(qMax, pMax).transpose();
+    Eigen::Map<optimet::Vector<optimet::t_complex> const> const source(
+        objects[j].sourceCoef.data(), 2 * qMax);
+
+    // Translate the single local sources of j to objectIndex_
+    result.head(pMax) += A * source.head(qMax) + B * source.tail(qMax);
+    result.tail(pMax) += B * source.head(qMax) + A * source.tail(qMax);
   }
 
-  // Clear up the memory
-  for(int i = 0; i < 2 * pMax; i++)
-    delete[] T_AB[i];
-
-  delete[] T_AB;
-  delete[] Q_interm;
-
   return 0;
 }
 
@@ -98,6 +98,15 @@ public:
 
   int getCabsAux(double omega_, int objectIndex_, int nMax_, double *Cabs_aux_);
 
+  /**
+   * Computes the diagonal second harmonic source matrices of a single object.
+   * @param omega_ the angular frequency of the simulation.
+   * @param objectIndex_ the index of the object.
+   * @param nMax_ the maximum value of the n iterator.
+   * @param sourceU u' then u'' coefficients, 2 * pMax elements.
+   * @param sourceV v' then v'' coefficients, 2 * pMax elements.
+   * @return 0 if successful, 1 otherwise.
+   */
   int getNLSources(double omega_, int objectIndex_, int nMax_, std::complex<double> *sourceU,
                    std::complex<double> *sourceV) const;
 
@@ -122,15 +131,24 @@ public:
    * @param incWave_ pointer to the incoming excitation.
    * @param scatterCoef_ pointer to the ENTIRE scattering coefficients for the
    * FF case
-   * @param nMax_ the maximum value of the n iterator.
+   * @param nMax_ the maximum value of the n iterator, sources of other objects are truncated
+   * at their own nMax.
    * @param Q_SH_local_ the return value of the local SH source vector.
    * @return 0 if successful, 1 otherwise.
    */
   int getSourceLocal(int objectIndex_, std::shared_ptr<optimet::Excitation const> incWave_,
                      int nMax_, std::complex<double> *Q_SH_local_) const;
 
+  /**
+   * Sets the single object second harmonic sources of all objects.
+   * Objects are processed in parallel.
+   * @param incWave_ pointer to the incoming excitation.
+   * @param internalCoef_FF_ the internal coefficients of the FF case, for all objects, each
+   * truncated at its own nMax.
+   * @return 0 if successful, 1 otherwise.
+   */
   int setSourcesSingle(std::shared_ptr<optimet::Excitation const> incWave_,
-                       std::complex<double> const *internalCoef_FF_, int nMax_);
+                       std::complex<double> const *internalCoef_FF_);
 
   /**
    * Updates the Geometry object to a new Excitation.
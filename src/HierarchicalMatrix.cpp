@@ -0,0 +1,289 @@
+// (C) University College London 2017
+// This file is part of Optimet, licensed under the terms of the GNU Public License
+//
+// Optimet is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Optimet is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Optimet. If not, see <http://www.gnu.org/licenses/>.
+
+#include "Clustering.h"
+#include "HierarchicalMatrix.h"
+#include "PreconditionedMatrix.h"
+#include "Threads.h"
+#include <algorithm>
+#include <map>
+#include <numeric>
+
+namespace optimet {
+
+HierarchicalMatrix::HierarchicalMatrix(std::vector<Scatterer> const &objects,
+                                       ElectroMagnetic const &bground,
+                                       std::shared_ptr<Excitation const> incWave,
+                                       t_real tolerance, t_uint leaf_size)
+    : objects_(objects), bground_(bground), incWave_(incWave), tolerance_(tolerance) {
+  permutation_.resize(objects.size());
+  std::iota(permutation_.begin(), permutation_.end(), 0);
+  if(objects.size() > 0)
+    build(permutation_, 0, objects.size(), leaf_size);
+
+  // Rows of the tree-ordered matrix in the original matrix
+  auto const original = scatterer_offsets(objects.begin(), objects.end());
+  for(t_uint i(0); i < objects.size(); ++i)
+    objects_[i] = objects[permutation_[i]];
+  offsets_ = scatterer_offsets(objects_.begin(), objects_.end());
+  rows_.resize(offsets_.back());
+  for(t_uint i(0); i < objects.size(); ++i)
+    std::iota(rows_.begin() + offsets_[i], rows_.begin() + offsets_[i + 1],
+              original[permutation_[i]]);
+
+  // Blocks are independent of one another
+  parallel_for(nodes_.size(), [this](t_int i) {
+    auto &node = nodes_[i];
+    if(node.is_leaf())
+      node.dense = preconditioned_scattering_matrix(
+          objects_.begin() + node.first, objects_.begin() + node.last,
+          objects_.begin() + node.first, objects_.begin() + node.last, bground_, incWave_);
+    else {
+      compress(nodes_[node.left], nodes_[node.right], node.U12, node.V12);
+      compress(nodes_[node.right], nodes_[node.left], node.U21, node.V21);
+    }
+  });
+  if(nodes_.size() > 0)
+    factorize(0);
+}
+
+t_uint HierarchicalMatrix::build(std::vector<t_uint> &order, t_uint first, t_uint last,
+                                 t_uint leaf_size) {
+  t_uint const result = nodes_.size();
+  nodes_.emplace_back();
+  nodes_.back().first = first;
+  nodes_.back().last = last;
+  nodes_.back().left = 0;
+  nodes_.back().right = 0;
+
+  auto const middle = bisect_scatterers(objects_.begin(), order, first, last, leaf_size);
+  if(middle == last)
+    return result;
+  auto const left = build(order, first, middle, leaf_size);
+  auto const right = build(order, middle, last, leaf_size);
+  nodes_[result].left = left;
+  nodes_[result].right = right;
+  return result;
+}
+
+void HierarchicalMatrix::compress(Node const &rows, Node const &cols, Matrix<t_complex> &U,
+                                  Matrix<t_complex> &V) const {
+  t_uint const m = size(rows), n = size(cols);
+  auto const row0 = offsets_[rows.first], col0 = offsets_[cols.first];
+  auto const owner = [this](t_uint global) -> t_uint {
+    return std::upper_bound(offsets_.begin(), offsets_.end(), global) - offsets_.begin() - 1;
+  };
+  // Rows and columns are sampled one scatterer at a time
+  std::map<t_uint, Matrix<t_complex>> row_bands, col_bands;
+  auto const row = [&](t_uint i) -> Vector<t_complex> {
+    auto const s = owner(row0 + i);
+    auto found = row_bands.find(s);
+    if(found == row_bands.end())
+      found = row_bands
+                  .emplace(s, preconditioned_scattering_matrix(
+                                  objects_.begin() + s, objects_.begin() + s + 1,
+                                  objects_.begin() + cols.first, objects_.begin() + cols.last,
+                                  bground_, incWave_))
+                  .first;
+    return found->second.row(row0 + i - offsets_[s]).transpose();
+  };
+  auto const col = [&](t_uint j) -> Vector<t_complex> {
+    auto const s = owner(col0 + j);
+    auto found = col_bands.find(s);
+    if(found == col_bands.end())
+      found = col_bands
+                  .emplace(s, preconditioned_scattering_matrix(
+                                  objects_.begin() + rows.first, objects_.begin() + rows.last,
+                                  objects_.begin() + s, objects_.begin() + s + 1, bground_,
+                                  incWave_))
+                  .first;
+    return found->second.col(col0 + j - offsets_[s]);
+  };
+
+  // ACA with partial pivoting
+  std::vector<Vector<t_complex>> us, vs;
+  std::vector<bool> used(m, false);
+  t_real norm2(0);
+  t_uint i(0);
+  while(us.size() < std::min(m, n)) {
+    used[i] = true;
+    Vector<t_complex> v = row(i);
+    for(t_uint l(0); l < us.size(); ++l)
+      v -= us[l](i) * vs[l];
+    t_uint j;
+    auto const pivot = v.cwiseAbs().maxCoeff(&j);
+    if(pivot > 0) {
+      v /= v(j);
+      Vector<t_complex> u = col(j);
+      for(t_uint l(0); l < us.size(); ++l)
+        u -= vs[l](j) * us[l];
+      auto const nu = u.squaredNorm(), nv = v.squaredNorm();
+      for(t_uint l(0); l < us.size(); ++l)
+        norm2 += 2 * std::real(us[l].dot(u) * vs[l].dot(v));
+      norm2 += nu * nv;
+      us.push_back(u);
+      vs.push_back(v);
+      if(std::sqrt(nu * nv) <= tolerance_ * std::sqrt(std::abs(norm2)))
+        break;
+    }
+    // next pivot row: largest entry of the last column, among rows not yet sampled
+    t_real largest(-1);
+    for(t_uint k(0); k < m; ++k)
+      if(not used[k]) {
+        auto const value = us.size() > 0 ? std::abs(us.back()(k)) : 0;
+        if(value > largest) {
+          largest = value;
+          i = k;
+        }
+      }
+    if(largest < 0)
+      break;
+  }
+
+  U.resize(m, us.size());
+  V.resize(n, vs.size());
+  for(t_uint l(0); l < us.size(); ++l) {
+    U.col(l) = us[l];
+    V.col(l) = vs[l];
+  }
+  if(us.size() == 0)
+    return;
+
+  // Recompression: U V^T = Qu Ru Rv^T Qv^T, truncating the singular values of Ru Rv^T
+  t_uint const k = us.size();
+  Eigen::HouseholderQR<Matrix<t_complex>> const qr_u(U), qr_v(V);
+  Matrix<t_complex> const Ru = qr_u.matrixQR().topRows(k).triangularView<Eigen::Upper>();
+  Matrix<t_complex> const Rv = qr_v.matrixQR().topRows(k).triangularView<Eigen::Upper>();
+  Eigen::JacobiSVD<Matrix<t_complex>> const svd(Ru * Rv.transpose(),
+                                                Eigen::ComputeFullU | Eigen::ComputeFullV);
+  auto const &sigma = svd.singularValues();
+  t_uint rank(0);
+  while(rank < k and sigma(rank) > tolerance_ * sigma(0))
+    ++rank;
+  Matrix<t_complex> const Qu = qr_u.householderQ() * Matrix<t_complex>::Identity(m, k);
+  Matrix<t_complex> const Qv = qr_v.householderQ() * Matrix<t_complex>::Identity(n, k);
+  U = Qu * svd.matrixU().leftCols(rank) * sigma.head(rank).asDiagonal();
+  V = Qv * svd.matrixV().leftCols(rank).conjugate();
+}
+
+void HierarchicalMatrix::factorize(t_uint index) {
+  auto &node = nodes_[index];
+  if(node.is_leaf()) {
+    node.lu.compute(node.dense);
+    return;
+  }
+  factorize(node.left);
+  factorize(node.right);
+  node.W12 = node.U12;
+  apply_inverse(node.left, node.W12);
+  node.W21 = node.U21;
+  apply_inverse(node.right, node.W21);
+  t_uint const r12 = node.U12.cols(), r21 = node.U21.cols();
+  if(r12 + r21 == 0)
+    return;
+  Matrix<t_complex> K = Matrix<t_complex>::Identity(r12 + r21, r12 + r21);
+  K.topRightCorner(r12, r21) = node.V12.transpose() * node.W21;
+  K.bottomLeftCorner(r21, r12) = node.V21.transpose() * node.W12;
+  node.capacitance.compute(K);
+}
+
+void HierarchicalMatrix::apply_inverse(t_uint index, Eigen::Ref<Matrix<t_complex>> X) const {
+  auto const &node = nodes_[index];
+  if(node.is_leaf()) {
+    Matrix<t_complex> const result = node.lu.solve(X);
+    X = result;
+    return;
+  }
+  auto const m = size(nodes_[node.left]);
+  auto X1 = X.topRows(m);
+  auto X2 = X.bottomRows(X.rows() - m);
+  apply_inverse(node.left, X1);
+  apply_inverse(node.right, X2);
+  t_uint const r12 = node.U12.cols(), r21 = node.U21.cols();
+  if(r12 + r21 == 0)
+    return;
+  Matrix<t_complex> rhs(r12 + r21, X.cols());
+  rhs.topRows(r12) = node.V12.transpose() * X2;
+  rhs.bottomRows(r21) = node.V21.transpose() * X1;
+  Matrix<t_complex> const ab = node.capacitance.solve(rhs);
+  X1 -= node.W12 * ab.topRows(r12);
+  X2 -= node.W21 * ab.bottomRows(r21);
+}
+
+Matrix<t_complex>
+HierarchicalMatrix::apply(t_uint index, Eigen::Ref<Matrix<t_complex> const> const &X) const {
+  auto const &node = nodes_[index];
+  if(node.is_leaf())
+    return node.dense * X;
+  auto const m = size(nodes_[node.left]);
+  auto const X1 = X.topRows(m);
+  auto const X2 = X.bottomRows(X.rows() - m);
+  Matrix<t_complex> result(X.rows(), X.cols());
+  result.topRows(m) = apply(node.left, X1) + node.U12 * (node.V12.transpose() * X2);
+  result.bottomRows(X.rows() - m) = apply(node.right, X2) + node.U21 * (node.V21.transpose() * X1);
+  return result;
+}
+
+Matrix<t_complex> HierarchicalMatrix::solve(Matrix<t_complex> const &B) const {
+  Matrix<t_complex> X(B.rows(), B.cols());
+  for(t_uint i(0); i < rows_.size(); ++i)
+    X.row(i) = B.row(rows_[i]);
+  if(nodes_.size() > 0)
+    apply_inverse(0, X);
+  Matrix<t_complex> result(B.rows(), B.cols());
+  for(t_uint i(0); i < rows_.size(); ++i)
+    result.row(rows_[i]) = X.row(i);
+  return result;
+}
+
+Matrix<t_complex> HierarchicalMatrix::apply(Matrix<t_complex> const &X) const {
+  Matrix<t_complex> input(X.rows(), X.cols());
+  for(t_uint i(0); i < rows_.size(); ++i)
+    input.row(i) = X.row(rows_[i]);
+  Matrix<t_complex> const output = nodes_.size() > 0 ? apply(0, input) : input;
+  Matrix<t_complex> result(X.rows(), X.cols());
+  for(t_uint i(0); i < rows_.size(); ++i)
+    result.row(rows_[i]) = output.row(i);
+  return result;
+}
+
+t_uint HierarchicalMatrix::memory() const {
+  t_uint result(0);
+  for(auto const &node : nodes_)
+    result += node.dense.size() + node.U12.size() + node.V12.size() + node.U21.size() +
+              node.V21.size();
+  return result;
+}
+
+t_uint HierarchicalMatrix::max_rank() const {
+  t_uint result(0);
+  for(auto const &node : nodes_)
+    result = std::max<t_uint>(result, std::max(node.U12.cols(), node.U21.cols()));
+  return result;
+}
+
+t_uint HierarchicalMatrix::depth() const {
+  // children always come after their parent
+  std::vector<t_uint> depths(nodes_.size(), 0);
+  t_uint result(0);
+  for(t_uint i(0); i < nodes_.size(); ++i)
+    if(not nodes_[i].is_leaf()) {
+      depths[nodes_[i].left] = depths[nodes_[i].right] = depths[i] + 1;
+      result = std::max(result, depths[i] + 1);
+    }
+  return result;
+}
+}
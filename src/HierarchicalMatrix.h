@@ -0,0 +1,113 @@
+// (C) University College London 2017
+// This file is part of Optimet, licensed under the terms of the GNU Public License
+//
+// Optimet is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Optimet is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Optimet. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef OPTIMET_HIERARCHICAL_MATRIX_H
+#define OPTIMET_HIERARCHICAL_MATRIX_H
+
+#include "ElectroMagnetic.h"
+#include "Excitation.h"
+#include "Scatterer.h"
+#include "Types.h"
+#include <Eigen/Dense>
+#include <memory>
+#include <vector>
+
+namespace optimet {
+//! \brief Hierarchically off-diagonal low-rank (HODLR) form of the preconditioned scattering matrix
+//! \details Scatterers are ordered by recursive bisection of their bounding box. At each level of
+//! the resulting tree, the two off-diagonal blocks coupling sibling clusters are compressed with
+//! adaptive cross approximation (ACA), sampling only the rows and columns of individual
+//! scatterers. Leaves are stored densely. The factorization inverts the leaves and applies the
+//! low-rank corrections with the Sherman-Morrison-Woodbury formula, in O(N log^2 N) operations.
+class HierarchicalMatrix {
+public:
+  //! \brief Compresses and factorizes the scattering matrix
+  //! \param[in] objects: scatterers, in any order
+  //! \param[in] tolerance: relative accuracy of the low-rank blocks
+  //! \param[in] leaf_size: maximum number of unknowns in a dense leaf, unless it is a single
+  //! scatterer
+  HierarchicalMatrix(std::vector<Scatterer> const &objects, ElectroMagnetic const &bground,
+                     std::shared_ptr<Excitation const> incWave, t_real tolerance = 1e-8,
+                     t_uint leaf_size = 256);
+
+  //! Number of rows and columns
+  t_uint rows() const { return offsets_.back(); }
+  //! Solves S X = B, with B ordered as the original scatterers
+  Matrix<t_complex> solve(Matrix<t_complex> const &B) const;
+  //! Applies the compressed matrix, with X ordered as the original scatterers
+  Matrix<t_complex> apply(Matrix<t_complex> const &X) const;
+  //! Number of complex numbers stored for the compressed matrix, excluding its factors
+  t_uint memory() const;
+  //! Largest rank of any off-diagonal block
+  t_uint max_rank() const;
+  //! Depth of the cluster tree, zero if it is a single leaf
+  t_uint depth() const;
+
+protected:
+  //! A cluster of scatterers, contiguous in tree order
+  struct Node {
+    //! First and one-past-last scatterer, in tree order
+    t_uint first, last;
+    //! Children in the list of nodes, if not a leaf
+    t_uint left, right;
+    //! Leaf: the dense diagonal block
+    Matrix<t_complex> dense;
+    //! Leaf: LU factorization of the diagonal block
+    Eigen::PartialPivLU<Matrix<t_complex>> lu;
+    //! Block coupling left to right clusters, approximated as U12 * V12^T
+    Matrix<t_complex> U12, V12;
+    //! Block coupling right to left clusters, approximated as U21 * V21^T
+    Matrix<t_complex> U21, V21;
+    //! Inverses of the children applied to U12 and U21
+    Matrix<t_complex> W12, W21;
+    //! Factorization of the Sherman-Morrison-Woodbury capacitance matrix
+    Eigen::PartialPivLU<Matrix<t_complex>> capacitance;
+
+    bool is_leaf() const { return left == 0; }
+  };
+
+  //! Scatterers in tree order
+  std::vector<Scatterer> objects_;
+  //! Original index of each scatterer in tree order
+  std::vector<t_uint> permutation_;
+  //! Offset of each scatterer in tree order, followed by the number of unknowns
+  std::vector<t_uint> offsets_;
+  //! Row of the original matrix corresponding to each row in tree order
+  std::vector<t_uint> rows_;
+  //! Cluster tree, with the root first
+  std::vector<Node> nodes_;
+  //! Background medium and excitation, to sample the matrix
+  ElectroMagnetic bground_;
+  std::shared_ptr<Excitation const> incWave_;
+  //! Relative accuracy of the low-rank blocks
+  t_real tolerance_;
+
+  //! Recursively bisects the scatterers in [first, last) and creates the corresponding nodes
+  t_uint build(std::vector<t_uint> &order, t_uint first, t_uint last, t_uint leaf_size);
+  //! Low-rank approximation U * V^T of the block between two clusters, via ACA
+  void compress(Node const &rows, Node const &cols, Matrix<t_complex> &U,
+                Matrix<t_complex> &V) const;
+  //! Factorizes node and its children
+  void factorize(t_uint node);
+  //! Applies the inverse of the diagonal block of node, in place
+  void apply_inverse(t_uint node, Eigen::Ref<Matrix<t_complex>> X) const;
+  //! Applies the diagonal block of node
+  Matrix<t_complex> apply(t_uint node, Eigen::Ref<Matrix<t_complex> const> const &X) const;
+  //! Rows of the scattering matrix belonging to a node
+  t_uint size(Node const &node) const { return offsets_[node.last] - offsets_[node.first]; }
+};
+}
+#endif
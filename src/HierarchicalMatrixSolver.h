@@ -0,0 +1,71 @@
+// (C) University College London 2017
+// This file is part of Optimet, licensed under the terms of the GNU Public License
+//
+// Optimet is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Optimet is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Optimet. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef OPTIMET_HIERARCHICAL_MATRIX_SOLVER_H
+#define OPTIMET_HIERARCHICAL_MATRIX_SOLVER_H
+
+#include "HierarchicalMatrix.h"
+#include "PreconditionedMatrix.h"
+#include "Solver.h"
+#include "Types.h"
+#include <memory>
+
+namespace optimet {
+namespace solver {
+
+//! Direct solver using the hierarchically compressed scattering matrix
+class HierarchicalMatrix : public AbstractSolver {
+public:
+  HierarchicalMatrix(std::shared_ptr<Geometry> geometry, std::shared_ptr<Excitation const> incWave,
+                     mpi::Communicator const &communicator = mpi::Communicator(),
+                     Parameters const &parameters = Parameters())
+      : AbstractSolver(geometry, incWave, communicator), parameters_(parameters) {
+    update();
+  }
+  HierarchicalMatrix(Run const &run)
+      : HierarchicalMatrix(run.geometry, run.excitation, run.communicator, run.solver_params) {}
+
+  void solve(Vector<t_complex> &X_sca_, Vector<t_complex> &X_int_) const override {
+    X_sca_ = matrix->solve(Q);
+    X_sca_ = AbstractSolver::convertIndirect(X_sca_);
+    X_int_ = AbstractSolver::solveInternal(X_sca_);
+  }
+
+  using AbstractSolver::update;
+  void update() override {
+    Q = source_vector(*geometry, incWave);
+    matrix = std::make_shared<optimet::HierarchicalMatrix>(
+        geometry->objects, geometry->bground, incWave, parameters_.compression_tolerance,
+        parameters_.leaf_size);
+  }
+
+  //! \brief The compressed and factorized scattering matrix
+  //! \details Its solve method can also serve as a preconditioner for iterative solvers.
+  std::shared_ptr<optimet::HierarchicalMatrix const> compressed() const { return matrix; }
+  //! Parameters of the solver
+  Parameters const &parameters() const { return parameters_; }
+
+protected:
+  //! The local field matrix Q = T*AB*a
+  Vector<t_complex> Q;
+  //! Compression parameters
+  Parameters parameters_;
+  //! The compressed and factorized scattering matrix
+  std::shared_ptr<optimet::HierarchicalMatrix> matrix;
+};
+}
+}
+#endif
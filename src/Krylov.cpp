@@ -0,0 +1,653 @@
+// (C) University College London 2017
+// This file is part of Optimet, licensed under the terms of the GNU Public License
+//
+// Optimet is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Optimet is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Optimet. If not, see <http://www.gnu.org/licenses/>.
+
+#include "Krylov.h"
+#include <Eigen/Eigenvalues>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+namespace optimet {
+namespace krylov {
+namespace {
+//! Relative residual of the current solution, computed explicitly
+t_real true_residual(Operator const &A, Vector<t_complex> const &b, Vector<t_complex> const &x,
+                     t_real bnorm) {
+  Vector<t_complex> Ax(b.size());
+  A(x, Ax);
+  return (b - Ax).norm() / bnorm;
+}
+
+//! \brief Complex Givens rotation zeroing b in (a, b)
+//! \details The rotation is [c s; -conj(s) c], with c real.
+void givens(t_complex const &a, t_complex const &b, t_real &c, t_complex &s) {
+  auto const norm = std::sqrt(std::norm(a) + std::norm(b));
+  if(std::abs(a) == 0) {
+    c = 0;
+    s = 1;
+  } else {
+    c = std::abs(a) / norm;
+    s = a / std::abs(a) * std::conj(b) / norm;
+  }
+}
+
+//! Thin QR factorization of a tall matrix
+void thin_qr(Matrix<t_complex> const &A, Matrix<t_complex> &Q, Matrix<t_complex> &R) {
+  Eigen::HouseholderQR<Matrix<t_complex>> const qr(A);
+  Q = qr.householderQ() * Matrix<t_complex>::Identity(A.rows(), A.cols());
+  R = qr.matrixQR().topRows(A.cols()).triangularView<Eigen::Upper>();
+}
+
+//! Eigenvectors of the k eigenvalues of largest magnitude
+Matrix<t_complex> dominant_eigenvectors(Matrix<t_complex> const &M, t_uint k) {
+  Eigen::ComplexEigenSolver<Matrix<t_complex>> const eigen(M);
+  std::vector<t_uint> order(M.rows());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&eigen](t_uint a, t_uint b) {
+    return std::abs(eigen.eigenvalues()(a)) > std::abs(eigen.eigenvalues()(b));
+  });
+  Matrix<t_complex> result(M.rows(), k);
+  for(t_uint i(0); i < k; ++i)
+    result.col(i) = eigen.eigenvectors().col(order[i]);
+  return result;
+}
+
+//! Residual b - Ax, without applying the operator when x is zero
+Vector<t_complex> initial_residual(Operator const &A, Vector<t_complex> const &b,
+                                   Vector<t_complex> const &x) {
+  if(x.isZero(0))
+    return b;
+  Vector<t_complex> Ax(b.size());
+  A(x, Ax);
+  return b - Ax;
+}
+
+Convergence dispatch(std::string const &method, Operator const &A, Vector<t_complex> const &b,
+                     Vector<t_complex> &x, t_real tolerance, t_uint max_iterations,
+                     t_uint restart, t_uint recycle, Matrix<t_complex> *subspace) {
+  if(method == "GMRES" or method == "gmres")
+    return gmres(A, b, x, tolerance, max_iterations, restart);
+  if(method == "GCRODR" or method == "gcrodr") {
+    Matrix<t_complex> local;
+    return gcrodr(A, b, x, tolerance, max_iterations, restart, recycle,
+                  subspace ? *subspace : local);
+  }
+  if(method == "BiCGStab" or method == "bicgstab")
+    return bicgstab(A, b, x, tolerance, max_iterations);
+  if(method == "TFQMR" or method == "tfqmr")
+    return tfqmr(A, b, x, tolerance, max_iterations);
+  throw std::runtime_error("Unknown Krylov method " + method);
+}
+
+//! \brief Right preconditioning: solves A M y = b - A x, then x += M y
+//! \details The tolerance of the inner solve is rescaled so that it still refers to the
+//! unpreconditioned residual relative to b.
+Convergence right_preconditioned(
+    Operator const &A, Operator const &preconditioner, Vector<t_complex> const &b,
+    Vector<t_complex> &x, t_real tolerance,
+    std::function<Convergence(Operator const &, Vector<t_complex> const &, Vector<t_complex> &,
+                              t_real)> const &inner) {
+  if(x.size() != b.size())
+    x = Vector<t_complex>::Zero(b.size());
+  auto const bnorm = b.norm();
+  Vector<t_complex> const r = initial_residual(A, b, x);
+  auto const rnorm = r.norm();
+  if(bnorm == 0) {
+    x.fill(0);
+    return {0, 0, true, {}};
+  }
+  if(rnorm <= tolerance * bnorm)
+    return {0, rnorm / bnorm, true, {rnorm / bnorm}};
+  auto const AM = [&A, &preconditioner](Vector<t_complex> const &in, Vector<t_complex> &out) {
+    Vector<t_complex> Min(in.size());
+    preconditioner(in, Min);
+    A(Min, out);
+  };
+  Vector<t_complex> y = Vector<t_complex>::Zero(b.size());
+  auto result = inner(AM, r, y, tolerance * bnorm / rnorm);
+  Vector<t_complex> My(y.size());
+  preconditioner(y, My);
+  x += My;
+  result.residual *= rnorm / bnorm;
+  for(auto &residual : result.history)
+    residual *= rnorm / bnorm;
+  return result;
+}
+
+void rotate(t_real c, t_complex const &s, t_complex &a, t_complex &b) {
+  auto const t = c * a + s * b;
+  b = -std::conj(s) * a + c * b;
+  a = t;
+}
+}
+
+Convergence gmres(Operator const &A, Vector<t_complex> const &b, Vector<t_complex> &x,
+                  t_real tolerance, t_uint max_iterations, t_uint restart) {
+  return inexact_gmres({A}, {0}, b, x, tolerance, max_iterations, restart);
+}
+
+Convergence inexact_gmres(std::vector<Operator> const &levels, std::vector<t_real> const &errors,
+                          Vector<t_complex> const &b, Vector<t_complex> &x, t_real tolerance,
+                          t_uint max_iterations, t_uint restart,
+                          std::vector<t_uint> *applications) {
+  if(levels.empty() or levels.size() != errors.size())
+    throw std::runtime_error("Each operator level requires an error estimate");
+  auto const &A = levels.front();
+  if(applications)
+    applications->assign(levels.size(), 0);
+  auto const n = b.size();
+  if(x.size() != n)
+    x = Vector<t_complex>::Zero(n);
+  auto const bnorm = b.norm();
+  if(bnorm == 0) {
+    x.fill(0);
+    return {0, 0, true, {}};
+  }
+  restart = std::max<t_uint>(1, restart);
+
+  Matrix<t_complex> V(n, restart + 1);
+  Matrix<t_complex> H = Matrix<t_complex>::Zero(restart + 1, restart);
+  Vector<t_real> cs(restart);
+  Vector<t_complex> sn(restart), g(restart + 1), w(n);
+  Vector<t_complex> r = initial_residual(A, b, x);
+  if(applications)
+    ++applications->front();
+  t_uint iterations = 0;
+  t_real residual = r.norm() / bnorm;
+  std::vector<t_real> history{residual};
+  while(residual > tolerance and iterations < max_iterations) {
+    auto const beta = r.norm();
+    V.col(0) = r / beta;
+    g.fill(0);
+    g(0) = beta;
+    H.fill(0);
+
+    t_uint k = 0;
+    for(; k < restart and iterations < max_iterations; ++iterations) {
+      // relaxation: the error of the product may grow as the residual decreases
+      auto const allowed = tolerance * bnorm / std::abs(g(k));
+      t_uint level = levels.size() - 1;
+      while(level > 0 and errors[level] > allowed)
+        --level;
+      levels[level](V.col(k), w);
+      if(applications)
+        ++(*applications)[level];
+
+      // Arnoldi with modified Gram-Schmidt
+      for(t_uint i(0); i <= k; ++i) {
+        H(i, k) = V.col(i).dot(w);
+        w -= H(i, k) * V.col(i);
+      }
+      H(k + 1, k) = w.norm();
+      auto const breakdown = std::abs(H(k + 1, k)) == 0;
+      if(not breakdown)
+        V.col(k + 1) = w / H(k + 1, k);
+
+      for(t_uint i(0); i < k; ++i)
+        rotate(cs(i), sn(i), H(i, k), H(i + 1, k));
+      givens(H(k, k), H(k + 1, k), cs(k), sn(k));
+      rotate(cs(k), sn(k), H(k, k), H(k + 1, k));
+      rotate(cs(k), sn(k), g(k), g(k + 1));
+      ++k;
+      history.push_back(std::abs(g(k)) / bnorm);
+      if(breakdown or std::abs(g(k)) / bnorm <= tolerance) {
+        ++iterations;
+        break;
+      }
+    }
+
+    // the residual is always recomputed with the exact operator
+    Vector<t_complex> const y =
+        H.topLeftCorner(k, k).triangularView<Eigen::Upper>().solve(g.head(k));
+    x += V.leftCols(k) * y;
+    A(x, w);
+    if(applications)
+      ++applications->front();
+    r = b - w;
+    residual = r.norm() / bnorm;
+  }
+  return {iterations, residual, residual <= tolerance, history};
+}
+
+Convergence sstep_gmres(Operator const &A, Vector<t_complex> const &b, Vector<t_complex> &x,
+                        t_real tolerance, t_uint max_iterations, t_uint restart, t_uint steps,
+                        Operator const &preconditioner, Reduction const &reduce) {
+  auto const sum = [&reduce](Matrix<t_complex> &partial) {
+    if(reduce)
+      reduce(partial);
+  };
+  auto const norm = [&sum](Vector<t_complex> const &v) {
+    Matrix<t_complex> squared = Matrix<t_complex>::Constant(1, 1, v.squaredNorm());
+    sum(squared);
+    return std::sqrt(std::abs(squared(0, 0)));
+  };
+  auto const AM = [&A, &preconditioner](Vector<t_complex> const &in, Vector<t_complex> &out) {
+    if(not preconditioner)
+      return A(in, out);
+    Vector<t_complex> Min(in.size());
+    preconditioner(in, Min);
+    A(Min, out);
+  };
+
+  auto const n = b.size();
+  if(x.size() != n)
+    x = Vector<t_complex>::Zero(n);
+  auto const bnorm = norm(b);
+  if(bnorm == 0) {
+    x.fill(0);
+    return {0, 0, true, {}};
+  }
+  restart = std::max<t_uint>(1, restart);
+  steps = std::max<t_uint>(1, std::min(steps, restart));
+
+  Matrix<t_complex> Q(n, restart + 1);
+  // Hessenberg matrix, and its triangular factor from Givens rotations
+  Matrix<t_complex> H(restart + 1, restart), T(restart + 1, restart);
+  Vector<t_real> cs(restart);
+  Vector<t_complex> sn(restart), g(restart + 1), w(n);
+  A(x, w);
+  Vector<t_complex> r = b - w;
+  t_uint iterations = 0;
+  t_real residual = norm(r) / bnorm;
+  std::vector<t_real> history{residual};
+  while(residual > tolerance and iterations < max_iterations) {
+    auto const beta = residual * bnorm;
+    Q.col(0) = r / beta;
+    g.fill(0);
+    g(0) = beta;
+    H.fill(0);
+
+    t_uint k = 0, s = steps;
+    bool done = false;
+    while(not done and k < restart and iterations < max_iterations) {
+      auto const block = std::min({s, restart - k, max_iterations - iterations});
+      // scales the monomial basis with an estimate of the norm of the operator
+      auto rho = k > 0 ? H.topLeftCorner(k + 1, k).norm() / std::sqrt(k) : 1e0;
+      if(not(rho > 0))
+        rho = 1;
+      Matrix<t_complex> V(n, block);
+      AM(Q.col(k), w);
+      V.col(0) = w / rho;
+      for(t_uint i(1); i < block; ++i) {
+        AM(V.col(i - 1), w);
+        V.col(i) = w / rho;
+      }
+
+      // block classical Gram-Schmidt, twice, then Cholesky QR: two reductions per block
+      Matrix<t_complex> C = Q.leftCols(k + 1).adjoint() * V;
+      sum(C);
+      V -= Q.leftCols(k + 1) * C;
+      Matrix<t_complex> M(k + 1 + block, block);
+      M.topRows(k + 1) = Q.leftCols(k + 1).adjoint() * V;
+      M.bottomRows(block) = V.adjoint() * V;
+      sum(M);
+      V -= Q.leftCols(k + 1) * M.topRows(k + 1);
+      C += M.topRows(k + 1);
+      Matrix<t_complex> const gram =
+          M.bottomRows(block) - M.topRows(k + 1).adjoint() * M.topRows(k + 1);
+      Eigen::LLT<Matrix<t_complex>> const llt(gram);
+      Matrix<t_complex> R = Matrix<t_complex>::Zero(block, block);
+      auto breakdown = false;
+      if(llt.info() == Eigen::Success)
+        R = llt.matrixU();
+      if(block > 1 and
+         (llt.info() != Eigen::Success or
+          R.diagonal().real().minCoeff() <= 1e-8 * R.diagonal().real().maxCoeff())) {
+        // the monomial basis is numerically rank deficient, retry with shorter blocks
+        s = std::max<t_uint>(1, block / 2);
+        continue;
+      }
+      // with a single vector, a vanishing projection is a happy breakdown
+      auto const vanishing =
+          std::real(gram(0, 0)) <= 1e-28 * (C.squaredNorm() + std::abs(gram(0, 0)));
+      if(block == 1 and (llt.info() != Eigen::Success or vanishing)) {
+        breakdown = true;
+        R.fill(0);
+      } else
+        Q.middleCols(k + 1, block) = R.triangularView<Eigen::Upper>()
+                                         .solve<Eigen::OnTheRight>(V)
+                                         .eval();
+
+      // The basis [q_k, V] is [Q, Q_new] times B. Since A q_k = rho V_0 and
+      // A V_i = rho V_{i+1}, each new column of the Hessenberg matrix follows from the previous
+      // ones.
+      Matrix<t_complex> B = Matrix<t_complex>::Zero(k + 1 + block, block + 1);
+      B(k, 0) = 1;
+      B.block(0, 1, k + 1, block) = C;
+      B.block(k + 1, 1, block, block) = R;
+      for(t_uint i(0); i < block; ++i) {
+        auto const column = k + i;
+        Vector<t_complex> h = rho * B.col(i + 1);
+        if(column > 0)
+          h -= H.topLeftCorner(k + 1 + block, column) * B.col(i).head(column);
+        H.col(column).head(k + 1 + block) = h / B(column, i);
+        T.col(column) = H.col(column);
+      }
+
+      for(t_uint i(0); i < block and not done; ++i, ++iterations) {
+        auto const column = k + i;
+        for(t_uint j(0); j < column; ++j)
+          rotate(cs(j), sn(j), T(j, column), T(j + 1, column));
+        givens(T(column, column), T(column + 1, column), cs(column), sn(column));
+        rotate(cs(column), sn(column), T(column, column), T(column + 1, column));
+        rotate(cs(column), sn(column), g(column), g(column + 1));
+        history.push_back(std::abs(g(column + 1)) / bnorm);
+        if(std::abs(g(column + 1)) / bnorm <= tolerance or (breakdown and i + 1 == block)) {
+          done = true;
+          k = column + 1;
+        }
+      }
+      if(not done)
+        k += block;
+    }
+
+    Vector<t_complex> const y =
+        T.topLeftCorner(k, k).triangularView<Eigen::Upper>().solve(g.head(k));
+    Vector<t_complex> const dx = Q.leftCols(k) * y;
+    if(preconditioner) {
+      preconditioner(dx, w);
+      x += w;
+    } else
+      x += dx;
+    A(x, w);
+    r = b - w;
+    residual = norm(r) / bnorm;
+  }
+  return {iterations, residual, residual <= tolerance, history};
+}
+
+Convergence bicgstab(Operator const &A, Vector<t_complex> const &b, Vector<t_complex> &x,
+                     t_real tolerance, t_uint max_iterations) {
+  auto const n = b.size();
+  if(x.size() != n)
+    x = Vector<t_complex>::Zero(n);
+  auto const bnorm = b.norm();
+  if(bnorm == 0) {
+    x.fill(0);
+    return {0, 0, true, {}};
+  }
+
+  Vector<t_complex> v(n), t(n);
+  Vector<t_complex> r = initial_residual(A, b, x);
+  Vector<t_complex> const rstar = r;
+  Vector<t_complex> p = r;
+  A(p, v);
+  t_complex rho = rstar.dot(r);
+  t_uint iterations = 0;
+  t_real residual = r.norm() / bnorm;
+  std::vector<t_real> history{residual};
+  while(residual > tolerance and iterations < max_iterations) {
+    ++iterations;
+    auto const rstar_v = rstar.dot(v);
+    if(std::abs(rho) == 0 or std::abs(rstar_v) == 0)
+      break;
+    auto const alpha = rho / rstar_v;
+    r -= alpha * v;
+    if(r.norm() / bnorm <= tolerance) {
+      x += alpha * p;
+      residual = true_residual(A, b, x, bnorm);
+      history.push_back(residual);
+      break;
+    }
+    A(r, t);
+    auto const tt = t.squaredNorm();
+    if(tt == 0)
+      break;
+    auto const omega = t.dot(r) / tt;
+    x += alpha * p + omega * r;
+    r -= omega * t;
+    residual = r.norm() / bnorm;
+    if(residual <= tolerance)
+      residual = true_residual(A, b, x, bnorm);
+    history.push_back(residual);
+
+    auto const rho_next = rstar.dot(r);
+    auto const beta = (rho_next / rho) * (alpha / omega);
+    rho = rho_next;
+    p = r + beta * (p - omega * v);
+    A(p, v);
+  }
+  residual = true_residual(A, b, x, bnorm);
+  return {iterations, residual, residual <= tolerance, history};
+}
+
+Convergence tfqmr(Operator const &A, Vector<t_complex> const &b, Vector<t_complex> &x,
+                  t_real tolerance, t_uint max_iterations) {
+  auto const n = b.size();
+  if(x.size() != n)
+    x = Vector<t_complex>::Zero(n);
+  auto const bnorm = b.norm();
+  if(bnorm == 0) {
+    x.fill(0);
+    return {0, 0, true, {}};
+  }
+
+  // Follows Saad, Iterative Methods for Sparse Linear Systems, algorithm 7.8
+  Vector<t_complex> Au(n), v(n);
+  Vector<t_complex> w = initial_residual(A, b, x);
+  Vector<t_complex> const rstar = w;
+  Vector<t_complex> u = w, u_next(n), Au_previous(n);
+  Vector<t_complex> d = Vector<t_complex>::Zero(n);
+  A(u, v);
+  Au = v;
+  t_real tau = w.norm(), theta = 0;
+  t_complex eta = 0, alpha = 0;
+  t_complex rho = rstar.dot(w);
+  t_uint iterations = 0;
+  t_real residual = tau / bnorm;
+  std::vector<t_real> history{residual};
+  for(t_uint m(0); residual > tolerance and iterations < max_iterations; ++m) {
+    ++iterations;
+    if(m % 2 == 0) {
+      auto const rstar_v = rstar.dot(v);
+      if(std::abs(rstar_v) == 0)
+        break;
+      alpha = rho / rstar_v;
+      u_next = u - alpha * v;
+    }
+    w -= alpha * Au;
+    d = u + (theta * theta * eta / alpha) * d;
+    theta = w.norm() / tau;
+    auto const c = 1e0 / std::sqrt(1e0 + theta * theta);
+    tau *= theta * c;
+    eta = c * c * alpha;
+    x += eta * d;
+    history.push_back(tau / bnorm);
+    // tau * sqrt(m + 2) bounds the residual
+    if(tau * std::sqrt(static_cast<t_real>(m + 2)) / bnorm <= tolerance) {
+      residual = true_residual(A, b, x, bnorm);
+      if(residual <= tolerance)
+        break;
+    }
+
+    if(m % 2 == 0) {
+      u = u_next;
+      A(u, Au);
+    } else {
+      auto const rho_next = rstar.dot(w);
+      if(std::abs(rho) == 0)
+        break;
+      auto const beta = rho_next / rho;
+      rho = rho_next;
+      u = w + beta * u;
+      Au_previous = Au;
+      A(u, Au);
+      v = Au + beta * (Au_previous + beta * v);
+    }
+  }
+  residual = true_residual(A, b, x, bnorm);
+  return {iterations, residual, residual <= tolerance, history};
+}
+
+Convergence gcrodr(Operator const &A, Vector<t_complex> const &b, Vector<t_complex> &x,
+                   t_real tolerance, t_uint max_iterations, t_uint restart, t_uint recycle,
+                   Matrix<t_complex> &U) {
+  // Follows Parks et al., SIAM J. Sci. Comput. 28, 1651 (2006)
+  auto const n = b.size();
+  if(x.size() != n)
+    x = Vector<t_complex>::Zero(n);
+  auto const bnorm = b.norm();
+  if(bnorm == 0) {
+    x.fill(0);
+    return {0, 0, true, {}};
+  }
+  restart = std::max<t_uint>(2, restart);
+  auto const k = std::min<t_uint>(recycle, restart - 1);
+  if(U.rows() != n or k == 0)
+    U.resize(n, 0);
+  else if(static_cast<t_uint>(U.cols()) > k)
+    U = U.leftCols(k).eval();
+
+  Vector<t_complex> r = initial_residual(A, b, x), w(n);
+  Matrix<t_complex> C(n, 0), R;
+  if(U.cols() > 0) {
+    // C = A U, orthonormalized, and U such that A U = C
+    Matrix<t_complex> AU(n, U.cols());
+    for(t_uint i(0); i < static_cast<t_uint>(U.cols()); ++i) {
+      A(U.col(i), w);
+      AU.col(i) = w;
+    }
+    thin_qr(AU, C, R);
+    U = R.triangularView<Eigen::Upper>().solve<Eigen::OnTheRight>(U).eval();
+    Vector<t_complex> const c = C.adjoint() * r;
+    x += U * c;
+    r -= C * c;
+  }
+
+  t_uint iterations = 0;
+  t_real residual = r.norm() / bnorm;
+  std::vector<t_real> history{residual};
+  while(residual > tolerance and iterations < max_iterations) {
+    // Arnoldi on (I - C C^H) A, for the steps left after the recycled vectors
+    t_uint const kc = C.cols();
+    t_uint const m = restart - kc;
+    auto const beta = r.norm();
+    Matrix<t_complex> V(n, m + 1), H = Matrix<t_complex>::Zero(m + 1, m);
+    Matrix<t_complex> B = Matrix<t_complex>::Zero(kc, m);
+    V.col(0) = r / beta;
+    Vector<t_real> D(kc);
+    for(t_uint i(0); i < kc; ++i)
+      D(i) = 1e0 / U.col(i).norm();
+
+    // Least-squares problem over [U V_j] with the basis [C V_{j+1}] of its image
+    auto const system = [&](t_uint j) {
+      Matrix<t_complex> G = Matrix<t_complex>::Zero(kc + j + 1, kc + j);
+      G.topLeftCorner(kc, kc) = D.cast<t_complex>().asDiagonal();
+      G.block(0, kc, kc, j) = B.leftCols(j);
+      G.block(kc, kc, j + 1, j) = H.topLeftCorner(j + 1, j);
+      return G;
+    };
+    Vector<t_complex> rhs, y;
+    Matrix<t_complex> G;
+    t_uint j = 0;
+    while(j < m and iterations < max_iterations) {
+      A(V.col(j), w);
+      if(kc > 0) {
+        B.col(j) = C.adjoint() * w;
+        w -= C * B.col(j);
+      }
+      for(t_uint i(0); i <= j; ++i) {
+        H(i, j) = V.col(i).dot(w);
+        w -= H(i, j) * V.col(i);
+      }
+      H(j + 1, j) = w.norm();
+      auto const breakdown = std::abs(H(j + 1, j)) == 0;
+      if(not breakdown)
+        V.col(j + 1) = w / H(j + 1, j);
+      ++j;
+      ++iterations;
+
+      G = system(j);
+      rhs = Vector<t_complex>::Zero(kc + j + 1);
+      rhs(kc) = beta;
+      y = G.householderQr().solve(rhs);
+      history.push_back((rhs - G * y).norm() / bnorm);
+      if(breakdown or history.back() <= tolerance)
+        break;
+    }
+
+    Matrix<t_complex> Vhat(n, kc + j), What(n, kc + j + 1);
+    Vhat << U * D.cast<t_complex>().asDiagonal(), V.leftCols(j);
+    What << C, V.leftCols(j + 1);
+    x += Vhat * y;
+    r -= What * (G * y);
+    residual = r.norm() / bnorm;
+
+    // Harmonic Ritz vectors of smallest magnitude span the new recycled space
+    if(k > 0 and kc + j >= k) {
+      Matrix<t_complex> const GG = G.adjoint() * G;
+      Matrix<t_complex> const M = GG.ldlt().solve(G.adjoint() * (What.adjoint() * Vhat));
+      Matrix<t_complex> const P = dominant_eigenvectors(M, k);
+      Matrix<t_complex> Q;
+      thin_qr(G * P, Q, R);
+      C = What * Q;
+      U = R.triangularView<Eigen::Upper>().solve<Eigen::OnTheRight>(Vhat * P).eval();
+    }
+  }
+  residual = true_residual(A, b, x, bnorm);
+  return {iterations, residual, residual <= tolerance, history};
+}
+
+t_real relative_change(Operator const &A, Operator const &B, t_uint n) {
+  Vector<t_complex> const probe = Vector<t_complex>::Random(n);
+  Vector<t_complex> Ap(n), Bp(n);
+  A(probe, Ap);
+  B(probe, Bp);
+  auto const norm = Ap.norm();
+  return norm == 0 ? (Bp.norm() == 0 ? 0 : 1) : (Bp - Ap).norm() / norm;
+}
+
+Convergence solve(std::string const &method, Operator const &A, Vector<t_complex> const &b,
+                  Vector<t_complex> &x, t_real tolerance, t_uint max_iterations, t_uint restart,
+                  Operator const &preconditioner, t_uint recycle, Matrix<t_complex> *subspace) {
+  if(not preconditioner)
+    return dispatch(method, A, b, x, tolerance, max_iterations, restart, recycle, subspace);
+  return right_preconditioned(
+      A, preconditioner, b, x, tolerance,
+      [&](Operator const &AM, Vector<t_complex> const &r, Vector<t_complex> &y, t_real tol) {
+        return dispatch(method, AM, r, y, tol, max_iterations, restart, recycle, subspace);
+      });
+}
+
+Convergence solve_inexact(std::vector<Operator> const &levels, std::vector<t_real> const &errors,
+                          Vector<t_complex> const &b, Vector<t_complex> &x, t_real tolerance,
+                          t_uint max_iterations, t_uint restart, Operator const &preconditioner,
+                          std::vector<t_uint> *applications) {
+  if(not preconditioner)
+    return inexact_gmres(levels, errors, b, x, tolerance, max_iterations, restart, applications);
+  if(levels.empty())
+    throw std::runtime_error("Each operator level requires an error estimate");
+  if(applications)
+    applications->assign(levels.size(), 0);
+  return right_preconditioned(
+      levels.front(), preconditioner, b, x, tolerance,
+      [&](Operator const &, Vector<t_complex> const &r, Vector<t_complex> &y, t_real tol) {
+        std::vector<Operator> preconditioned;
+        for(auto const &level : levels)
+          preconditioned.push_back(
+              [&level, &preconditioner](Vector<t_complex> const &in, Vector<t_complex> &out) {
+                Vector<t_complex> Min(in.size());
+                preconditioner(in, Min);
+                level(Min, out);
+              });
+        return inexact_gmres(preconditioned, errors, r, y, tol, max_iterations, restart,
+                             applications);
+      });
+}
+} // namespace krylov
+} // namespace optimet
@@ -0,0 +1,126 @@
+// (C) University College London 2017
+// This file is part of Optimet, licensed under the terms of the GNU Public License
+//
+// Optimet is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Optimet is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Optimet. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef OPTIMET_KRYLOV_H
+#define OPTIMET_KRYLOV_H
+
+#include "Types.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace optimet {
+//! Matrix-free iterative solvers, independent of Belos
+namespace krylov {
+//! Applies the linear operator: out = A * in
+typedef std::function<void(Vector<t_complex> const &in, Vector<t_complex> &out)> Operator;
+//! \brief Sums a small matrix over all processes holding a part of the vectors, in place
+//! \details Empty when the vectors are not distributed.
+typedef std::function<void(Matrix<t_complex> &)> Reduction;
+
+//! Outcome of an iterative solve
+struct Convergence {
+  //! Number of iterations performed
+  t_uint iterations;
+  //! Final residual norm, relative to the norm of the right-hand side
+  t_real residual;
+  //! Whether the residual reached the requested tolerance
+  bool converged;
+  //! \brief Relative residual before the first iteration and after each one
+  //! \details As estimated by each method, e.g. from the least-squares problem of GMRES or from
+  //! the quasi-residual of TFQMR. Empty if the right-hand side vanishes.
+  std::vector<t_real> history;
+};
+
+//! \brief Restarted GMRES(m)
+//! \param[in] A: linear operator
+//! \param[in] b: right-hand side
+//! \param[inout] x: initial guess on input, solution on output
+//! \param[in] tolerance: relative residual ||b - Ax|| / ||b|| at which to stop
+//! \param[in] max_iterations: maximum number of operator applications
+//! \param[in] restart: dimension of the Krylov space before restarting
+Convergence gmres(Operator const &A, Vector<t_complex> const &b, Vector<t_complex> &x,
+                  t_real tolerance, t_uint max_iterations, t_uint restart);
+//! \brief Inexact GMRES(m), relaxing the accuracy of the operator as the residual decreases
+//! \details levels[0] is the exact operator. It computes the residual at each restart, so that the
+//! final residual meets the tolerance. The other levels are cheaper approximations with relative
+//! errors errors[i], in decreasing order of accuracy. Each iteration applies the cheapest level
+//! whose error is below tolerance ||b|| / ||r||, following Bouras and Fraysse, SIAM J. Matrix
+//! Anal. Appl. 26, 660 (2005).
+//! \param[out] applications: if given, number of applications of each level
+Convergence inexact_gmres(std::vector<Operator> const &levels, std::vector<t_real> const &errors,
+                          Vector<t_complex> const &b, Vector<t_complex> &x, t_real tolerance,
+                          t_uint max_iterations, t_uint restart,
+                          std::vector<t_uint> *applications = nullptr);
+//! \brief Communication-avoiding s-step GMRES(m), with the preconditioner M applied on the right
+//! \details Each block applies the operator s times to build a monomial Krylov basis, then
+//! orthogonalizes the whole block with classical Gram-Schmidt, repeated twice, and a Cholesky QR.
+//! Distributed vectors then synchronize twice per block of s iterations, rather than at every
+//! step of the Gram-Schmidt process. The Hessenberg matrix follows from the change of basis,
+//! as in M. Hoemmen, PhD thesis, UC Berkeley (2010). Blocks are shortened when the basis becomes
+//! numerically rank deficient.
+//! \param[in] steps: number of iterations s between synchronizations
+//! \param[in] reduce: sums the local inner products over all processes, if vectors are distributed
+Convergence sstep_gmres(Operator const &A, Vector<t_complex> const &b, Vector<t_complex> &x,
+                        t_real tolerance, t_uint max_iterations, t_uint restart, t_uint steps,
+                        Operator const &preconditioner = Operator(),
+                        Reduction const &reduce = Reduction());
+//! \brief Stabilized bi-conjugate gradients
+//! \details Each iteration applies the operator twice.
+Convergence bicgstab(Operator const &A, Vector<t_complex> const &b, Vector<t_complex> &x,
+                     t_real tolerance, t_uint max_iterations);
+//! \brief Transpose-free quasi-minimal residual method
+//! \details Each iteration applies the operator once, on average.
+Convergence tfqmr(Operator const &A, Vector<t_complex> const &b, Vector<t_complex> &x,
+                  t_real tolerance, t_uint max_iterations);
+//! \brief GMRES with deflated restarting and subspace recycling, GCRO-DR(m, k)
+//! \details At each restart, the k harmonic Ritz vectors of smallest magnitude are kept and
+//! deflated from the next cycle. The same space seeds subsequent solves with a nearby operator,
+//! e.g. across the steps of a wavelength scan.
+//! \param[in] restart: total dimension of the search space, recycled vectors included
+//! \param[in] recycle: number of recycled vectors k
+//! \param[inout] U: recycled space from a previous solve, if any, on input. Recycled space for
+//! the next solve on output. Ignored on input if it does not match the size of the system.
+Convergence gcrodr(Operator const &A, Vector<t_complex> const &b, Vector<t_complex> &x,
+                   t_real tolerance, t_uint max_iterations, t_uint restart, t_uint recycle,
+                   Matrix<t_complex> &U);
+
+//! \brief Estimates how much an operator changed: ||(B - A) p|| / ||A p||
+//! \details p is a random probe vector of size n. Cheap compared to a solve, and sufficient to
+//! decide whether a recycled space is still worth keeping.
+t_real relative_change(Operator const &A, Operator const &B, t_uint n);
+
+//! \brief Calls the method with the given name
+//! \details Names follow Belos: "GMRES", "GCRODR", "BiCGStab", "TFQMR". Restart is ignored by
+//! the latter two. If given, the preconditioner M is applied on the right, solving A M y = b - A x
+//! for the correction to x. The tolerance still refers to the unpreconditioned residual. The
+//! recycled space, if given, is carried over from one call to the next by "GCRODR".
+Convergence solve(std::string const &method, Operator const &A, Vector<t_complex> const &b,
+                  Vector<t_complex> &x, t_real tolerance, t_uint max_iterations, t_uint restart,
+                  Operator const &preconditioner = Operator(), t_uint recycle = 0,
+                  Matrix<t_complex> *subspace = nullptr);
+
+//! \brief Inexact GMRES, with the preconditioner M applied on the right
+//! \details Each level is composed with the preconditioner. The counts of applications do not
+//! include the initial and final residuals of the preconditioned system.
+Convergence solve_inexact(std::vector<Operator> const &levels, std::vector<t_real> const &errors,
+                          Vector<t_complex> const &b, Vector<t_complex> &x, t_real tolerance,
+                          t_uint max_iterations, t_uint restart,
+                          Operator const &preconditioner = Operator(),
+                          std::vector<t_uint> *applications = nullptr);
+} // namespace krylov
+} // namespace optimet
+#endif
@@ -24,6 +24,7 @@ namespace solver {
 void MatrixBelos::solve(Vector<t_complex> &X_sca_, Vector<t_complex> &X_int_) const {
   if(belos_parameters()->get<std::string>("Solver", "GMRES") == "scalapack")
     return Scalapack::solve(X_sca_, X_int_);
+  telemetry_.clear();
   auto const splitcomm = communicator().split(context().is_valid());
   if(context().is_valid()) {
     auto const solver = belos_parameters()->get<std::string>("Solver");
@@ -33,8 +34,23 @@ void MatrixBelos::solve(Vector<t_complex> &X_sca_, Vector<t_complex> &X_int_) co
     }
     auto input = parallel_input();
     // Now the actual work
-    auto const gls_result = scalapack::gmres_linear_system(std::get<0>(input), std::get<1>(input),
-                                                           belos_parameters(), splitcomm);
+    Telemetry record(solver);
+    auto const start = TelemetryClock::now();
+    auto const gls_result = scalapack::gmres_linear_system(
+        std::get<0>(input), std::get<1>(input), belos_parameters(), splitcomm, &record.residuals);
+    // the matrix-vector products happen inside Belos, so that only the total is timed
+    record.total = seconds_since(start);
+    record.iterations = record.residuals.size() > 0 ? record.residuals.size() - 1 : 0;
+    record.converged = std::get<1>(gls_result) == 0;
+    if(parameters().telemetry) {
+      scalapack::Matrix<t_complex> residual(std::get<1>(input).local(), context(),
+                                            std::get<1>(input).sizes(),
+                                            std::get<1>(input).blocks());
+      scalapack::pdgemm(t_complex(-1), std::get<0>(input), std::get<0>(gls_result), t_complex(1),
+                        residual);
+      record.true_residual = scalapack::norm(residual) / scalapack::norm(std::get<1>(input));
+    }
+    telemetry_.push_back(record);
     if(std::get<1>(gls_result) != 0)
       throw std::runtime_error("Error encountered while solving the linear system");
     // Transfer back to root
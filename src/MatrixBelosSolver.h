@@ -39,13 +39,12 @@ public:
       mpi::Communicator const &communicator = mpi::Communicator(),
       scalapack::Context const &context = scalapack::Context::Squarest(),
       scalapack::Sizes const &block_size = scalapack::Sizes{64, 64},
-      Teuchos::RCP<Teuchos::ParameterList> belos_params = Teuchos::rcp(new Teuchos::ParameterList))
-      : Scalapack(geometry, incWave, communicator, context, block_size),
+      Teuchos::RCP<Teuchos::ParameterList> belos_params = Teuchos::rcp(new Teuchos::ParameterList),
+      Parameters const &parameters = Parameters())
+      : Scalapack(geometry, incWave, communicator, context, block_size, parameters),
         belos_params_(belos_params) {}
   MatrixBelos(Run const &run)
-      : MatrixBelos(run.geometry, run.excitation, run.communicator, run.context,
-                    {run.parallel_params.block_size, run.parallel_params.block_size},
-                    run.belos_params) {}
+      : MatrixBelos(run, tuned_parameters(run, scalapack::Workload::multiplication)) {}
 
   void solve(Vector<t_complex> &X_sca_, Vector<t_complex> &X_int_) const override;
 
@@ -55,6 +54,12 @@ public:
   Teuchos::RCP<Teuchos::ParameterList> belos_parameters() const { return belos_params_; }
 
 protected:
+  MatrixBelos(Run const &run, scalapack::Parameters const &parallel)
+      : MatrixBelos(run.geometry, run.excitation, run.communicator,
+                    parallel.autotune ? scalapack::Context(parallel.grid) : run.context,
+                    {parallel.block_size, parallel.block_size}, run.belos_params,
+                    run.solver_params) {}
+
   //! Parameter list of the belos solvers
   Teuchos::RCP<Teuchos::ParameterList> belos_params_;
 };
@@ -0,0 +1,153 @@
+// (C) University College London 2017
+// This file is part of Optimet, licensed under the terms of the GNU Public License
+//
+// Optimet is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Optimet is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Optimet. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "OrderOfScatteringSolver.h"
+#include "FastMatrixMultiply.h"
+#include "PreconditionedMatrix.h"
+#include <iostream>
+
+namespace optimet {
+namespace solver {
+
+void OrderOfScattering::update() {
+  if(not(geometry and incWave)) {
+    scattering_ = krylov::Operator();
+    Q = Vector<t_complex>::Zero(0);
+    return;
+  }
+  if(parameters_.series_operator == "dense") {
+    auto const S = std::make_shared<Matrix<t_complex> const>(
+        preconditioned_scattering_matrix(*geometry, incWave));
+    scattering_ = [S](Vector<t_complex> const &in, Vector<t_complex> &out) { out = *S * in; };
+  } else if(parameters_.series_operator == "fmm") {
+    auto const fmm = std::make_shared<FastMatrixMultiply const>(
+        geometry->bground, incWave->wavenumber(), geometry->objects);
+    scattering_ = [fmm](Vector<t_complex> const &in, Vector<t_complex> &out) { (*fmm)(in, out); };
+  } else
+    throw std::runtime_error("Unknown operator for the Foldy-Lax series " +
+                             parameters_.series_operator);
+  Q = source_vector(*geometry, incWave);
+}
+
+void OrderOfScattering::iterate(Vector<t_complex> const &b, Vector<t_complex> &x) const {
+  Telemetry record("order-of-scattering");
+  auto const start = TelemetryClock::now();
+  auto const S = timed(scattering_, record.apply);
+  auto const bnorm = b.norm();
+  orders_ = 0;
+  fallback_ = false;
+  diverged_ = false;
+  convergence_ = {0, 0, true, {}};
+  if(bnorm == 0) {
+    x = Vector<t_complex>::Zero(b.size());
+    record.finish(convergence_, seconds_since(start));
+    telemetry_.push_back(record);
+    return;
+  }
+
+  // the increment of each order is the residual r_k = Q - S x_k
+  Vector<t_complex> Sx(b.size());
+  S(x, Sx);
+  Vector<t_complex> r = b - Sx;
+  auto residual = r.norm() / bnorm;
+  auto best = residual;
+  Vector<t_complex> best_x = x;
+  std::vector<t_real> history{residual};
+  t_uint growth = 0;
+  while(residual > parameters_.tolerance and orders_ < parameters_.scattering_orders and
+        growth < 2) {
+    x += r;
+    ++orders_;
+    S(x, Sx);
+    r = b - Sx;
+    auto const previous = residual;
+    residual = r.norm() / bnorm;
+    history.push_back(residual);
+    growth = residual > previous ? growth + 1 : 0;
+    if(residual < best) {
+      best = residual;
+      best_x = x;
+    }
+  }
+  convergence_.residual = residual;
+  diverged_ = growth >= 2;
+
+  if(residual > parameters_.tolerance) {
+    fallback_ = true;
+    x = best_x;
+    convergence_ = krylov::solve(parameters_.krylov, S, b, x, parameters_.tolerance,
+                                 parameters_.max_iterations, parameters_.restart);
+    record.method += " then " + parameters_.krylov;
+    // the Krylov method starts from the best order
+    history.insert(history.end(), convergence_.history.begin() + 1, convergence_.history.end());
+  }
+  convergence_.history = history;
+  record.finish(convergence_, seconds_since(start));
+  record.iterations = orders_ + convergence_.iterations;
+  telemetry_.push_back(record);
+  if(parameters_.verbosity != 0 and communicator().rank() == communicator().root_id()) {
+    std::cout << "Foldy-Lax series "
+              << (diverged_ ? "diverged" : fallback_ ? "reached the order limit" : "converged")
+              << " after " << orders_ << " orders";
+    if(fallback_)
+      std::cout << ", " << parameters_.krylov << " "
+                << (convergence_.converged ? "converged" : "failed") << " after "
+                << convergence_.iterations << " iterations";
+    std::cout << ", relative residual " << convergence_.residual << "\n";
+  }
+  if(not convergence_.converged)
+    throw std::runtime_error("Order-of-scattering solver did not converge");
+}
+
+void OrderOfScattering::solve(Vector<t_complex> &X_sca_, Vector<t_complex> &X_int_) const {
+  if(initial_guess_.size() == Q.size())
+    X_sca_ = initial_guess_;
+  else
+    X_sca_ = Vector<t_complex>::Zero(Q.size());
+  telemetry_.clear();
+  iterate(Q, X_sca_);
+
+  solution_ = X_sca_;
+  X_sca_ = AbstractSolver::convertIndirect(X_sca_);
+  X_int_ = AbstractSolver::solveInternal(X_sca_);
+}
+
+void OrderOfScattering::solve_waves(Matrix<t_complex> &X_sca_, Matrix<t_complex> &X_int_) const {
+  auto const sources = source_vectors(*geometry, incWave);
+  X_sca_.resize(sources.rows(), sources.cols());
+  X_int_.resize(sources.rows(), sources.cols());
+  t_uint orders = 0, iterations = 0;
+  bool fallback = false, diverged = false;
+  telemetry_.clear();
+  for(t_uint i(0); i < static_cast<t_uint>(sources.cols()); ++i) {
+    Vector<t_complex> x = Vector<t_complex>::Zero(sources.rows());
+    iterate(sources.col(i), x);
+    orders += orders_;
+    iterations += convergence_.iterations;
+    fallback = fallback or fallback_;
+    diverged = diverged or diverged_;
+    Vector<t_complex> const scattered = AbstractSolver::convertIndirect(x);
+    X_sca_.col(i) = scattered;
+    X_int_.col(i) = AbstractSolver::solveInternal(scattered);
+  }
+  orders_ = orders;
+  fallback_ = fallback;
+  diverged_ = diverged;
+  convergence_.iterations = iterations;
+}
+}
+}
@@ -0,0 +1,92 @@
+// (C) University College London 2017
+// This file is part of Optimet, licensed under the terms of the GNU Public License
+//
+// Optimet is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Optimet is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Optimet. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef OPTIMET_ORDER_OF_SCATTERING_SOLVER_H
+#define OPTIMET_ORDER_OF_SCATTERING_SOLVER_H
+
+#include "Krylov.h"
+#include "Run.h"
+#include "Solver.h"
+#include "Types.h"
+#include <memory>
+
+namespace optimet {
+namespace solver {
+
+//! \brief Order-of-scattering solver, summing the Foldy-Lax multiple-scattering series
+//! \details Iterates x_{k+1} = Q + (I - S) x_k, where each order adds one more scattering event
+//! between the particles. The increment is the residual Q - S x_k, so the series stops once its
+//! norm relative to Q falls below the tolerance parameter. Dilute ensembles converge in a few
+//! orders. For dense ensembles the series may diverge: if the residual grows for two successive
+//! orders, or after scattering_orders orders, the solver falls back to the Krylov method given
+//! by the krylov parameter, starting from the best order. S is applied with the Fast Matrix
+//! Multiply, or with the dense matrix if series_operator is "dense".
+class OrderOfScattering : public AbstractSolver {
+public:
+  OrderOfScattering(std::shared_ptr<Geometry> geometry, std::shared_ptr<Excitation const> incWave,
+                    mpi::Communicator const &communicator = mpi::Communicator(),
+                    Parameters const &parameters = Parameters())
+      : AbstractSolver(geometry, incWave, communicator), parameters_(parameters), orders_(0),
+        fallback_(false), diverged_(false), convergence_{0, 0, false, {}} {
+    update();
+  }
+  OrderOfScattering(Run const &run)
+      : OrderOfScattering(run.geometry, run.excitation, run.communicator, run.solver_params) {}
+
+  void solve(Vector<t_complex> &X_sca_, Vector<t_complex> &X_int_) const override;
+  //! Sums the series for each incident wave in turn
+  void solve_waves(Matrix<t_complex> &X_sca_, Matrix<t_complex> &X_int_) const override;
+
+  using AbstractSolver::update;
+  void update() override;
+
+  //! Parameters of the solver
+  Parameters const &parameters() const { return parameters_; }
+  //! Number of orders of the series summed during the last solve
+  t_uint orders() const { return orders_; }
+  //! Whether the last solve fell back to the Krylov method
+  bool fallback() const { return fallback_; }
+  //! \brief Whether the series of the last solve diverged
+  //! \details Otherwise, a fallback means the series reached scattering_orders orders.
+  bool diverged() const { return diverged_; }
+  //! Relative residual of the last solve, and Krylov iterations if it fell back
+  krylov::Convergence const &convergence() const { return convergence_; }
+  //! Orders of the series and Krylov iterations of the last solve
+  t_uint iterations() const override { return orders_ + convergence_.iterations; }
+
+protected:
+  //! Solves S x = b, starting from x
+  void iterate(Vector<t_complex> const &b, Vector<t_complex> &x) const;
+
+  //! Applies the scattering matrix S
+  krylov::Operator scattering_;
+  //! The local field matrix Q = T*AB*a
+  Vector<t_complex> Q;
+  //! Convergence criteria and fallback method
+  Parameters parameters_;
+  //! Orders summed during the last solve
+  mutable t_uint orders_;
+  //! Whether the last solve fell back to the Krylov method
+  mutable bool fallback_;
+  //! Whether the residual of the last solve grew for two successive orders
+  mutable bool diverged_;
+  //! Convergence of the last solve
+  mutable krylov::Convergence convergence_;
+};
+}
+}
+#endif
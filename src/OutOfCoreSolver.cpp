@@ -0,0 +1,144 @@
+// (C) University College London 2017
+// This file is part of Optimet, licensed under the terms of the GNU Public License
+//
+// Optimet is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Optimet is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Optimet. If not, see <http://www.gnu.org/licenses/>.
+
+#include "OutOfCoreSolver.h"
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+
+namespace optimet {
+namespace solver {
+namespace {
+//! Wall-clock time in seconds
+t_real now() {
+  return std::chrono::duration<t_real>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+}
+
+void OutOfCore::update() {
+  auto const start = now();
+  Q = source_vector(*geometry, incWave);
+
+  // Tiles contain a whole number of scatterers, so that panels can be assembled independently
+  auto const &objects = geometry->objects;
+  auto const offsets = scatterer_offsets(objects.begin(), objects.end());
+  panels.assign(1, 0);
+  std::vector<t_uint> boundaries(1, 0);
+  for(t_uint i(1); i <= objects.size(); ++i)
+    if(i == objects.size() or offsets[i + 1] - boundaries.back() > parameters_.tile_size) {
+      panels.push_back(i);
+      boundaries.push_back(offsets[i]);
+    }
+  store.reset();
+  store.reset(new TileStore(boundaries, parameters_.cache_tiles, parameters_.scratch));
+  pivots.resize(store->rows());
+
+  for(t_uint J(0); J < store->tiles(); ++J) {
+    Matrix<t_complex> panel = preconditioned_scattering_matrix(
+        objects.begin(), objects.end(), objects.begin() + panels[J],
+        objects.begin() + panels[J + 1], geometry->bground, incWave);
+
+    // Left-looking: apply the factors of all previous panels, reading the next one in advance
+    if(J > 0)
+      store->prefetch(0);
+    for(t_uint K(0); K < J; ++K) {
+      if(K + 1 < J)
+        store->prefetch(K + 1);
+      Matrix<t_complex> const factors = store->panel(K);
+      auto const k0 = store->start(K);
+      auto const kw = store->width(K);
+      exchange_rows(panel, K);
+      auto top = panel.middleRows(k0, kw);
+      factors.middleRows(k0, kw).triangularView<Eigen::UnitLower>().solveInPlace(top);
+      auto const below = store->rows() - k0 - kw;
+      panel.bottomRows(below).noalias() -= factors.bottomRows(below) * top;
+    }
+    factorize_panel(panel, J);
+    store->panel(J, panel);
+  }
+
+  compute_time_ = now() - start - store->io_time();
+  if(parameters_.verbosity != 0 and communicator().rank() == communicator().root_id())
+    std::cout << "Out-of-core LU of " << store->rows() << " rows in " << store->tiles()
+              << " panels: " << compute_time_ << "s compute, " << store->io_time() << "s I/O, "
+              << io_bytes() << " bytes moved\n";
+}
+
+void OutOfCore::factorize_panel(Matrix<t_complex> &panel, t_uint J) {
+  auto const c0 = store->start(J);
+  auto const width = store->width(J);
+  auto const N = store->rows();
+  for(t_uint j(0); j < width; ++j) {
+    auto const diagonal = c0 + j;
+    t_uint pivot;
+    panel.col(j).tail(N - diagonal).cwiseAbs().maxCoeff(&pivot);
+    pivot += diagonal;
+    pivots[diagonal] = pivot;
+    if(panel(pivot, j) == t_complex(0))
+      throw std::runtime_error("Scattering matrix is singular");
+    if(pivot != diagonal)
+      panel.row(pivot).swap(panel.row(diagonal));
+    auto const below = N - diagonal - 1;
+    panel.col(j).tail(below) /= panel(diagonal, j);
+    auto const right = width - j - 1;
+    panel.bottomRightCorner(below, right).noalias() -=
+        panel.col(j).tail(below) * panel.row(diagonal).tail(right);
+  }
+}
+
+void OutOfCore::exchange_rows(Eigen::Ref<Matrix<t_complex>> rows, t_uint K) const {
+  for(t_uint i(store->start(K)); i < store->start(K) + store->width(K); ++i)
+    if(pivots[i] != i)
+      rows.row(i).swap(rows.row(pivots[i]));
+}
+
+Vector<t_complex> OutOfCore::solve_preconditioned(Vector<t_complex> const &Q_) const {
+  if(not store)
+    throw std::runtime_error("Out-of-core solver has not been factorized");
+  Matrix<t_complex> x = Q_;
+  auto const N = store->rows();
+  auto const panels = store->tiles();
+
+  // Forward substitution, interleaving row exchanges as they were done during the factorization
+  store->prefetch(0);
+  for(t_uint K(0); K < panels; ++K) {
+    if(K + 1 < panels)
+      store->prefetch(K + 1);
+    Matrix<t_complex> const factors = store->panel(K);
+    auto const k0 = store->start(K);
+    auto const kw = store->width(K);
+    exchange_rows(x, K);
+    auto top = x.middleRows(k0, kw);
+    factors.middleRows(k0, kw).triangularView<Eigen::UnitLower>().solveInPlace(top);
+    x.bottomRows(N - k0 - kw).noalias() -= factors.bottomRows(N - k0 - kw) * top;
+  }
+
+  // Backward substitution, from the last panel
+  for(t_uint K(panels); K > 0; --K) {
+    if(K > 1)
+      store->prefetch(K - 2);
+    Matrix<t_complex> const factors = store->panel(K - 1);
+    auto const k0 = store->start(K - 1);
+    auto const kw = store->width(K - 1);
+    auto diagonal = x.middleRows(k0, kw);
+    factors.middleRows(k0, kw).triangularView<Eigen::Upper>().solveInPlace(diagonal);
+    x.topRows(k0).noalias() -= factors.topRows(k0) * diagonal;
+  }
+  return x.col(0);
+}
+}
+}
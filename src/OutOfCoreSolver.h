@@ -0,0 +1,90 @@
+// (C) University College London 2017
+// This file is part of Optimet, licensed under the terms of the GNU Public License
+//
+// Optimet is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Optimet is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Optimet. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef OPTIMET_OUT_OF_CORE_SOLVER_H
+#define OPTIMET_OUT_OF_CORE_SOLVER_H
+
+#include "PreconditionedMatrix.h"
+#include "Solver.h"
+#include "TileStore.h"
+#include "Types.h"
+#include <memory>
+#include <vector>
+
+namespace optimet {
+namespace solver {
+
+//! \brief Solves the preconditioned scattering problem with the matrix stored on disk
+//! \details The scattering matrix is assembled one column of tiles (a panel) at a time, and
+//! factorized with a left-looking LU with partial pivoting. Only a panel being factorized, the
+//! panel it is updated with, and a bounded cache of tiles are held in memory. Tiles contain as
+//! many whole scatterers as fit within the requested tile size, and at least one.
+class OutOfCore : public AbstractSolver {
+public:
+  OutOfCore(std::shared_ptr<Geometry> geometry, std::shared_ptr<Excitation const> incWave,
+            mpi::Communicator const &communicator = mpi::Communicator(),
+            Parameters const &parameters = Parameters())
+      : AbstractSolver(geometry, incWave, communicator), parameters_(parameters),
+        compute_time_(0) {
+    update();
+  }
+  OutOfCore(Run const &run)
+      : OutOfCore(run.geometry, run.excitation, run.communicator, run.solver_params) {}
+
+  void solve(Vector<t_complex> &X_sca_, Vector<t_complex> &X_int_) const override {
+    X_sca_ = solve_preconditioned(Q);
+    X_sca_ = AbstractSolver::convertIndirect(X_sca_);
+    X_int_ = AbstractSolver::solveInternal(X_sca_);
+  }
+
+  using AbstractSolver::update;
+  void update() override;
+
+  //! Parameters of the solver
+  Parameters const &parameters() const { return parameters_; }
+  //! Number of panels, each containing whole scatterers
+  t_uint tiles() const { return store ? store->tiles() : 0; }
+  //! Seconds spent reading, writing, or waiting for tiles
+  t_real io_time() const { return store ? store->io_time() : 0; }
+  //! Seconds spent assembling and factorizing, excluding I/O
+  t_real compute_time() const { return compute_time_; }
+  //! Number of bytes moved to and from disk
+  t_uint io_bytes() const { return store ? store->bytes_read() + store->bytes_written() : 0; }
+
+protected:
+  //! The local field matrix Q = T*AB*a
+  Vector<t_complex> Q;
+  //! Tile size, cache size, and scratch directory
+  Parameters parameters_;
+  //! LU factors of the scattering matrix, on disk
+  std::unique_ptr<TileStore> store;
+  //! First scatterer of each panel, followed by the number of scatterers
+  std::vector<t_uint> panels;
+  //! Row i was exchanged with row pivots[i] during the factorization
+  std::vector<t_uint> pivots;
+  //! Time spent in computations during the last update
+  t_real compute_time_;
+
+  //! Solves S x = Q_ using the factors on disk
+  Vector<t_complex> solve_preconditioned(Vector<t_complex> const &Q_) const;
+  //! Factorizes a panel in place, from the diagonal down, with partial pivoting
+  void factorize_panel(Matrix<t_complex> &panel, t_uint J);
+  //! Applies the row exchanges of panel K to the given rows
+  void exchange_rows(Eigen::Ref<Matrix<t_complex>> rows, t_uint K) const;
+};
+}
+}
+#endif
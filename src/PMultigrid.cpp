@@ -0,0 +1,84 @@
+// (C) University College London 2017
+// This file is part of Optimet, licensed under the terms of the GNU Public License
+//
+// Optimet is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Optimet is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Optimet. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "PMultigrid.h"
+#include "PreconditionedMatrix.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace optimet {
+PMultigrid::PMultigrid(std::vector<Scatterer>::const_iterator const &first,
+                       std::vector<Scatterer>::const_iterator const &last,
+                       ElectroMagnetic const &bground, std::shared_ptr<Excitation const> incWave,
+                       t_uint coarse_nmax, krylov::Operator const &fine, t_uint smoothing)
+    : rows_(scatterer_offsets(first, last).back()), fine_(fine), smoothing_(smoothing) {
+  if(coarse_nmax == 0)
+    throw std::runtime_error("The coarse level of p-multigrid requires nMax > 0");
+  // Harmonics are ordered by n within the TE and TM halves of each scatterer, so the coarse
+  // harmonics are the leading coefficients of each half
+  std::vector<Scatterer> coarse(first, last);
+  t_uint offset(0);
+  for(auto &scatterer : coarse) {
+    auto const n = scatterer.nMax * (scatterer.nMax + 2);
+    scatterer.nMax = std::min<t_int>(scatterer.nMax, coarse_nmax);
+    auto const nc = scatterer.nMax * (scatterer.nMax + 2);
+    for(t_int half(0); half < 2; ++half)
+      for(t_int i(0); i < nc; ++i)
+        coarse_indices_.push_back(offset + half * n + i);
+    offset += 2 * n;
+  }
+  // translations between harmonics do not depend on the truncation, so this is exactly the
+  // coarse block of the fine scattering matrix
+  coarse_.compute(preconditioned_scattering_matrix(coarse.begin(), coarse.end(), coarse.begin(),
+                                                   coarse.end(), bground, incWave));
+}
+
+Vector<t_complex> PMultigrid::restriction(Vector<t_complex> const &in) const {
+  Vector<t_complex> result(coarse_rows());
+  for(t_uint i(0); i < coarse_rows(); ++i)
+    result(i) = in(coarse_indices_[i]);
+  return result;
+}
+
+Vector<t_complex> PMultigrid::prolongation(Vector<t_complex> const &in) const {
+  Vector<t_complex> result = Vector<t_complex>::Zero(rows());
+  for(t_uint i(0); i < coarse_rows(); ++i)
+    result(coarse_indices_[i]) = in(i);
+  return result;
+}
+
+void PMultigrid::operator()(Vector<t_complex> const &in, Vector<t_complex> &out) const {
+  if(static_cast<t_uint>(in.size()) != rows())
+    throw std::runtime_error("Incorrect input vector size for the p-multigrid preconditioner");
+  // coarse-grid correction
+  out = prolongation(coarse_.solve(restriction(in)));
+
+  // high-order harmonics are smoothed with the fine operator, or taken as is without it
+  auto const smooth = [this, &out](Vector<t_complex> residual) {
+    for(auto const i : coarse_indices_)
+      residual(i) = 0;
+    out += residual;
+  };
+  if(not fine_ or smoothing_ == 0)
+    return smooth(in);
+  Vector<t_complex> Aout(rows());
+  for(t_uint step(0); step < smoothing_; ++step) {
+    fine_(out, Aout);
+    smooth(in - Aout);
+  }
+}
+} // namespace optimet
@@ -0,0 +1,90 @@
+// (C) University College London 2017
+// This file is part of Optimet, licensed under the terms of the GNU Public License
+//
+// Optimet is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Optimet is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Optimet. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef OPTIMET_P_MULTIGRID_H
+#define OPTIMET_P_MULTIGRID_H
+
+#include "ElectroMagnetic.h"
+#include "Excitation.h"
+#include "Krylov.h"
+#include "Scatterer.h"
+#include "Types.h"
+#include <Eigen/Dense>
+#include <memory>
+#include <vector>
+
+namespace optimet {
+//! \brief Two-level preconditioner over the order of the spherical harmonics
+//! \details The coarse level keeps the harmonics with n up to a small coarse nMax, which capture
+//! most of the coupling between scatterers. The coarse block of the preconditioned scattering
+//! matrix is assembled and LU-factorized once. Applying the preconditioner restricts the residual
+//! to the coarse harmonics, solves the coarse system, prolongs the correction back, and smoothes
+//! the remaining high-order harmonics with the fine operator. High-order harmonics barely scatter,
+//! so that the scattering matrix is close to the identity over them.
+class PMultigrid {
+public:
+  //! \brief Assembles and factorizes the coarse system
+  //! \param[in] first, last: scatterers for which this object is responsible. Input and output
+  //! vectors of the preconditioner are restricted to the coefficients of these scatterers, in
+  //! order.
+  //! \param[in] coarse_nmax: largest order of the harmonics in the coarse level
+  //! \param[in] fine: fine-level operator, over the same coefficients. Without it, the high-order
+  //! harmonics are left untouched.
+  //! \param[in] smoothing: number of smoothing steps with the fine operator
+  PMultigrid(std::vector<Scatterer>::const_iterator const &first,
+             std::vector<Scatterer>::const_iterator const &last, ElectroMagnetic const &bground,
+             std::shared_ptr<Excitation const> incWave, t_uint coarse_nmax = 2,
+             krylov::Operator const &fine = krylov::Operator(), t_uint smoothing = 1);
+  PMultigrid(std::vector<Scatterer> const &objects, ElectroMagnetic const &bground,
+             std::shared_ptr<Excitation const> incWave, t_uint coarse_nmax = 2,
+             krylov::Operator const &fine = krylov::Operator(), t_uint smoothing = 1)
+      : PMultigrid(objects.begin(), objects.end(), bground, incWave, coarse_nmax, fine,
+                   smoothing) {}
+
+  //! Applies the two-level cycle
+  void operator()(Vector<t_complex> const &in, Vector<t_complex> &out) const;
+  //! Applies the two-level cycle
+  Vector<t_complex> operator*(Vector<t_complex> const &in) const {
+    Vector<t_complex> out;
+    operator()(in, out);
+    return out;
+  }
+
+  //! Restricts a vector to the coarse harmonics
+  Vector<t_complex> restriction(Vector<t_complex> const &in) const;
+  //! Prolongs a coarse vector, with zero high-order harmonics
+  Vector<t_complex> prolongation(Vector<t_complex> const &in) const;
+
+  //! Number of rows and columns
+  t_uint rows() const { return rows_; }
+  //! Number of rows and columns of the coarse system
+  t_uint coarse_rows() const { return coarse_indices_.size(); }
+
+protected:
+  //! Number of rows and columns
+  t_uint rows_;
+  //! Index in the fine vector of each coarse coefficient
+  std::vector<t_uint> coarse_indices_;
+  //! LU factors of the coarse system
+  Eigen::PartialPivLU<Matrix<t_complex>> coarse_;
+  //! Fine-level operator
+  krylov::Operator fine_;
+  //! Number of smoothing steps
+  t_uint smoothing_;
+};
+} // namespace optimet
+#endif
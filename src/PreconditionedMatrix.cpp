@@ -14,10 +14,13 @@
 // You should have received a copy of the GNU General Public License
 // along with Optimet. If not, see <http://www.gnu.org/licenses/>.
 
+#include "CompoundIterator.h"
 #include "Coupling.h"
 #include "PreconditionedMatrix.h"
+#include "Threads.h"
 #include "Types.h"
 #include "scalapack/BroadcastToOutOfContext.h"
+#include <algorithm>
 
 namespace optimet {
 #ifdef OPTIMET_SCALAPACK
@@ -60,6 +63,48 @@ Vector<t_complex> gather_all_source_vector(scalapack::Matrix<t_complex> const &m
 }
 #endif
 
+namespace {
+//! \brief Sets block (x, y) of S = I - T * AB, given the coupling and -T of the column scatterer
+//! \details A and B have as many rows as harmonics in the column scatterer, and as many columns
+//! as harmonics in the row scatterer.
+void scattering_block(Matrix<t_complex> &result, t_uint x, t_uint y, Matrix<t_complex> const &A,
+                      Matrix<t_complex> const &B, Vector<t_complex> const &factor) {
+  auto const n = A.cols(), m = A.rows();
+  result.block(x, y, n, m) = A.transpose();
+  result.block(x + n, y + m, n, m) = A.transpose();
+  result.block(x, y + m, n, m) = B.transpose();
+  result.block(x + n, y, n, m) = B.transpose();
+  result.block(x, y, 2 * n, 2 * m).array().transpose().colwise() *= factor.array();
+}
+
+//! \brief Coupling from scatterer j to scatterer i, truncated to their respective harmonics
+//! \details Computes the coupling up to the larger of the two nMax, so that both (i, j) and (j, i)
+//! blocks can be derived from it.
+Coupling scatterer_coupling(Scatterer const &i, Scatterer const &j,
+                            std::shared_ptr<Excitation const> incWave) {
+  return Coupling(i.vR - j.vR, incWave->waveK, std::max(i.nMax, j.nMax));
+}
+
+//! Number of spherical harmonics up to nMax
+t_uint harmonics(t_uint nMax) { return nMax * (nMax + 2); }
+
+//! Parity (-1)^(n + l) relating the coupling of r_i - r_j to that of r_j - r_i
+Matrix<t_real> reciprocity_signs(t_uint nMax) {
+  Vector<t_real> signs(nMax * (nMax + 2));
+  for(t_uint n(1), i(0); n <= nMax; i += 2 * n + 1, ++n)
+    signs.segment(i, 2 * n + 1).fill(n % 2 == 0 ? 1 : -1);
+  return signs * signs.transpose();
+}
+}
+
+std::vector<t_uint> scatterer_offsets(std::vector<Scatterer>::const_iterator first,
+                                      std::vector<Scatterer>::const_iterator const &last) {
+  std::vector<t_uint> result(1, 0);
+  for(; first != last; ++first)
+    result.push_back(result.back() + 2 * harmonics(first->nMax));
+  return result;
+}
+
 Matrix<t_complex>
 preconditioned_scattering_matrix(std::vector<Scatterer>::const_iterator const &first,
                                  std::vector<Scatterer>::const_iterator const &end_first,
@@ -67,29 +112,125 @@ preconditioned_scattering_matrix(std::vector<Scatterer>::const_iterator const &f
                                  std::vector<Scatterer>::const_iterator const &end_second,
                                  ElectroMagnetic const &bground,
                                  std::shared_ptr<Excitation const> incWave) {
-  auto const nMax = first->nMax;
-  auto const n = nMax * (nMax + 2);
+  auto const rows = scatterer_offsets(first, end_first);
+  auto const cols = scatterer_offsets(second, end_second);
   if(first == end_first or second == end_second)
-    return Matrix<t_complex>::Zero(2 * n * (end_first - first), 2 * n * (end_second - second));
-
-  Matrix<t_complex> result(2 * n * (end_first - first), 2 * n * (end_second - second));
-  size_t y(0);
-  for(auto iterj(second); iterj != end_second; ++iterj, y += 2 * n) {
-    Vector<t_complex> const factor = -iterj->getTLocal(incWave->omega(), bground);
-    size_t x(0);
-    for(auto iteri(first); iteri != end_first; ++iteri, x += 2 * n) {
+    return Matrix<t_complex>::Zero(rows.back(), cols.back());
+
+  // -T for each column scatterer, computed only once
+  std::vector<Vector<t_complex>> factors(end_second - second);
+  for(auto iterj(second); iterj != end_second; ++iterj)
+    factors[iterj - second] = -iterj->getTLocal(incWave->omega(), bground);
+
+  // By reciprocity, blocks (i, j) and (j, i) derive from the same coupling. If both are part of
+  // the matrix, then the pair is computed only once, when i < j. Both ranges must come from the
+  // same vector of scatterers.
+  auto const in_columns = [&second, &end_second](std::vector<Scatterer>::const_iterator i) {
+    return i >= second and i < end_second;
+  };
+  auto const in_rows = [&first, &end_first](std::vector<Scatterer>::const_iterator i) {
+    return i >= first and i < end_first;
+  };
+  Matrix<t_complex> result(rows.back(), cols.back());
+  std::vector<std::pair<t_uint, t_uint>> pairs;
+  for(auto iterj(second); iterj != end_second; ++iterj)
+    for(auto iteri(first); iteri != end_first; ++iteri)
       if(iteri == iterj) {
-        result.block(x, y, 2 * n, 2 * n) = Matrix<t_complex>::Identity(2 * n, 2 * n);
-      } else {
-        Coupling const AB(iteri->vR - iterj->vR, incWave->waveK, nMax);
-        result.block(x, y, n, n) = AB.diagonal.transpose();
-        result.block(x + n, y + n, n, n) = AB.diagonal.transpose();
-        result.block(x, y + n, n, n) = AB.offdiagonal.transpose();
-        result.block(x + n, y, n, n) = AB.offdiagonal.transpose();
-        result.block(x, y, 2 * n, 2 * n).array().transpose().colwise() *= factor.array();
-      }
+        auto const n = 2 * harmonics(iteri->nMax);
+        result.block(rows[iteri - first], cols[iterj - second], n, n) =
+            Matrix<t_complex>::Identity(n, n);
+      } else if(iteri < iterj or not(in_columns(iteri) and in_rows(iterj)))
+        pairs.emplace_back(iteri - first, iterj - second);
+
+  parallel_for(pairs.size(), [&](t_int k) {
+    auto const iteri = first + pairs[k].first;
+    auto const iterj = second + pairs[k].second;
+    auto const ni = harmonics(iteri->nMax), nj = harmonics(iterj->nMax);
+    auto const AB = scatterer_coupling(*iteri, *iterj, incWave);
+    scattering_block(result, rows[pairs[k].first], cols[pairs[k].second],
+                     AB.diagonal.topLeftCorner(nj, ni), AB.offdiagonal.topLeftCorner(nj, ni),
+                     factors[pairs[k].second]);
+    if(in_columns(iteri) and in_rows(iterj)) {
+      auto const signs =
+          reciprocity_signs(std::max(iteri->nMax, iterj->nMax)).topLeftCorner(ni, nj).eval();
+      Matrix<t_complex> const A =
+          AB.diagonal.topLeftCorner(ni, nj).cwiseProduct(signs.cast<t_complex>());
+      Matrix<t_complex> const B =
+          -AB.offdiagonal.topLeftCorner(ni, nj).cwiseProduct(signs.cast<t_complex>());
+      scattering_block(result, rows[iterj - first], cols[iteri - second], A, B,
+                       factors[iteri - second]);
     }
+  });
+  return result;
+}
+
+void reciprocity_permutation(Eigen::Ref<Matrix<t_complex>> rows, t_uint nMax) {
+  t_uint const N = nMax * (nMax + 2);
+  assert(rows.rows() % N == 0);
+  for(t_uint i(0); i < static_cast<t_uint>(rows.rows()); i += N)
+    for(t_int n(1); n <= static_cast<t_int>(nMax); ++n)
+      for(t_int m(1); m <= n; ++m) {
+        rows.row(i + flatten_indices(n, m)).swap(rows.row(i + flatten_indices(n, -m)));
+        if(m % 2 == 1) {
+          rows.row(i + flatten_indices(n, m)) *= -1;
+          rows.row(i + flatten_indices(n, -m)) *= -1;
+        }
+      }
+}
+
+void reciprocity_permutation(Eigen::Ref<Matrix<t_complex>> rows,
+                             std::vector<Scatterer> const &objects) {
+  auto const offsets = scatterer_offsets(objects.begin(), objects.end());
+  assert(static_cast<t_uint>(rows.rows()) == offsets.back());
+  for(t_uint i(0); i < objects.size(); ++i)
+    reciprocity_permutation(rows.middleRows(offsets[i], offsets[i + 1] - offsets[i]),
+                            objects[i].nMax);
+}
+
+Vector<t_complex>
+symmetric_scaling(Geometry const &geometry, std::shared_ptr<Excitation const> incWave) {
+  auto const offsets = scatterer_offsets(geometry.objects.begin(), geometry.objects.end());
+  Vector<t_complex> result(offsets.back());
+  for(t_uint i(0); i < geometry.objects.size(); ++i)
+    result.segment(offsets[i], offsets[i + 1] - offsets[i]) =
+        geometry.objects[i].getTLocal(incWave->omega(), geometry.bground).array().sqrt();
+  return result;
+}
+
+PackedLower symmetric_scattering_matrix(Geometry const &geometry,
+                                        std::shared_ptr<Excitation const> incWave) {
+  if(geometry.objects.size() == 0)
+    return PackedLower(0);
+
+  auto const &objects = geometry.objects;
+  auto const offsets = scatterer_offsets(objects.begin(), objects.end());
+  t_int const nobj = objects.size();
+  auto const scaling = symmetric_scaling(geometry, incWave);
+  PackedLower result(offsets.back());
+  std::vector<std::pair<t_uint, t_uint>> pairs;
+  for(t_int j(0); j < nobj; ++j) {
+    auto const n = offsets[j + 1] - offsets[j];
+    Matrix<t_complex> block = Matrix<t_complex>::Identity(n, n);
+    reciprocity_permutation(block, objects[j].nMax);
+    for(t_uint c(0); c < n; ++c)
+      result.column(offsets[j] + c).head(n - c) = block.col(c).tail(n - c);
+    for(t_int i(j + 1); i < nobj; ++i)
+      pairs.emplace_back(i, j);
   }
+
+  parallel_for(pairs.size(), [&](t_int k) {
+    auto const i = pairs[k].first, j = pairs[k].second;
+    auto const ni = harmonics(objects[i].nMax), nj = harmonics(objects[j].nMax);
+    auto const AB = scatterer_coupling(objects[i], objects[j], incWave);
+    Matrix<t_complex> block(2 * ni, 2 * nj);
+    scattering_block(block, 0, 0, AB.diagonal.topLeftCorner(nj, ni),
+                     AB.offdiagonal.topLeftCorner(nj, ni), -scaling.segment(offsets[j], 2 * nj));
+    block = scaling.segment(offsets[i], 2 * ni).asDiagonal() * block;
+    reciprocity_permutation(block, objects[i].nMax);
+    // block (i, j) lies strictly below the diagonal, in columns of j
+    for(t_uint c(0); c < 2 * nj; ++c)
+      result.column(offsets[j] + c).segment(offsets[i] - offsets[j] - c, 2 * ni) = block.col(c);
+  });
   return result;
 }
 
@@ -104,11 +245,6 @@ Matrix<t_complex> preconditioned_scattering_matrix(Geometry const &geometry,
                                                    std::shared_ptr<Excitation const> incWave) {
   if(geometry.objects.size() == 0)
     return Matrix<t_complex>(0, 0);
-  // Check nMax is same accross all objects
-  auto const nMax = geometry.objects.front().nMax;
-  for(auto const &scatterer : geometry.objects)
-    if(scatterer.nMax != nMax)
-      throw std::runtime_error("All objects must have same number of harmonics");
   return preconditioned_scattering_matrix(geometry.objects, geometry.bground, incWave);
 }
 
@@ -117,54 +253,78 @@ Matrix<t_complex> preconditioned_scattering_matrix(Geometry const &geometry,
                                                    std::shared_ptr<Excitation const> incWave,
                                                    scalapack::Context const &context,
                                                    scalapack::Sizes const &blocks) {
-  // construct an n by 1 context
-  auto const nobj = geometry.objects.size();
+  t_uint const nobj = geometry.objects.size();
   if(nobj == 0)
     return Matrix<t_complex>::Zero(0, 0);
-  auto rank_map = context.rank_map();
-  rank_map.resize(1, context.size());
-  auto const linear_context = context.subcontext(rank_map.leftCols(std::min(context.size(), nobj)));
-
-  auto const nMax = geometry.objects.front().nMax;
-  auto const remainder = linear_context.is_valid() ? nobj % linear_context.size() : 0;
-  auto const nloc = linear_context.is_valid() ? nobj / linear_context.size() : 0;
-  t_uint const n = nMax * (nMax + 2);
-  scalapack::Sizes const non_cyclic{linear_context.is_valid() ? nobj * n * 2 : 1,
-                                    linear_context.is_valid() ? nloc * n * 2 : 1};
-  scalapack::Matrix<t_complex> linear_matrix(linear_context, {nobj * n * 2, nobj * n * 2},
-                                             non_cyclic);
-  if(linear_context.is_valid()) {
-    assert(geometry.objects.end() > geometry.objects.begin() + nloc * linear_context.col());
-    assert(geometry.objects.end() >= geometry.objects.begin() + nloc * (1 + linear_context.col()));
-    assert(nloc * 2 * n > 0);
-    linear_matrix.local().leftCols(nloc * 2 * n) = preconditioned_scattering_matrix(
-        geometry.objects.begin(), geometry.objects.end(),
-        geometry.objects.begin() + nloc * linear_context.col(),
-        geometry.objects.begin() + nloc * (1 + linear_context.col()), geometry.bground, incWave);
-  }
 
-  if(remainder > 0 and linear_context.is_valid()) {
-    auto const remainder_context = linear_context.subcontext(rank_map.leftCols(remainder));
-    scalapack::Matrix<t_complex> remainder_matrix(
-        remainder_context, {nobj * n * 2, remainder * n * 2}, {nobj * n * 2, 2 * n});
-    if(remainder_context.is_valid())
-      remainder_matrix.local() = preconditioned_scattering_matrix(
-          geometry.objects.begin(), geometry.objects.end(),
-          geometry.objects.begin() + nloc * linear_context.cols() + remainder_context.col(),
-          geometry.objects.begin() + nloc * linear_context.cols() + remainder_context.col() + 1,
-          geometry.bground, incWave);
-
-    scalapack::Matrix<t_complex> transfered(linear_context, {nobj * n * 2, remainder * n * 2},
-                                            {nobj * n * 2, nloc * n * 2});
-    remainder_matrix.transfer_to(linear_context, transfered);
-    if(transfered.local().cols() > 0)
-      linear_matrix.local().rightCols(transfered.local().cols()) = transfered.local();
+  auto const &objects = geometry.objects;
+  auto const offsets = scatterer_offsets(objects.begin(), objects.end());
+  scalapack::Matrix<t_complex> result(context, {offsets.back(), offsets.back()}, blocks);
+  if(result.local().size() == 0)
+    return result.local();
+
+  // For each scatterer, local rows and columns with the harmonic index they correspond to
+  typedef std::vector<std::pair<t_uint, t_uint>> Indices;
+  std::vector<Indices> rows(nobj), cols(nobj);
+  auto const owner = [&offsets](t_uint global) -> t_uint {
+    return std::upper_bound(offsets.begin(), offsets.end(), global) - offsets.begin() - 1;
+  };
+  for(t_uint i(0); i < static_cast<t_uint>(result.local().rows()); ++i) {
+    auto const global = std::get<0>(result.global_indices(i, 0));
+    auto const particle = owner(global);
+    rows[particle].emplace_back(i, global - offsets[particle]);
   }
+  for(t_uint j(0); j < static_cast<t_uint>(result.local().cols()); ++j) {
+    auto const global = std::get<1>(result.global_indices(0, j));
+    auto const particle = owner(global);
+    cols[particle].emplace_back(j, global - offsets[particle]);
+  }
+  // Copies the relevant rows and columns of a particle block to the local matrix
+  auto const scatter = [&result, &rows, &cols](Matrix<t_complex> const &block, t_uint i,
+                                                t_uint j) {
+    for(auto const &col : cols[j])
+      for(auto const &row : rows[i])
+        result.local()(row.first, col.first) = block(row.second, col.second);
+  };
+
+  // Unordered pairs of scatterers intersecting the local tiles, each computed only once
+  std::vector<std::pair<t_uint, t_uint>> pairs;
+  for(t_uint j(0); j < nobj; ++j)
+    for(t_uint i(0); i < nobj; ++i)
+      if(rows[i].size() > 0 and cols[j].size() > 0 and
+         (i <= j or rows[j].size() == 0 or cols[i].size() == 0))
+        pairs.emplace_back(i, j);
 
-  scalapack::Matrix<t_complex> distributed_matrix(context, linear_matrix.sizes(), blocks);
+  std::vector<Vector<t_complex>> factors(nobj);
+  for(t_uint j(0); j < nobj; ++j)
+    if(cols[j].size() > 0 or rows[j].size() > 0)
+      factors[j] = -objects[j].getTLocal(incWave->omega(), geometry.bground);
 
-  linear_matrix.transfer_to(context, distributed_matrix);
-  return distributed_matrix.local();
+  parallel_for(pairs.size(), [&](t_int k) {
+    auto const i = pairs[k].first, j = pairs[k].second;
+    auto const ni = harmonics(objects[i].nMax), nj = harmonics(objects[j].nMax);
+    if(i == j) {
+      scatter(Matrix<t_complex>::Identity(2 * ni, 2 * ni), i, j);
+      return;
+    }
+    auto const AB = scatterer_coupling(objects[i], objects[j], incWave);
+    Matrix<t_complex> block(2 * ni, 2 * nj);
+    scattering_block(block, 0, 0, AB.diagonal.topLeftCorner(nj, ni),
+                     AB.offdiagonal.topLeftCorner(nj, ni), factors[j]);
+    scatter(block, i, j);
+    if(rows[j].size() > 0 and cols[i].size() > 0) {
+      auto const signs = reciprocity_signs(std::max(objects[i].nMax, objects[j].nMax))
+                             .topLeftCorner(ni, nj)
+                             .cast<t_complex>()
+                             .eval();
+      Matrix<t_complex> const A = AB.diagonal.topLeftCorner(ni, nj).cwiseProduct(signs);
+      Matrix<t_complex> const B = -AB.offdiagonal.topLeftCorner(ni, nj).cwiseProduct(signs);
+      block.resize(2 * nj, 2 * ni);
+      scattering_block(block, 0, 0, A, B, factors[i]);
+      scatter(block, j, i);
+    }
+  });
+  return result.local();
 }
 #else
 Matrix<t_complex> preconditioned_scattering_matrix(Geometry const &geometry,
@@ -178,13 +338,13 @@ Matrix<t_complex> preconditioned_scattering_matrix(Geometry const &geometry,
 Vector<t_complex> source_vector(std::vector<Scatterer>::const_iterator first,
                                 std::vector<Scatterer>::const_iterator const &last,
                                 std::shared_ptr<Excitation const> incWave) {
-  if(first == last)
-    return Vector<t_complex>::Zero(0);
-  auto const nMax = first->nMax;
-  auto const flatMax = nMax * (nMax + 2);
-  Vector<t_complex> result(2 * flatMax * (last - first));
-  for(size_t i(0); first != last; ++first, i += 2 * flatMax)
-    incWave->getIncLocal(first->vR, result.data() + i, nMax);
+  auto const offsets = scatterer_offsets(first, last);
+  t_int const N = last - first;
+  Vector<t_complex> result(offsets.back());
+  // scatterers are independent of one another
+#pragma omp parallel for
+  for(t_int i = 0; i < N; ++i)
+    incWave->getIncLocal((first + i)->vR, result.data() + offsets[i], (first + i)->nMax);
   return result;
 }
 
@@ -197,35 +357,44 @@ Vector<t_complex>
 source_vector(Geometry const &geometry, std::shared_ptr<Excitation const> incWave) {
   if(geometry.objects.size() == 0)
     return Vector<t_complex>(0, 0);
-  // Check nMax is same accross all objects
-  auto const nMax = geometry.objects.front().nMax;
-  for(auto const &scatterer : geometry.objects)
-    if(scatterer.nMax != nMax)
-      throw std::runtime_error("All objects must have same number of harmonics");
   return source_vector(geometry.objects, incWave);
 }
 
+Matrix<t_complex> source_vectors(std::vector<Scatterer>::const_iterator first,
+                                 std::vector<Scatterer>::const_iterator const &last,
+                                 std::shared_ptr<Excitation const> incWave) {
+  Matrix<t_complex> result(scatterer_offsets(first, last).back(), incWave->nwaves());
+  for(t_uint i(0); i < incWave->nwaves(); ++i)
+    result.col(i) = source_vector(first, last, std::make_shared<Excitation>(incWave->wave(i)));
+  return result;
+}
+
+Matrix<t_complex>
+source_vectors(Geometry const &geometry, std::shared_ptr<Excitation const> incWave) {
+  return source_vectors(geometry.objects.begin(), geometry.objects.end(), incWave);
+}
+
 Vector<t_complex> local_source_vector(Geometry const &geometry,
                                       std::shared_ptr<Excitation const> incWave,
                                       Vector<t_complex> const &input_coeffs) {
   if(geometry.objects.size() == 0)
     return Vector<t_complex>(0, 0);
-  // Check nMax is same accross all objects
-  auto const nMax = geometry.objects.front().nMax;
-  for(auto const &scatterer : geometry.objects)
-    if(scatterer.nMax != nMax)
-      throw std::runtime_error("All objects must have same number of harmonics");
 
   Geometry copy_geometry(geometry);
-  copy_geometry.setSourcesSingle(incWave, input_coeffs.data(), nMax);
+  copy_geometry.setSourcesSingle(incWave, input_coeffs.data());
   // Get the IncLocal matrices
   // These correspond directly to the Beta*a in Stout2002 Eq. 10 as
   // they are already translated.
   // we are in the SH case -> get the local sources from the geometry
-  auto const flatMax = nMax * (nMax + 2);
-  Vector<t_complex> result(flatMax * 2 * copy_geometry.objects.size());
-  for(size_t i = 0; i < copy_geometry.objects.size(); i++)
-    copy_geometry.getSourceLocal(i, incWave, nMax, result.data() + i * 2 * flatMax);
+  auto const offsets =
+      scatterer_offsets(copy_geometry.objects.begin(), copy_geometry.objects.end());
+  t_int const N = copy_geometry.objects.size();
+  Vector<t_complex> result(offsets.back());
+  // targets are independent of one another
+  parallel_for(N, [&](t_int i) {
+    copy_geometry.getSourceLocal(i, incWave, copy_geometry.objects[i].nMax,
+                                 result.data() + offsets[i]);
+  });
   return result;
 }
 }
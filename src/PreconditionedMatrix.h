@@ -19,6 +19,7 @@
 
 #include "Excitation.h"
 #include "Geometry.h"
+#include "SymmetricLDLT.h"
 #include "Types.h"
 #include "scalapack/Context.h"
 #include "scalapack/Matrix.h"
@@ -31,6 +32,13 @@ source_vector(Geometry const &geometry, std::shared_ptr<Excitation const> incWav
 Vector<t_complex> source_vector(std::vector<Scatterer>::const_iterator first,
                                 std::vector<Scatterer>::const_iterator const &last,
                                 std::shared_ptr<Excitation const> incWave);
+//! \brief Computes one source vector per incident plane wave, from a range of scatterers
+Matrix<t_complex> source_vectors(std::vector<Scatterer>::const_iterator first,
+                                 std::vector<Scatterer>::const_iterator const &last,
+                                 std::shared_ptr<Excitation const> incWave);
+//! \brief Computes one source vector per incident plane wave
+Matrix<t_complex>
+source_vectors(Geometry const &geometry, std::shared_ptr<Excitation const> incWave);
 //! \brief Computes source vector from fundamental frequency
 Vector<t_complex> local_source_vector(Geometry const &geometry,
                                       std::shared_ptr<Excitation const> incWave,
@@ -40,11 +48,44 @@ Vector<t_complex> local_source_vector(Geometry const &geometry,
 Matrix<t_complex> preconditioned_scattering_matrix(Geometry const &geometry,
                                                    std::shared_ptr<Excitation const> incWave);
 
+//! \brief Offset of each scatterer in the scattering vector, followed by the total size
+//! \details Each scatterer contributes 2 nMax (nMax + 2) coefficients, with its own nMax.
+std::vector<t_uint> scatterer_offsets(std::vector<Scatterer>::const_iterator first,
+                                      std::vector<Scatterer>::const_iterator const &last);
+
+//! \brief Computes the blocks of the preconditioned scattering matrix between two ranges
+//! \details Rows correspond to scatterers in [first, end_first), columns to scatterers in
+//! [second, end_second). Both ranges must come from the same vector.
+Matrix<t_complex>
+preconditioned_scattering_matrix(std::vector<Scatterer>::const_iterator const &first,
+                                 std::vector<Scatterer>::const_iterator const &end_first,
+                                 std::vector<Scatterer>::const_iterator const &second,
+                                 std::vector<Scatterer>::const_iterator const &end_second,
+                                 ElectroMagnetic const &bground,
+                                 std::shared_ptr<Excitation const> incWave);
+
 //! Computes preconditioned scattering matrix in paralllel
 Matrix<t_complex> preconditioned_scattering_matrix(Geometry const &geometry,
                                                    std::shared_ptr<Excitation const> incWave,
                                                    scalapack::Context const &context,
                                                    scalapack::Sizes const &blocks);
+//! \brief Lower triangle of the complex-symmetric form of the preconditioned scattering matrix
+//! \details With T the Mie coefficients, Π the signed permutation (n, m) -> (n, -m) with sign
+//! (-1)^m, and S = I - T*AB, reciprocity makes M = Π T^{1/2} S T^{-1/2} complex-symmetric. Only
+//! the lower triangle of M is computed and stored, in packed form. The scattering problem S x = Q
+//! is equivalent to M y = Π T^{1/2} Q, with x = T^{-1/2} y.
+PackedLower symmetric_scattering_matrix(Geometry const &geometry,
+                                        std::shared_ptr<Excitation const> incWave);
+//! Square root of the Mie coefficients of each scatterer, i.e. the scaling T^{1/2}
+Vector<t_complex>
+symmetric_scaling(Geometry const &geometry, std::shared_ptr<Excitation const> incWave);
+//! \brief Applies Π, the signed permutation (n, m) -> (n, -m) with sign (-1)^m, to the rows
+//! \details The number of rows must be a multiple of nMax * (nMax + 2).
+void reciprocity_permutation(Eigen::Ref<Matrix<t_complex>> rows, t_uint nMax);
+//! Applies Π to the rows, with the block and nMax of each scatterer
+void reciprocity_permutation(Eigen::Ref<Matrix<t_complex>> rows,
+                             std::vector<Scatterer> const &objects);
+
 //! Distributes the source vectors
 Vector<t_complex> distributed_source_vector(Vector<t_complex> const &input,
                                             scalapack::Context const &context,
@@ -0,0 +1,77 @@
+// (C) University College London 2017
+// This file is part of Optimet, licensed under the terms of the GNU Public License
+//
+// Optimet is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Optimet is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Optimet. If not, see <http://www.gnu.org/licenses/>.
+
+#include "PreconditionedMatrixSolver.h"
+
+namespace optimet {
+namespace solver {
+
+Matrix<t_complex> PreconditionedMatrix::solve_preconditioned(Matrix<t_complex> const &Q_) const {
+  auto const factorization = parameters_.factorization;
+  if(not is_factorized) {
+    if(factorization == Factorization::QR)
+      qr.compute(S);
+    else if(factorization == Factorization::MIXED and not refinement_failed)
+      single_lu.compute(S.cast<std::complex<float>>());
+    else if(factorization == Factorization::LDLT)
+      ldlt.compute(std::move(symmetric));
+    else
+      lu.compute(S);
+    is_factorized = true;
+  }
+  if(factorization == Factorization::QR)
+    return qr.solve(Q_);
+  if(factorization == Factorization::LDLT)
+    return solve_symmetric(Q_);
+  if(factorization == Factorization::MIXED and not refinement_failed) {
+    Matrix<t_complex> result;
+    if(refine(Q_, result))
+      return result;
+    // fall back to double precision until the next update
+    refinement_failed = true;
+    single_lu = Eigen::PartialPivLU<Matrix<std::complex<float>>>();
+    lu.compute(S);
+  }
+  return lu.solve(Q_);
+}
+
+Matrix<t_complex> PreconditionedMatrix::solve_symmetric(Matrix<t_complex> const &Q_) const {
+  Matrix<t_complex> rhs = scaling.asDiagonal() * Q_;
+  reciprocity_permutation(rhs, geometry->objects);
+  // Components for which T is zero do not contribute to the scattered field
+  Vector<t_complex> const inverse =
+      (scaling.array() == t_complex(0)).select(t_complex(0), scaling.array().inverse());
+  return inverse.asDiagonal() * ldlt.solve(rhs);
+}
+
+bool PreconditionedMatrix::refine(Matrix<t_complex> const &Q_, Matrix<t_complex> &X) const {
+  auto const tolerance = parameters_.refinement_tolerance * Q_.norm();
+  X = single_lu.solve(Q_.cast<std::complex<float>>()).cast<t_complex>();
+  Matrix<t_complex> residual = Q_ - S * X;
+  auto previous = residual.norm();
+  for(t_uint i(0); i < parameters_.refinement_iterations and previous > tolerance; ++i) {
+    X += single_lu.solve(residual.cast<std::complex<float>>()).cast<t_complex>();
+    residual = Q_ - S * X;
+    auto const current = residual.norm();
+    // stalled: each step should at least halve the residual
+    if(current > 0.5 * previous)
+      return current <= tolerance;
+    previous = current;
+  }
+  return previous <= tolerance;
+}
+}
+}
@@ -19,39 +19,113 @@
 
 #include "PreconditionedMatrix.h"
 #include "Solver.h"
+#include "SymmetricLDLT.h"
 #include "Types.h"
 #include <Eigen/Dense>
 
 namespace optimet {
 namespace solver {
 
-//! Use an actual matrix, and Eigen's Householder QR method
+//! Use an actual matrix, and Eigen's LU, Householder QR, mixed-precision LU, or symmetric LDL^T
 class PreconditionedMatrix : public AbstractSolver {
 public:
   PreconditionedMatrix(std::shared_ptr<Geometry> geometry,
                        std::shared_ptr<Excitation const> incWave,
-                       mpi::Communicator const &communicator = mpi::Communicator())
-      : AbstractSolver(geometry, incWave, communicator) {
+                       mpi::Communicator const &communicator = mpi::Communicator(),
+                       Parameters const &parameters = Parameters())
+      : AbstractSolver(geometry, incWave, communicator), parameters_(parameters),
+        is_factorized(false), refinement_failed(false) {
     update();
   }
   PreconditionedMatrix(Run const &run)
-      : PreconditionedMatrix(run.geometry, run.excitation, run.communicator) {}
+      : PreconditionedMatrix(run.geometry, run.excitation, run.communicator, run.solver_params) {}
 
   void solve(Vector<t_complex> &X_sca_, Vector<t_complex> &X_int_) const override {
-    X_sca_ = S.colPivHouseholderQr().solve(Q);
+    X_sca_ = solve_preconditioned(Q);
     unprecondition(X_sca_, X_int_);
   }
+  //! \brief Solves for several right-hand-sides at once, one per column
+  //! \details The factorization of S is computed at most once, and kept until the next update.
+  void solve(Matrix<t_complex> const &Q_, Matrix<t_complex> &X_sca_,
+             Matrix<t_complex> &X_int_) const {
+    Matrix<t_complex> const preconditioned = solve_preconditioned(Q_);
+    X_sca_.resize(preconditioned.rows(), preconditioned.cols());
+    X_int_.resize(preconditioned.rows(), preconditioned.cols());
+    Vector<t_complex> scattered, internal;
+    for(t_uint i(0); i < static_cast<t_uint>(preconditioned.cols()); ++i) {
+      scattered = preconditioned.col(i);
+      unprecondition(scattered, internal);
+      X_sca_.col(i) = scattered;
+      X_int_.col(i) = internal;
+    }
+  }
+  //! Solves for every incident wave at once, with a single factorization of S
+  void solve_waves(Matrix<t_complex> &X_sca_, Matrix<t_complex> &X_int_) const override {
+    solve(source_vectors(*geometry, incWave), X_sca_, X_int_);
+  }
 
+  using AbstractSolver::update;
   void update() override {
     Q = source_vector(*geometry, incWave);
-    S = preconditioned_scattering_matrix(*geometry, incWave);
+    if(parameters_.factorization == Factorization::LDLT) {
+      S = Matrix<t_complex>();
+      symmetric = symmetric_scattering_matrix(*geometry, incWave);
+      scaling = symmetric_scaling(*geometry, incWave);
+    } else
+      S = preconditioned_scattering_matrix(*geometry, incWave);
+    is_factorized = false;
+    refinement_failed = false;
   }
 
+  //! Factorization used to solve the linear system
+  Factorization factorization() const { return parameters_.factorization; }
+  //! Sets the factorization used to solve the linear system
+  void factorization(Factorization f) {
+    auto const reassemble = (f == Factorization::LDLT) != (factorization() == Factorization::LDLT);
+    is_factorized = is_factorized and f == parameters_.factorization;
+    parameters_.factorization = f;
+    if(reassemble)
+      update();
+  }
+  //! Parameters of the solver
+  Parameters const &parameters() const { return parameters_; }
+  //! \brief Whether mixed-precision refinement failed to converge
+  //! \details In that case, the solver falls back to a double precision LU until the next update.
+  bool refinement_stalled() const { return refinement_failed; }
+
 protected:
-  //! The scattering matrix S = I - T*AB
+  //! \brief The scattering matrix S = I - T*AB
+  //! \details Empty with the LDLT factorization, which only needs the symmetric form.
   Matrix<t_complex> S;
+  //! \brief Packed lower triangle of the symmetric form of S
+  //! \details Handed over to the LDLT factorization, which overwrites it with its factors.
+  mutable PackedLower symmetric;
   //! The local field matrix Q = T*AB*a
   Vector<t_complex> Q;
+  //! Factorization and refinement parameters
+  Parameters parameters_;
+  //! Whether the factorization of S is up to date
+  mutable bool is_factorized;
+  //! Whether mixed-precision refinement stalled since the last update
+  mutable bool refinement_failed;
+  //! Partial pivot LU factorization of S
+  mutable Eigen::PartialPivLU<Matrix<t_complex>> lu;
+  //! Column pivot Householder QR factorization of S
+  mutable Eigen::ColPivHouseholderQR<Matrix<t_complex>> qr;
+  //! Single precision LU factorization of S
+  mutable Eigen::PartialPivLU<Matrix<std::complex<float>>> single_lu;
+  //! Complex-symmetric factorization of the symmetric form of S
+  mutable SymmetricLDLT ldlt;
+  //! Scaling T^{1/2} between S and its symmetric form
+  Vector<t_complex> scaling;
+
+  //! Solves S X = Q_, factorizing S if needed
+  Matrix<t_complex> solve_preconditioned(Matrix<t_complex> const &Q_) const;
+  //! Solves S X = Q_ via the LDL^T factorization of the symmetric form of S
+  Matrix<t_complex> solve_symmetric(Matrix<t_complex> const &Q_) const;
+  //! \brief Solves S X = Q_ with single precision LU and double precision residuals
+  //! \returns false if the refinement stalled before reaching the requested tolerance
+  bool refine(Matrix<t_complex> const &Q_, Matrix<t_complex> &X) const;
 
   //! Unpreconditions the result of preconditioned computation
   void unprecondition(Vector<t_complex> &X_sca_, Vector<t_complex> &X_int_) const {
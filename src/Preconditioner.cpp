@@ -0,0 +1,48 @@
+// (C) University College London 2017
+// This file is part of Optimet, licensed under the terms of the GNU Public License
+//
+// Optimet is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Optimet is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Optimet. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "Preconditioner.h"
+#include "BlockJacobi.h"
+#include "PMultigrid.h"
+#include <stdexcept>
+
+namespace optimet {
+namespace solver {
+krylov::Operator preconditioner(Parameters const &parameters,
+                                std::vector<Scatterer>::const_iterator const &first,
+                                std::vector<Scatterer>::const_iterator const &last,
+                                ElectroMagnetic const &bground,
+                                std::shared_ptr<Excitation const> incWave,
+                                krylov::Operator const &fine) {
+  if(parameters.preconditioner == "none")
+    return krylov::Operator();
+  if(parameters.preconditioner == "block-jacobi") {
+    auto const jacobi = std::make_shared<BlockJacobi const>(first, last, bground, incWave,
+                                                            parameters.preconditioner_size);
+    return [jacobi](Vector<t_complex> const &in, Vector<t_complex> &out) { (*jacobi)(in, out); };
+  }
+  if(parameters.preconditioner == "p-multigrid") {
+    auto const multigrid = std::make_shared<PMultigrid const>(
+        first, last, bground, incWave, parameters.coarse_nmax, fine, parameters.smoothing_steps);
+    return [multigrid](Vector<t_complex> const &in, Vector<t_complex> &out) {
+      (*multigrid)(in, out);
+    };
+  }
+  throw std::runtime_error("Unknown preconditioner " + parameters.preconditioner);
+}
+} // namespace solver
+} // namespace optimet
@@ -0,0 +1,44 @@
+// (C) University College London 2017
+// This file is part of Optimet, licensed under the terms of the GNU Public License
+//
+// Optimet is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Optimet is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Optimet. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef OPTIMET_PRECONDITIONER_H
+#define OPTIMET_PRECONDITIONER_H
+
+#include "ElectroMagnetic.h"
+#include "Excitation.h"
+#include "Krylov.h"
+#include "Scatterer.h"
+#include "SolverParameters.h"
+#include "Types.h"
+#include <memory>
+#include <vector>
+
+namespace optimet {
+namespace solver {
+//! \brief Preconditioner of the FMM Krylov solvers, as selected by the parameters
+//! \details "none" gives an empty operator, "block-jacobi" a BlockJacobi, and "p-multigrid" a
+//! PMultigrid. Preconditioners act on the coefficients of the scatterers in [first, last) only.
+//! \param[in] fine: operator of the system, over the same coefficients. Used by smoothers.
+krylov::Operator preconditioner(Parameters const &parameters,
+                                std::vector<Scatterer>::const_iterator const &first,
+                                std::vector<Scatterer>::const_iterator const &last,
+                                ElectroMagnetic const &bground,
+                                std::shared_ptr<Excitation const> incWave,
+                                krylov::Operator const &fine = krylov::Operator());
+} // namespace solver
+} // namespace optimet
+#endif
@@ -44,6 +44,8 @@ Scatterer read_spherical_scatterer(pugi::xml_node const &node, t_int nMax);
 std::shared_ptr<Geometry> read_structure(pugi::xml_node const &inputFile, t_int nMax);
 std::shared_ptr<Excitation> read_excitation(pugi::xml_document const &inputFile, t_int nMax);
 scalapack::Parameters read_parallel(const pugi::xml_node &node);
+solver::Parameters read_solver(const pugi::xml_node &node);
+void read_krylov(pugi::xml_node const &node, solver::Parameters &parameters);
 #ifdef OPTIMET_BELOS
 Teuchos::RCP<Teuchos::ParameterList> read_parameter_list(pugi::xml_document const &root_node);
 std::tuple<bool, t_int> read_fmm_input(pugi::xml_node const &node);
@@ -300,6 +302,22 @@ std::shared_ptr<Excitation> read_excitation(pugi::xml_document const &inputFile,
   auto result = std::make_shared<optimet::Excitation>(source_type, Einc, vKinc, nMax);
   result->populate();
 
+  // Additional plane waves, solved for together with the main one
+  for(auto const &wave_node : ext_node.children("wave")) {
+    auto const propagation = wave_node.child("propagation");
+    auto const polarization = wave_node.child("polarization");
+    Spherical<double> const direction(
+        0.0, propagation.attribute("theta").as_double() * consPi / 180.0,
+        propagation.attribute("phi").as_double() * consPi / 180.0);
+    SphericalP<std::complex<double>> const field(
+        std::complex<double>(0.0, 0.0),
+        std::complex<double>(polarization.attribute("Etheta.real").as_double(),
+                             polarization.attribute("Etheta.imag").as_double()),
+        std::complex<double>(polarization.attribute("Ephi.real").as_double(),
+                             polarization.attribute("Ephi.imag").as_double()));
+    result->add_wave(direction, Tools::toProjection(direction, field));
+  }
+
   return result;
 }
 
@@ -380,9 +398,72 @@ scalapack::Parameters read_parallel(const pugi::xml_node &node) {
   result.block_size = node.attribute("block_size").as_uint(result.block_size);
   result.grid.rows = node.child("grid").attribute("rows").as_uint(result.grid.rows);
   result.grid.cols = node.child("grid").attribute("cols").as_uint(result.grid.cols);
+  result.autotune = node.attribute("autotune").as_bool(result.autotune);
+  result.tuning_file = node.attribute("tuning_file").as_string(result.tuning_file.c_str());
+  result.trial_size = node.attribute("trial_size").as_uint(result.trial_size);
+  return result;
+}
+
+solver::Parameters read_solver(const pugi::xml_node &node) {
+  solver::Parameters result;
+  result.method = node.attribute("method").as_string(result.method.c_str());
+  if(node.attribute("factorization"))
+    result.factorization = solver::factorization(node.attribute("factorization").value());
+  result.refinement_tolerance =
+      node.attribute("refinement_tolerance").as_double(result.refinement_tolerance);
+  result.refinement_iterations =
+      node.attribute("refinement_iterations").as_uint(result.refinement_iterations);
+  result.tile_size = node.attribute("tile_size").as_uint(result.tile_size);
+  result.cache_tiles = node.attribute("cache_tiles").as_uint(result.cache_tiles);
+  result.scratch = node.attribute("scratch").as_string(result.scratch.c_str());
+  result.compression_tolerance =
+      node.attribute("compression_tolerance").as_double(result.compression_tolerance);
+  result.leaf_size = node.attribute("leaf_size").as_uint(result.leaf_size);
+  result.threads = node.attribute("threads").as_uint(result.threads);
+  result.krylov = node.attribute("krylov").as_string(result.krylov.c_str());
+  result.tolerance = node.attribute("tolerance").as_double(result.tolerance);
+  result.max_iterations = node.attribute("max_iterations").as_uint(result.max_iterations);
+  result.restart = node.attribute("restart").as_uint(result.restart);
+  result.verbosity = node.attribute("verbosity").as_int(result.verbosity);
+  result.preconditioner = node.attribute("preconditioner").as_string(result.preconditioner.c_str());
+  result.preconditioner_size =
+      node.attribute("preconditioner_size").as_uint(result.preconditioner_size);
+  result.coarse_nmax = node.attribute("coarse_nmax").as_uint(result.coarse_nmax);
+  result.smoothing_steps = node.attribute("smoothing_steps").as_uint(result.smoothing_steps);
+  if(node.attribute("warm_start"))
+    result.warm_start = solver::warm_start(node.attribute("warm_start").value());
+  result.recycle = node.attribute("recycle").as_uint(result.recycle);
+  result.recycle_threshold =
+      node.attribute("recycle_threshold").as_double(result.recycle_threshold);
+  result.inexact_levels = node.attribute("inexact_levels").as_uint(result.inexact_levels);
+  result.scattering_orders =
+      node.attribute("scattering_orders").as_uint(result.scattering_orders);
+  result.series_operator =
+      node.attribute("series_operator").as_string(result.series_operator.c_str());
+  result.sstep = node.attribute("sstep").as_uint(result.sstep);
+  result.telemetry = node.attribute("telemetry").as_bool(result.telemetry);
   return result;
 }
 
+void read_krylov(pugi::xml_node const &node, solver::Parameters &parameters) {
+  for(auto const &parameter : node.children("Parameter")) {
+    std::string const name = parameter.attribute("name").value();
+    auto const value = parameter.attribute("value");
+    if(name == "Solver")
+      parameters.krylov = value.as_string(parameters.krylov.c_str());
+    else if(name == "Convergence Tolerance")
+      parameters.tolerance = value.as_double(parameters.tolerance);
+    else if(name == "Maximum Iterations")
+      parameters.max_iterations = value.as_uint(parameters.max_iterations);
+    else if(name == "Num Blocks")
+      parameters.restart = value.as_uint(parameters.restart);
+    else if(name == "Num Recycled Blocks")
+      parameters.recycle = value.as_uint(parameters.recycle);
+    else if(name == "Verbosity")
+      parameters.verbosity = value.as_int(parameters.verbosity);
+  }
+}
+
 #ifdef OPTIMET_BELOS
 Teuchos::RCP<Teuchos::ParameterList> read_parameter_list(pugi::xml_document const &root_node) {
   auto const xml_params = root_node.child("ParameterList");
@@ -420,8 +501,13 @@ Run simulation_input(pugi::xml_document const &inputFile) {
   read_output(inputFile, result);
 
   result.parallel_params = read_parallel(inputFile.child("parallel"));
+  result.solver_params = read_solver(inputFile.child("solver"));
+  read_krylov(inputFile.child("ParameterList"), result.solver_params);
 #ifdef OPTIMET_BELOS
   result.belos_params = read_parameter_list(inputFile);
+  if(result.belos_params->isParameter("Factorization"))
+    result.solver_params.factorization =
+        solver::factorization(result.belos_params->get<std::string>("Factorization"));
   std::tie(result.do_fmm, result.fmm_subdiagonals) = read_fmm_input(inputFile.child("FMM"));
 #endif
 
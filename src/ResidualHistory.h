@@ -0,0 +1,100 @@
+// (C) University College London 2017
+// This file is part of Optimet, licensed under the terms of the GNU Public License
+//
+// Optimet is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Optimet is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Optimet. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef OPTIMET_RESIDUAL_HISTORY_H
+#define OPTIMET_RESIDUAL_HISTORY_H
+
+#include "Types.h"
+#ifdef OPTIMET_BELOS
+
+#include <BelosIteration.hpp>
+#include <BelosLinearProblem.hpp>
+#include <BelosMultiVecTraits.hpp>
+#include <BelosSolverManager.hpp>
+#include <BelosStatusTest.hpp>
+#include <BelosStatusTestCombo.hpp>
+#include <Teuchos_RCP.hpp>
+#include <algorithm>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+namespace optimet {
+//! \brief Records the relative residual of each Belos iteration
+//! \details The residuals are the method's native estimates: the largest residual over the
+//! columns of the current block, divided by the largest right-hand side. The first entry is the
+//! residual of the initial guess. This test never declares convergence, so that combining it with
+//! the manager's own tests does not change when the solver stops.
+template <class SCALAR, class MV, class OP>
+class ResidualHistory : public Belos::StatusTest<SCALAR, MV, OP> {
+public:
+  ResidualHistory(std::shared_ptr<std::vector<t_real>> const &history)
+      : history_(history), iteration_(-1) {}
+
+  Belos::StatusType checkStatus(Belos::Iteration<SCALAR, MV, OP> *solver) override {
+    typedef Belos::MultiVecTraits<SCALAR, MV> MVT;
+    auto const iteration = solver->getNumIters();
+    if(iteration == iteration_)
+      return Belos::Failed;
+    auto const &problem = solver->getProblem();
+    std::vector<t_real> norms(MVT::GetNumberVecs(*problem.getRHS()));
+    MVT::MvNorm(*problem.getRHS(), norms);
+    auto const scale = *std::max_element(norms.begin(), norms.end());
+    if(history_->empty() and problem.getInitResVec() != Teuchos::null) {
+      norms.resize(MVT::GetNumberVecs(*problem.getInitResVec()));
+      MVT::MvNorm(*problem.getInitResVec(), norms);
+      history_->push_back(*std::max_element(norms.begin(), norms.end()) / scale);
+    }
+    norms.clear();
+    solver->getNativeResiduals(&norms);
+    if(norms.size() > 0)
+      history_->push_back(*std::max_element(norms.begin(), norms.end()) / scale);
+    iteration_ = iteration;
+    return Belos::Failed;
+  }
+  Belos::StatusType getStatus() const override { return Belos::Failed; }
+  void reset() override { iteration_ = -1; }
+  void print(std::ostream &stream, int indent = 0) const override {
+    stream << std::string(indent, ' ') << "Residual history: " << history_->size()
+           << " iterations recorded\n";
+  }
+
+private:
+  //! Where to record the residuals, shared since managers may outlive a solve
+  std::shared_ptr<std::vector<t_real>> history_;
+  //! Last iteration recorded
+  int iteration_;
+};
+
+//! \brief Attaches a residual history to the manager, if it accepts user-defined tests
+//! \details The history fills up as the manager solves. It stays empty if the manager does not
+//! accept user-defined tests.
+template <class SCALAR, class MV, class OP>
+std::shared_ptr<std::vector<t_real>>
+monitor_residuals(Belos::SolverManager<SCALAR, MV, OP> &solver) {
+  typedef Belos::StatusTestCombo<SCALAR, MV, OP> Combo;
+  auto const history = std::make_shared<std::vector<t_real>>();
+  try {
+    solver.setUserConvTest(Teuchos::rcp(new ResidualHistory<SCALAR, MV, OP>(history)), Combo::OR);
+  } catch(std::logic_error const &) {
+  }
+  return history;
+}
+}
+#endif
+#endif
@@ -120,13 +120,17 @@ void Result::getEHFieldsModal(Spherical<double> R_, SphericalP<std::complex<doub
       // Source fields
       for(size_t j = 0; j < geometry->objects.size(); j++) {
         Rrel = Tools::toPoint(R_, geometry->objects[j].vR);
+        // scatterers with a smaller nMax have fewer source coefficients
+        int const pObject = p.max(geometry->objects[j].nMax);
+        if(static_cast<int>(p) >= pObject)
+          continue;
         optimet::AuxCoefficients aCoef(Rrel, waveK, 0, nMax);
 
         Einc =
             Einc +
             aCoef.M(static_cast<long>(p)) * geometry->objects[j].sourceCoef[static_cast<int>(p)] +
             aCoef.N(static_cast<long>(p)) *
-                geometry->objects[j].sourceCoef[static_cast<int>(p) + p.max(nMax)];
+                geometry->objects[j].sourceCoef[static_cast<int>(p) + pObject];
       }
     }
 
@@ -232,26 +236,23 @@ void Result::getEHFieldsModal(Spherical<double> R_, SphericalP<std::complex<doub
 
 void Result::getEHFields(Spherical<double> R_, SphericalP<std::complex<double>> &EField_,
                          SphericalP<std::complex<double>> &HField_, bool projection_) const {
-  SphericalP<std::complex<double>> Efield = SphericalP<std::complex<double>>(
-      std::complex<double>(0.0, 0.0), std::complex<double>(0.0, 0.0),
-      std::complex<double>(0.0, 0.0));
-  SphericalP<std::complex<double>> Einc = SphericalP<std::complex<double>>(
-      std::complex<double>(0.0, 0.0), std::complex<double>(0.0, 0.0),
-      std::complex<double>(0.0, 0.0));
-  SphericalP<std::complex<double>> Hfield = SphericalP<std::complex<double>>(
-      std::complex<double>(0.0, 0.0), std::complex<double>(0.0, 0.0),
-      std::complex<double>(0.0, 0.0));
-  SphericalP<std::complex<double>> Hinc = SphericalP<std::complex<double>>(
-      std::complex<double>(0.0, 0.0), std::complex<double>(0.0, 0.0),
-      std::complex<double>(0.0, 0.0));
+  AuxCoefficientsWorkspace workspace(nMax);
+  getEHFields(R_, EField_, HField_, projection_, workspace);
+}
+
+void Result::getEHFields(Spherical<double> R_, SphericalP<std::complex<double>> &EField_,
+                         SphericalP<std::complex<double>> &HField_, bool projection_,
+                         AuxCoefficientsWorkspace &workspace) const {
+  typedef Eigen::Matrix<t_complex, 3, 1> Field;
+  Field Einc = Field::Zero(), Hinc = Field::Zero();
+  Field Efield = Field::Zero(), Hfield = Field::Zero();
 
   Spherical<double> Rrel;
 
   std::complex<double> iZ = (consCmi / sqrt(geometry->bground.mu / geometry->bground.epsilon));
 
-  int pMax = Tools::iteratorMax(nMax);
-
-  CompoundIterator p;
+  t_uint const pMax = Tools::iteratorMax(nMax);
+  workspace.nMax(nMax);
 
   // Check for inner point and set to 0
   int intInd = geometry->checkInner(R_);
@@ -262,87 +263,61 @@ void Result::getEHFields(Spherical<double> R_, SphericalP<std::complex<double>>
                 // field
     {
       // Incoming field
-      optimet::AuxCoefficients aCoefInc(R_, waveK, 1, nMax);
-      for(p = 0; p < p.max(nMax); p++) {
-        Einc = Einc + (aCoefInc.M(static_cast<long>(p)) * excitation->dataIncAp[p] +
-                       aCoefInc.N(static_cast<long>(p)) * excitation->dataIncBp[p]);
-        Hinc = Hinc +
-               (aCoefInc.N(static_cast<long>(p)) * excitation->dataIncAp[p] +
-                aCoefInc.M(static_cast<long>(p)) * excitation->dataIncBp[p]) *
-                   iZ;
-      }
+      workspace.compute(R_, waveK, 1);
+      auto const &Ap = excitation->dataIncAp;
+      auto const &Bp = excitation->dataIncBp;
+      Einc = workspace.M() * Ap + workspace.N() * Bp;
+      Hinc = (workspace.N() * Ap + workspace.M() * Bp) * iZ;
     } else // this a second harmonic frequency result - calculate the source
            // fields (save it in Einc for convenience)
     {
       // Source fields
       for(size_t j = 0; j < geometry->objects.size(); j++) {
         Rrel = Tools::toPoint(R_, geometry->objects[j].vR);
-        optimet::AuxCoefficients aCoef(Rrel, waveK, 0, nMax);
-
-        for(p = 0; p < pMax; p++) {
-          Einc =
-              Einc +
-              aCoef.M(static_cast<long>(p)) * geometry->objects[j].sourceCoef[static_cast<int>(p)] +
-              aCoef.N(static_cast<long>(p)) *
-                  geometry->objects[j].sourceCoef[static_cast<int>(p) + pMax];
-        }
+        workspace.compute(Rrel, waveK, 0);
+        // scatterers with a smaller nMax have fewer source coefficients
+        t_uint const pObject = Tools::iteratorMax(geometry->objects[j].nMax);
+        Eigen::Map<const Vector<t_complex>> const source(geometry->objects[j].sourceCoef.data(),
+                                                         2 * pObject);
+        Einc += workspace.M().leftCols(pObject) * source.head(pObject) +
+                workspace.N().leftCols(pObject) * source.tail(pObject);
       }
     }
 
     // Scattered field
     for(size_t j = 0; j < geometry->objects.size(); j++) {
-      SphericalP<std::complex<double>> Efield_local = SphericalP<std::complex<double>>(
-          std::complex<double>(0.0, 0.0), std::complex<double>(0.0, 0.0),
-          std::complex<double>(0.0, 0.0));
-
       Rrel = Tools::toPoint(R_, geometry->objects[j].vR);
-      optimet::AuxCoefficients aCoef(Rrel, waveK, 0, nMax);
+      workspace.compute(Rrel, waveK, 0);
 
-      for(p = 0; p < p.max(nMax); p++) {
-        Efield = Efield + aCoef.M(static_cast<long>(p)) * scatter_coef[j * 2 * pMax + p.compound] +
-                 aCoef.N(static_cast<long>(p)) * scatter_coef[pMax + j * 2 * pMax + p.compound];
-        Hfield = Hfield +
-                 (aCoef.N(static_cast<long>(p)) * scatter_coef[j * 2 * pMax + p.compound] +
-                  aCoef.M(static_cast<long>(p)) * scatter_coef[pMax + j * 2 * pMax + p.compound]) *
-                     iZ;
-      }
+      auto const te = scatter_coef.segment(j * 2 * pMax, pMax);
+      auto const tm = scatter_coef.segment(pMax + j * 2 * pMax, pMax);
+      Efield += workspace.M() * te + workspace.N() * tm;
+      Hfield += (workspace.N() * te + workspace.M() * tm) * iZ;
     }
   } else // Inside a sphere
   {
     Rrel = Tools::toPoint(R_, geometry->objects[intInd].vR);
-    optimet::AuxCoefficients aCoef(Rrel, waveK * sqrt(geometry->objects[intInd].elmag.epsilon_r *
-                                                      geometry->objects[intInd].elmag.mu_r),
-                                   1, nMax);
+    workspace.compute(Rrel, waveK * sqrt(geometry->objects[intInd].elmag.epsilon_r *
+                                         geometry->objects[intInd].elmag.mu_r),
+                      1);
 
     std::complex<double> iZ_object = (consCmi / sqrt(geometry->objects[intInd].elmag.mu /
                                                      geometry->objects[intInd].elmag.epsilon));
 
-    for(p = 0; p < p.max(nMax); p++) {
-      Efield =
-          Efield +
-          (aCoef.M(static_cast<long>(p)) * internal_coef[intInd * 2 * pMax + p.compound] +
-           aCoef.N(static_cast<long>(p)) * internal_coef[pMax + intInd * 2 * pMax + p.compound]);
-      Hfield =
-          Hfield +
-          (aCoef.N(static_cast<long>(p)) * internal_coef[intInd * 2 * pMax + p.compound] +
-           aCoef.M(static_cast<long>(p)) * internal_coef[pMax + intInd * 2 * pMax + p.compound]) *
-              iZ_object;
-    }
+    auto const te = internal_coef.segment(intInd * 2 * pMax, pMax);
+    auto const tm = internal_coef.segment(pMax + intInd * 2 * pMax, pMax);
+    Efield = workspace.M() * te + workspace.N() * tm;
+    Hfield = (workspace.N() * te + workspace.M() * tm) * iZ_object;
   }
 
+  Field const E = Einc + Efield;
+  Field const H = Hinc + Hfield;
+  EField_ = SphericalP<t_complex>(E(0), E(1), E(2));
+  HField_ = SphericalP<t_complex>(H(0), H(1), H(2));
   if(projection_) {
-    SphericalP<std::complex<double>> SphEField;
-    SphericalP<std::complex<double>> SphHField;
     Rrel = Tools::toPoint(R_, geometry->objects[0].vR);
-
-    SphEField = Tools::fromProjection(Rrel, Einc + Efield);
-    SphHField = Tools::fromProjection(Rrel, Hinc + Hfield);
-
-    EField_ = SphEField;
-    HField_ = SphHField;
-  } else {
-    EField_ = Einc + Efield;
-    HField_ = Hinc + Hfield;
+    EField_ = Tools::fromProjection(Rrel, EField_);
+    HField_ = Tools::fromProjection(Rrel, HField_);
   }
 }
 
@@ -401,12 +376,14 @@ SphericalP<std::complex<double>> Result::getEFieldC(Spherical<double> R_, bool p
         Rrel = Tools::toPoint(R_, geometry->objects[j].vR);
         optimet::AuxCoefficients aCoef(Rrel, waveK, 0, nMax);
 
-        for(p = 0; p < pMax; p++) {
+        // scatterers with a smaller nMax have fewer source coefficients
+        int const pObject = p.max(geometry->objects[j].nMax);
+        for(p = 0; p < pObject; p++) {
           Einc =
               Einc +
               aCoef.M(static_cast<long>(p)) * geometry->objects[j].sourceCoef[static_cast<int>(p)] +
               aCoef.N(static_cast<long>(p)) *
-                  geometry->objects[j].sourceCoef[static_cast<int>(p) + pMax];
+                  geometry->objects[j].sourceCoef[static_cast<int>(p) + pObject];
         }
       }
 
@@ -496,6 +473,8 @@ double Result::getAbsorptionCrossSection() {
 
 int Result::setFields(OutputGrid &oEGrid_, OutputGrid &oHGrid_, bool projection_) {
   Spherical<double> Rloc;
+  // Reused across all grid points
+  AuxCoefficientsWorkspace workspace(nMax);
 
   // centerScattering();
 
@@ -509,7 +488,7 @@ int Result::setFields(OutputGrid &oEGrid_, OutputGrid &oHGrid_, bool projection_
     SphericalP<std::complex<double>> EField;
     SphericalP<std::complex<double>> HField;
 
-    getEHFields(Rloc, EField, HField, projection_);
+    getEHFields(Rloc, EField, HField, projection_, workspace);
 
     oHGrid_.pushDataNext(HField);
     oEGrid_.pushDataNext(EField);
@@ -665,12 +644,14 @@ void Result::getEHFieldsContCheck(Spherical<double> R_, SphericalP<std::complex<
         Rrel = Tools::toPoint(R_, geometry->objects[j].vR);
         optimet::AuxCoefficients aCoef(Rrel, waveK, 0, nMax);
 
-        for(p = 0; p < pMax; p++) {
+        // scatterers with a smaller nMax have fewer source coefficients
+        int const pObject = p.max(geometry->objects[j].nMax);
+        for(p = 0; p < pObject; p++) {
           Einc =
               Einc +
               aCoef.M(static_cast<long>(p)) * geometry->objects[j].sourceCoef[static_cast<int>(p)] +
               aCoef.N(static_cast<long>(p)) *
-                  geometry->objects[j].sourceCoef[static_cast<int>(p) + pMax];
+                  geometry->objects[j].sourceCoef[static_cast<int>(p) + pObject];
         }
       }
     }
@@ -17,6 +17,7 @@
 #ifndef RESULT_H_
 #define RESULT_H_
 
+#include "AuxCoefficients.h"
 #include "CompoundIterator.h"
 #include "Excitation.h"
 #include "Geometry.h"
@@ -117,6 +118,19 @@ public:
    */
   void getEHFields(Spherical<double> R_, SphericalP<std::complex<double>> &EField_,
                    SphericalP<std::complex<double>> &HField_, bool projection_) const;
+  /**
+   * Returns the E and H fields at a given point.
+   * Uses (and resizes if needed) the given workspace rather than allocating a new one, so that
+   * the same workspace can be used over many points.
+   * @param R_ the coordinates of the point.
+   * @param EField_ SphericalP vector that will store the E field.
+   * @param HField_ SphericalP vector that will store the H field.
+   * @param projection_ defines spherical (1) or cartesian (0) projection.
+   * @param workspace buffers for the vector spherical functions.
+   */
+  void getEHFields(Spherical<double> R_, SphericalP<std::complex<double>> &EField_,
+                   SphericalP<std::complex<double>> &HField_, bool projection_,
+                   AuxCoefficientsWorkspace &workspace) const;
   /**
    * Returns the E and H fields at a given point.
    * @param R_ the coordinates of the point.
@@ -20,6 +20,7 @@
 #include "CompoundIterator.h"
 #include "Excitation.h"
 #include "Geometry.h"
+#include "SolverParameters.h"
 #include "Types.h"
 #include "mpi/Communicator.h"
 #include "scalapack/Context.h"
@@ -49,6 +50,8 @@ public:
   std::shared_ptr<Excitation> excitation;
   //! Parameters needed to setup parallel computations
   scalapack::Parameters parallel_params;
+  //! Parameters controlling the solvers
+  solver::Parameters solver_params;
 #ifdef OPTIMET_BELOS
   Teuchos::RCP<Teuchos::ParameterList> belos_params;
 #endif
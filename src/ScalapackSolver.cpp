@@ -17,14 +17,28 @@
 #include "ScalapackSolver.h"
 #include "scalapack/BroadcastToOutOfContext.h"
 #include "scalapack/LinearSystemSolver.h"
+#include <iostream>
 
 namespace optimet {
 namespace solver {
 
+scalapack::Parameters Scalapack::tuned_parameters(Run const &run, scalapack::Workload workload) {
+  if(not run.parallel_params.autotune)
+    return run.parallel_params;
+  auto const N = run.geometry->scatterer_size();
+  auto const result = scalapack::autotune(N, workload, run.communicator, run.parallel_params);
+  if(run.solver_params.verbosity != 0 and run.communicator.is_root()) {
+    auto const name =
+        workload == scalapack::Workload::factorization ? "factorization" : "multiplication";
+    std::cout << "Tuned scalapack " << name << " for N=" << N << ": block " << result.block_size
+              << ", grid " << result.grid.rows << "x" << result.grid.cols << "\n";
+  }
+  return result;
+}
+
 std::tuple<scalapack::Matrix<t_complex>, scalapack::Matrix<t_complex>>
 Scalapack::parallel_input() const {
-  auto const nMax = geometry->nMax();
-  auto const N = 2 * nMax * (nMax + 2) * geometry->objects.size();
+  auto const N = geometry->scatterer_size();
   scalapack::Matrix<t_complex> Aparallel(context(), {N, N}, block_size());
   if(Aparallel.size() > 0)
     Aparallel.local() = S;
@@ -39,7 +53,11 @@ void Scalapack::solve(Vector<t_complex> &X_sca_, Vector<t_complex> &X_int_) cons
     auto input = parallel_input();
     // Now the actual work
     auto const gls_result =
-        scalapack::general_linear_system(std::get<0>(input), std::get<1>(input));
+        factorization() == Factorization::MIXED ?
+            scalapack::mixed_precision_linear_system(std::get<0>(input), std::get<1>(input),
+                                                     parameters().refinement_tolerance,
+                                                     parameters().refinement_iterations) :
+            scalapack::general_linear_system(std::get<0>(input), std::get<1>(input));
     if(std::get<1>(gls_result) != 0)
       throw std::runtime_error("Error encountered while solving the linear system");
     // Transfer back to root
@@ -53,6 +71,8 @@ void Scalapack::solve(Vector<t_complex> &X_sca_, Vector<t_complex> &X_int_) cons
 }
 
 void Scalapack::update() {
+  if(factorization() == Factorization::LDLT)
+    throw std::runtime_error("ScaLAPACK provides no complex-symmetric indefinite factorization");
   Q = distributed_source_vector(source_vector(*geometry, incWave), context(), block_size());
   S = preconditioned_scattering_matrix(*geometry, incWave, context(), block_size());
 }
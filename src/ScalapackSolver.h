@@ -24,25 +24,31 @@
 #include "PreconditionedMatrixSolver.h"
 #include "Solver.h"
 #include "scalapack/Context.h"
+#include "scalapack/Tuning.h"
 
 namespace optimet {
 namespace solver {
 
-//! Use an actual matrix, and Eigen's Householder QR method
+//! Use a distributed matrix, and Scalapack's LU or mixed-precision LU method
 class Scalapack : public PreconditionedMatrix {
 public:
   Scalapack(std::shared_ptr<Geometry> geometry, std::shared_ptr<Excitation const> incWave,
             mpi::Communicator const &comm = mpi::Communicator(),
             scalapack::Context const &context = scalapack::Context::Squarest(),
-            scalapack::Sizes const &block_size = scalapack::Sizes{64, 64})
-      : PreconditionedMatrix(geometry, incWave, comm), context_(context), block_size_(block_size) {
+            scalapack::Sizes const &block_size = scalapack::Sizes{64, 64},
+            Parameters const &parameters = Parameters())
+      : PreconditionedMatrix(geometry, incWave, comm, parameters), context_(context),
+        block_size_(block_size) {
     update();
   }
   Scalapack(Run const &run)
-      : Scalapack(run.geometry, run.excitation, run.communicator, run.context,
-                  {run.parallel_params.block_size, run.parallel_params.block_size}) {}
+      : Scalapack(run, tuned_parameters(run, scalapack::Workload::factorization)) {}
 
   void solve(Vector<t_complex> &X_sca_, Vector<t_complex> &X_int_) const override;
+  //! The distributed matrix only handles a single incident wave
+  void solve_waves(Matrix<t_complex> &X_sca_, Matrix<t_complex> &X_int_) const override {
+    AbstractSolver::solve_waves(X_sca_, X_int_);
+  }
   void update() override;
 
   //! Scalapack context used during computation
@@ -51,6 +57,15 @@ public:
   scalapack::Sizes const &block_size() const { return block_size_; }
 
 protected:
+  Scalapack(Run const &run, scalapack::Parameters const &parallel)
+      : Scalapack(run.geometry, run.excitation, run.communicator,
+                  parallel.autotune ? scalapack::Context(parallel.grid) : run.context,
+                  {parallel.block_size, parallel.block_size}, run.solver_params) {}
+
+  //! \brief Parallel parameters of the run, tuned for the given workload if requested
+  //! \details Returns run.parallel_params as is unless its autotune flag is set.
+  static scalapack::Parameters tuned_parameters(Run const &run, scalapack::Workload workload);
+
   //! Scalapack context to use during communication
   scalapack::Context context_;
   //! Block-sizes for scalapack
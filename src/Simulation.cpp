@@ -23,16 +23,76 @@
 #include "Result.h"
 #include "Run.h"
 #include "Solver.h"
+#include "Threads.h"
+#include "WarmStart.h"
 
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 
 namespace optimet {
+namespace {
+//! Solves for the coefficients, laid out with the same nMax for every scatterer
+void solve(solver::AbstractSolver const &solver, Run const &run, Result &result) {
+  solver.solve(result.scatter_coef, result.internal_coef);
+  if(solver.iterations() > 0 and solver.communicator().rank() == solver.communicator().root_id())
+    std::cout << "Solved in " << solver.iterations() << " iterations" << std::endl;
+  auto const nMax = run.geometry->nMax();
+  if(nMax == run.geometry->nMin())
+    return;
+  result.scatter_coef = uniform_coefficients(result.scatter_coef, nMax, run.geometry->objects);
+  result.internal_coef = uniform_coefficients(result.internal_coef, nMax, run.geometry->objects);
+}
+
+//! Absorption and extinction cross sections of each incident wave, solved for together
+std::pair<std::vector<t_real>, std::vector<t_real>>
+cross_sections(solver::AbstractSolver const &solver, Run const &run) {
+  Matrix<t_complex> scattered, internal;
+  solver.solve_waves(scattered, internal);
+  if(solver.iterations() > 0 and solver.communicator().rank() == solver.communicator().root_id())
+    std::cout << "Solved " << scattered.cols() << " incident waves in " << solver.iterations()
+              << " iterations" << std::endl;
+  std::pair<std::vector<t_real>, std::vector<t_real>> result;
+  for(t_uint i(0); i < run.excitation->nwaves(); ++i) {
+    Result wave(run.geometry, std::make_shared<Excitation>(run.excitation->wave(i)));
+    wave.scatter_coef =
+        uniform_coefficients(scattered.col(i), run.geometry->nMax(), run.geometry->objects);
+    wave.internal_coef =
+        uniform_coefficients(internal.col(i), run.geometry->nMax(), run.geometry->objects);
+    result.first.push_back(wave.getAbsorptionCrossSection());
+    result.second.push_back(wave.getExtinctionCrossSection());
+  }
+  return result;
+}
+
+//! Writes the cross sections of one scan step, one column per incident wave
+void write_cross_sections(std::ostream &absorption, std::ostream &extinction, t_real step,
+                          std::pair<std::vector<t_real>, std::vector<t_real>> const &sections) {
+  absorption << step;
+  extinction << step;
+  for(t_uint j(0); j < sections.first.size(); ++j) {
+    absorption << "\t" << sections.first[j];
+    extinction << "\t" << sections.second[j];
+  }
+  absorption << std::endl;
+  extinction << std::endl;
+}
+
+//! Refuses several incident waves for outputs that can only describe one
+void single_wave(Run const &run, std::string const &output) {
+  if(run.excitation->nwaves() > 1)
+    throw std::runtime_error(output + " output is only available for a single incident wave");
+}
+}
+
 int Simulation::run() {
 
   // Read the case file
   auto run = simulation_input(caseFile + ".xml");
+  dense_threads(run.solver_params.threads);
 #ifdef OPTIMET_MPI
   run.parallel_params.grid = scalapack::squarest_largest_grid(communicator().size());
   run.communicator = communicator();
@@ -66,9 +126,10 @@ int Simulation::run() {
 
 void Simulation::field_simulation(Run &run, std::shared_ptr<solver::AbstractSolver> solver) {
   // Determine the simulation type and proceed accordingly
+  single_wave(run, "Field");
 
   Result result(run.geometry, run.excitation);
-  solver->solve(result.scatter_coef, result.internal_coef);
+  solve(*solver, run, result);
 
   if(communicator().rank() == communicator().root_id()) {
     Output oFile(caseFile + ".h5");
@@ -97,11 +158,15 @@ void Simulation::field_simulation(Run &run, std::shared_ptr<solver::AbstractSolv
 }
 
 void Simulation::scan_wavelengths(Run &run, std::shared_ptr<solver::AbstractSolver> solver) {
-  std::ofstream outASec, outESec;
+  std::ofstream outASec, outESec, outConvergence;
 
   if(communicator().rank() == communicator().root_id()) {
     outASec.open(caseFile + "_AbsorptionCS.dat");
     outESec.open(caseFile + "_ExtinctionCS.dat");
+    if(run.solver_params.telemetry) {
+      outConvergence.open(caseFile + "_Convergence.dat");
+      solver::telemetry_header(outConvergence, {"lambda"});
+    }
   }
 
   // Now scan over the wavelengths given in params
@@ -114,6 +179,7 @@ void Simulation::scan_wavelengths(Run &run, std::shared_ptr<solver::AbstractSolv
 
   lams = (lamf - lami) / (steps - 1);
 
+  WarmStart warm_start(run.solver_params.warm_start);
   for(int i = 0; i < steps; i++) {
     lam = lami + i * lams;
 
@@ -123,27 +189,48 @@ void Simulation::scan_wavelengths(Run &run, std::shared_ptr<solver::AbstractSolv
     run.geometry->update(run.excitation);
     solver->update(run);
 
+    // one column per incident wave
+    if(run.excitation->nwaves() > 1) {
+      auto const sections = cross_sections(*solver, run);
+      if(communicator().rank() == communicator().root_id()) {
+        write_cross_sections(outASec, outESec, lam, sections);
+        if(outConvergence.is_open())
+          solver::write_telemetry(outConvergence, {lam}, solver->telemetry());
+      }
+      continue;
+    }
+
+    solver->initial_guess(warm_start.guess());
+
     Result result(run.geometry, run.excitation);
-    solver->solve(result.scatter_coef, result.internal_coef);
+    solve(*solver, run, result);
+    warm_start.push(solver->solution());
 
     if(communicator().rank() == communicator().root_id()) {
       outASec << lam << "\t" << result.getAbsorptionCrossSection() << std::endl;
       outESec << lam << "\t" << result.getExtinctionCrossSection() << std::endl;
+      if(outConvergence.is_open())
+        solver::write_telemetry(outConvergence, {lam}, solver->telemetry());
     }
   }
 
   if(communicator().rank() == communicator().root_id()) {
     outASec.close();
     outESec.close();
+    outConvergence.close();
   }
 }
 
 void Simulation::radius_scan(Run &run, std::shared_ptr<solver::AbstractSolver> solver) {
-  std::ofstream outASec, outESec;
+  std::ofstream outASec, outESec, outConvergence;
 
   if(communicator().rank() == communicator().root_id()) {
     outASec.open(caseFile + "_AbsorptionCS.dat");
     outESec.open(caseFile + "_ExtinctionCS.dat");
+    if(run.solver_params.telemetry) {
+      outConvergence.open(caseFile + "_Convergence.dat");
+      solver::telemetry_header(outConvergence, {"radius"});
+    }
   }
 
   // Now scan over the wavelengths given in params
@@ -156,6 +243,7 @@ void Simulation::radius_scan(Run &run, std::shared_ptr<solver::AbstractSolver> s
 
   rads = (radf - radi) / (radsteps - 1);
 
+  WarmStart warm_start(run.solver_params.warm_start);
   for(int i = 0; i < radsteps; i++) {
     rad = radi + i * rads;
 
@@ -176,29 +264,52 @@ void Simulation::radius_scan(Run &run, std::shared_ptr<solver::AbstractSolver> s
 
     solver->update(run);
 
+    // one column per incident wave
+    if(run.excitation->nwaves() > 1) {
+      auto const sections = cross_sections(*solver, run);
+      if(communicator().rank() == communicator().root_id()) {
+        write_cross_sections(outASec, outESec, rad, sections);
+        if(outConvergence.is_open())
+          solver::write_telemetry(outConvergence, {rad}, solver->telemetry());
+      }
+      continue;
+    }
+
+    solver->initial_guess(warm_start.guess());
+
     Result result(run.geometry, run.excitation);
-    solver->solve(result.scatter_coef, result.internal_coef);
+    solve(*solver, run, result);
+    warm_start.push(solver->solution());
 
     if(communicator().rank() == communicator().root_id()) {
       outASec << rad << "\t" << result.getAbsorptionCrossSection() << std::endl;
       outESec << rad << "\t" << result.getExtinctionCrossSection() << std::endl;
+      if(outConvergence.is_open())
+        solver::write_telemetry(outConvergence, {rad}, solver->telemetry());
     }
   }
 
   if(communicator().rank() == communicator().root_id()) {
     outASec.close();
     outESec.close();
+    outConvergence.close();
   }
 }
 
 void Simulation::radius_and_wavelength_scan(Run &run,
                                             std::shared_ptr<solver::AbstractSolver> solver) {
-  std::ofstream outASec, outESec, outParams;
+  // cells of the radius-wavelength grid hold a single cross section
+  single_wave(run, "Radius and wavelength scan");
+  std::ofstream outASec, outESec, outParams, outConvergence;
 
   if(communicator().rank() == communicator().root_id()) {
     outASec.open(caseFile + "_AbsorptionCS.dat");
     outESec.open(caseFile + "_ExtinctionCS.dat");
     outParams.open(caseFile + "_RadiusLambda.dat");
+    if(run.solver_params.telemetry) {
+      outConvergence.open(caseFile + "_Convergence.dat");
+      solver::telemetry_header(outConvergence, {"lambda", "radius"});
+    }
   }
 
   // Now scan over the wavelengths given in params
@@ -215,9 +326,12 @@ void Simulation::radius_and_wavelength_scan(Run &run,
   lams = (lamf - lami) / (lamsteps - 1);
   rads = (radf - radi) / (radsteps - 1);
 
+  WarmStart warm_start(run.solver_params.warm_start);
   for(int i = 0; i < lamsteps; i++) {
     lam = lami + i * lams;
 
+    // the radius jumps back to its initial value
+    warm_start.reset();
     for(int j = 0; j < radsteps; j++) {
       rad = radi + j * rads;
 
@@ -239,15 +353,19 @@ void Simulation::radius_and_wavelength_scan(Run &run,
       }
 
       solver->update(run);
+      solver->initial_guess(warm_start.guess());
 
       Result result(run.geometry, run.excitation);
-      solver->solve(result.scatter_coef, result.internal_coef);
+      solve(*solver, run, result);
+      warm_start.push(solver->solution());
 
       if(communicator().rank() == communicator().root_id()) {
         outASec << result.getAbsorptionCrossSection() << "\t";
         outESec << result.getExtinctionCrossSection() << "\t";
         outParams << "(" << rad * 1e9 << " , " << lam * 1e9 << ")"
                   << "\t";
+        if(outConvergence.is_open())
+          solver::write_telemetry(outConvergence, {lam, rad}, solver->telemetry());
       }
     }
 
@@ -262,14 +380,16 @@ void Simulation::radius_and_wavelength_scan(Run &run,
     outASec.close();
     outESec.close();
     outParams.close();
+    outConvergence.close();
   }
 }
 
 void Simulation::coefficients(Run &run, std::shared_ptr<solver::AbstractSolver> solver) {
   // Scattering coefficients requests
+  single_wave(run, "Coefficients");
 
   Result result(run.geometry, run.excitation);
-  solver->solve(result.scatter_coef, result.internal_coef);
+  solve(*solver, run, result);
 
   if(communicator().rank() == communicator().root_id()) {
     std::ofstream outPCoef(caseFile + "_pCoefficients.dat");
@@ -18,7 +18,11 @@
 
 #include "ElectroMagnetic.h"
 #include "FMMBelosSolver.h"
+#include "FMMKrylovSolver.h"
+#include "HierarchicalMatrixSolver.h"
 #include "MatrixBelosSolver.h"
+#include "OrderOfScatteringSolver.h"
+#include "OutOfCoreSolver.h"
 #include "PreconditionedMatrixSolver.h"
 #include "ScalapackSolver.h"
 #include "Scatterer.h"
@@ -27,7 +31,44 @@
 
 namespace optimet {
 namespace solver {
+namespace {
+//! \brief Refuses to run a serial solver over several processes
+//! \details Each process would otherwise repeat the whole solve on its own.
+void serial_only(Run const &run) {
+  if(run.communicator.size() > 1)
+    throw std::runtime_error("Solver method " + run.solver_params.method +
+                             " is serial and cannot run over several processes");
+}
+}
+
+void AbstractSolver::solve_waves(Matrix<t_complex> &X_sca_, Matrix<t_complex> &X_int_) const {
+  if(incWave->nwaves() != 1)
+    throw std::runtime_error("Solver does not handle several incident waves");
+  Vector<t_complex> scattered, internal;
+  solve(scattered, internal);
+  X_sca_ = scattered;
+  X_int_ = internal;
+}
+
 std::shared_ptr<AbstractSolver> factory(Run const &run) {
+  if(run.solver_params.method == "out-of-core") {
+    serial_only(run);
+    return std::make_shared<OutOfCore>(run);
+  }
+  if(run.solver_params.method == "hmatrix") {
+    serial_only(run);
+    return std::make_shared<HierarchicalMatrix>(run);
+  }
+  if(run.solver_params.method == "fmm") {
+    serial_only(run);
+    return std::make_shared<FMMKrylov>(run);
+  }
+  if(run.solver_params.method == "order-of-scattering") {
+    serial_only(run);
+    return std::make_shared<OrderOfScattering>(run);
+  }
+  if(run.solver_params.method != "dense")
+    throw std::runtime_error("Unknown solver method " + run.solver_params.method);
 #ifndef OPTIMET_MPI
   return std::make_shared<PreconditionedMatrix>(run);
 #elif defined(OPTIMET_SCALAPACK) && !defined(OPTIMET_BELOS)
@@ -72,6 +113,22 @@ Vector<t_complex> convertInternal(Vector<t_complex> const &scattered, t_real con
   return result;
 }
 
+Vector<t_complex> uniform_coefficients(Vector<t_complex> const &coefficients, t_uint nMax,
+                                       std::vector<Scatterer> const &objects) {
+  auto const N = 2 * nMax * (nMax + 2);
+  Vector<t_complex> result = Vector<t_complex>::Zero(N * objects.size());
+  size_t i(0), j(0);
+  for(auto const &object : objects) {
+    // TE and TM halves are padded separately
+    auto const n = object.nMax * (object.nMax + 2);
+    result.segment(j, n) = coefficients.segment(i, n);
+    result.segment(j + N / 2, n) = coefficients.segment(i + n, n);
+    i += 2 * n;
+    j += N;
+  }
+  return result;
+}
+
 Vector<t_complex> convertIndirect(Vector<t_complex> const &scattered, t_real const &omega,
                                   ElectroMagnetic const &bground,
                                   std::vector<Scatterer> const &objects) {
@@ -22,6 +22,7 @@
 #include "Geometry.h"
 #include "Result.h"
 #include "Run.h"
+#include "Telemetry.h"
 #include "Types.h"
 #include "mpi/Collectives.h"
 #include "mpi/Communicator.h"
@@ -43,6 +44,11 @@ Vector<t_complex> convertIndirect(Vector<t_complex> const &scattered, t_real con
 //! Computes coeffs internal to spheres
 Vector<t_complex> convertInternal(Vector<t_complex> const &scattered, t_real const &omega,
                                   ElectroMagnetic const &bground, std::vector<Scatterer> const &);
+//! \brief Pads the coefficients of each scatterer with zeros, up to the same nMax
+//! \details Solvers truncate each scatterer at its own nMax, whereas results expect all
+//! scatterers to share the same nMax.
+Vector<t_complex> uniform_coefficients(Vector<t_complex> const &coefficients, t_uint nMax,
+                                       std::vector<Scatterer> const &);
 namespace solver {
 
 //! Abstract base class for all solvers
@@ -69,6 +75,13 @@ public:
    * @return 0 if successful, 1 otherwise.
    */
   virtual void solve(Vector<t_complex> &X_sca_, Vector<t_complex> &X_int_) const = 0;
+  /**
+   * Solves for each incident plane wave of the excitation.
+   * By default, only excitations with a single wave are handled.
+   * @param X_sca_ the return matrix for the scattered coefficients, one column per wave.
+   * @param X_int_ the return matrix for the internal coefficients, one column per wave.
+   */
+  virtual void solve_waves(Matrix<t_complex> &X_sca_, Matrix<t_complex> &X_int_) const;
   /**
    * Update method for the Solver class.
    * @param geometry_ the geometry of the simulation.
@@ -100,17 +113,40 @@ public:
 
   //! Number of spherical harmonics in expansion
   t_uint scattering_size() const {
-    auto const n = nMax == 0 ? geometry->nMax() : nMax;
-    return 2 * n * (n + 2) * geometry->objects.size();
+    if(nMax == 0)
+      return geometry->scatterer_size();
+    return 2 * nMax * (nMax + 2) * geometry->objects.size();
   }
 
   mpi::Communicator const &communicator() const { return communicator_; }
 
+  //! \brief Initial guess for the next solve of iterative solvers
+  //! \details Same layout as solution(). Direct solvers ignore it. Iterative solvers start from
+  //! zero if it is empty or of the wrong size.
+  void initial_guess(Vector<t_complex> const &guess) { initial_guess_ = guess; }
+  //! Initial guess for the next solve of iterative solvers
+  Vector<t_complex> const &initial_guess() const { return initial_guess_; }
+  //! \brief Solution of the preconditioned system from the last solve, for all scatterers
+  //! \details Before conversion to scattered coefficients. Only set by iterative solvers.
+  Vector<t_complex> const &solution() const { return solution_; }
+  //! Number of iterations of the last solve, zero for direct solvers
+  virtual t_uint iterations() const { return 0; }
+  //! \brief Convergence and timings of each iterative solve of the last call to solve
+  //! \details One record per incident wave, or a single one for block methods. Empty for direct
+  //! solvers.
+  std::vector<Telemetry> const &telemetry() const { return telemetry_; }
+
 protected:
   std::shared_ptr<Geometry> geometry;        /**< Pointer to the geometry. */
   std::shared_ptr<Excitation const> incWave; /**< Pointer to the incoming excitation. */
   mpi::Communicator communicator_;
   t_uint nMax;
+  //! Initial guess for the next solve of iterative solvers
+  Vector<t_complex> initial_guess_;
+  //! Solution of the preconditioned system from the last solve
+  mutable Vector<t_complex> solution_;
+  //! Convergence and timings of the last solve
+  mutable std::vector<Telemetry> telemetry_;
 };
 
 //! A factory function for solvers
@@ -0,0 +1,136 @@
+// (C) University College London 2017
+// This file is part of Optimet, licensed under the terms of the GNU Public License
+//
+// Optimet is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Optimet is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Optimet. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef OPTIMET_SOLVER_PARAMETERS_H
+#define OPTIMET_SOLVER_PARAMETERS_H
+
+#include "Types.h"
+#include <stdexcept>
+#include <string>
+
+namespace optimet {
+namespace solver {
+//! \brief Factorizations available to the dense solvers
+//! \details MIXED is a single precision LU followed by iterative refinement in double precision.
+//! LDLT is a Bunch-Kaufman factorization of the complex-symmetric form of the scattering matrix.
+enum class Factorization { LU, QR, MIXED, LDLT };
+
+//! Parameters controlling the solvers, independently of Belos
+struct Parameters {
+  //! \brief Solution method
+  //! \details "dense" for the in-memory matrix, "out-of-core" for the file-backed tiled LU,
+  //! "hmatrix" for the hierarchically compressed matrix, "fmm" for the serial matrix-free Krylov
+  //! solver, "order-of-scattering" for the Foldy-Lax series.
+  std::string method;
+  //! Factorization of the dense scattering matrix
+  Factorization factorization;
+  //! Relative residual at which mixed-precision refinement stops
+  t_real refinement_tolerance;
+  //! Maximum number of mixed-precision refinement steps
+  t_uint refinement_iterations;
+  //! Approximate number of rows and columns in out-of-core tiles
+  t_uint tile_size;
+  //! Maximum number of out-of-core tiles held in memory
+  t_uint cache_tiles;
+  //! Directory where out-of-core tiles are stored
+  std::string scratch;
+  //! Relative accuracy of the low-rank blocks of the hierarchical matrix
+  t_real compression_tolerance;
+  //! Maximum number of unknowns in the dense leaves of the hierarchical matrix
+  t_uint leaf_size;
+  //! Threads for dense linear algebra, or zero to keep the defaults
+  t_uint threads;
+  //! \brief Serial Krylov method, as Belos' "Solver"
+  //! \details "GMRES", "GCRODR", "BiCGStab", "TFQMR", or "s-step GMRES".
+  std::string krylov;
+  //! Relative residual at which the Krylov solver stops, as Belos' "Convergence Tolerance"
+  t_real tolerance;
+  //! Maximum number of Krylov iterations, as Belos' "Maximum Iterations"
+  t_uint max_iterations;
+  //! Dimension of the Krylov space before GMRES restarts, as Belos' "Num Blocks"
+  t_uint restart;
+  //! Prints a convergence summary when non-zero, as Belos' "Verbosity"
+  t_int verbosity;
+  //! Preconditioner of the FMM Krylov solvers, "none", "block-jacobi" or "p-multigrid"
+  std::string preconditioner;
+  //! Maximum number of unknowns in a block of the block-Jacobi preconditioner
+  t_uint preconditioner_size;
+  //! Largest order of the harmonics in the coarse level of the p-multigrid preconditioner
+  t_uint coarse_nmax;
+  //! Smoothing steps with the fine operator in the p-multigrid preconditioner
+  t_uint smoothing_steps;
+  //! \brief Previous steps of a scan from which iterative solvers start
+  //! \details 0 starts from zero, 1 from the previous solution, 2 and 3 from a linear and
+  //! quadratic extrapolation.
+  t_uint warm_start;
+  //! Vectors recycled across restarts and solves by GCRODR, as Belos' "Num Recycled Blocks"
+  t_uint recycle;
+  //! \brief Relative change of the operator beyond which the recycled space is discarded
+  //! \details The change is estimated on update from a single random probe vector.
+  t_real recycle_threshold;
+  //! \brief Cheaper approximations of the FMM operator used by inexact GMRES, or zero for none
+  //! \details Each level halves the range of the couplings kept from the previous one.
+  t_uint inexact_levels;
+  //! Maximum number of orders of the Foldy-Lax series before falling back to Krylov
+  t_uint scattering_orders;
+  //! Coupling operator of the Foldy-Lax series, "fmm" or "dense"
+  std::string series_operator;
+  //! Iterations between two synchronizations of "s-step GMRES"
+  t_uint sstep;
+  //! \brief Writes the convergence and timings of each iterative solve of a scan
+  //! \details Also makes the distributed solvers compute the true residual of their solution.
+  bool telemetry;
+
+  Parameters(Factorization factorization = Factorization::LU, t_real refinement_tolerance = 1e-10,
+             t_uint refinement_iterations = 10)
+      : method("dense"), factorization(factorization),
+        refinement_tolerance(refinement_tolerance), refinement_iterations(refinement_iterations),
+        tile_size(512), cache_tiles(64), scratch("."), compression_tolerance(1e-8),
+        leaf_size(256), threads(0), krylov("GMRES"), tolerance(1e-8), max_iterations(1000),
+        restart(50), verbosity(0), preconditioner("none"), preconditioner_size(512),
+        coarse_nmax(2), smoothing_steps(1), warm_start(0), recycle(10), recycle_threshold(0.1),
+        inexact_levels(0), scattering_orders(50), series_operator("fmm"),
+        sstep(5), telemetry(false) {}
+};
+
+//! Converts input string to a factorization
+inline Factorization factorization(std::string const &name) {
+  if(name == "lu" or name == "LU")
+    return Factorization::LU;
+  if(name == "qr" or name == "QR")
+    return Factorization::QR;
+  if(name == "mixed" or name == "MIXED")
+    return Factorization::MIXED;
+  if(name == "ldlt" or name == "LDLT")
+    return Factorization::LDLT;
+  throw std::runtime_error("Unknown factorization " + name);
+}
+
+//! Converts input string to a number of previous steps for warm starts
+inline t_uint warm_start(std::string const &name) {
+  if(name == "none" or name == "0")
+    return 0;
+  if(name == "previous" or name == "1")
+    return 1;
+  if(name == "linear" or name == "2")
+    return 2;
+  if(name == "quadratic" or name == "3")
+    return 3;
+  throw std::runtime_error("Unknown warm start " + name);
+}
+} // solver
+} // optimet
+#endif
@@ -22,6 +22,10 @@
 #include "CompoundIterator.h"
 #include "gsl/gsl_sf_coupling.h"
 
+#include <map>
+#include <mutex>
+#include <tuple>
+
 namespace optimet {
 namespace symbol {
 
@@ -46,8 +50,34 @@ double CleGor(int j, int m, int j1, int m1, int j2, int m2) {
          Wigner3j(j1, j2, j, m1, m2, -m);
 }
 
+//! \brief Lazily filled table of geometry-independent coupling symbols
+//! \details Values are shared across particles and wavelengths. Access is thread-safe, so that
+//! sources for different particles can be computed concurrently.
+template <class... INDICES> class SymbolTable {
+public:
+  typedef std::tuple<INDICES...> Index;
+
+  //! Returns cached value, or computes it with the functor and caches it
+  template <class FUNCTOR> double operator()(Index const &index, FUNCTOR const &functor) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto const found = cache.find(index);
+      if(found != cache.end())
+        return found->second;
+    }
+    auto const value = functor();
+    std::lock_guard<std::mutex> lock(mutex);
+    cache.emplace(index, value);
+    return value;
+  }
+
+private:
+  std::map<Index, double> cache;
+  std::mutex mutex;
+};
+
 // C numbers
-double C_01m1(int J1, int M1, int J2, int M2, int J, int M) {
+double compute_C_01m1(int J1, int M1, int J2, int M2, int J, int M) {
   return std::sqrt(3.0 / 2.0 / consPi) * CleGor(J, M, J1, M1, J2, M2) *
          (std::sqrt((J1 + 1.0) * J2 * (2.0 * J1 - 1.0) * (2.0 * J2 - 1.0)) *
               Wigner9j(J1, J1 - 1, 1, J2, J2 - 1, 1, J, J, 1) *
@@ -64,7 +94,7 @@ double C_01m1(int J1, int M1, int J2, int M2, int J, int M) {
               CleGor(J, 0, J1 + 1, 0, J2 + 1, 0));
 }
 
-double C_10m1(int J1, int M1, int J2, int M2, int J, int M) {
+double compute_C_10m1(int J1, int M1, int J2, int M2, int J, int M) {
   return std::sqrt(3.0 / 2.0 / consPi) * (2.0 * J1 + 1.0) *
          CleGor(J, M, J1, M1, J2, M2) *
          (std::sqrt(J2 * (2.0 * J1 - 1.0)) *
@@ -85,7 +115,7 @@ double C_10m1(int J1, int M1, int J2, int M2, int J, int M) {
               std::sqrt((J + 1) / (2.0 * J + 1.0)));
 }
 
-double C_00m1(int J1, int M1, int J2, int M2, int J, int M) {
+double compute_C_00m1(int J1, int M1, int J2, int M2, int J, int M) {
   return std::sqrt(3.0 / 2.0 / consPi) * (2.0 * J1 + 1.0) *
          CleGor(J, M, J1, M1, J2, M2) *
          (std::sqrt(J2 * (2.0 * J1 - 1.0)) *
@@ -96,7 +126,7 @@ double C_00m1(int J1, int M1, int J2, int M2, int J, int M) {
               CleGor(J + 1, 0, J1, 0, J2 + 1, 0));
 }
 
-double C_11m1(int J1, int M1, int J2, int M2, int J, int M) {
+double compute_C_11m1(int J1, int M1, int J2, int M2, int J, int M) {
   return std::sqrt(3.0 / 2.0 / consPi) * CleGor(J, M, J1, M1, J2, M2) *
          (std::sqrt((J1 + 1.0) * J2 * (2.0 * J1 - 1.0) * (2.0 * J2 - 1.0)) *
               Wigner9j(J1, J1 - 1, 1, J2, J2 - 1, 1, J, J + 1, 1) *
@@ -161,7 +191,7 @@ std::complex<double> A_m1(int n, double R, const std::complex<double> &waveK_i,
          (1.0 / waveK_i / R) * data[n] * dmn_1;
 }
 
-double W(int L1, int J1, int M1, int L2, int J2, int M2, int L, int M) {
+double compute_W(int L1, int J1, int M1, int L2, int J2, int M2, int L, int M) {
   return std::pow(-1.0, J2 + L1 + L) *
          std::sqrt((2.0 * J1 + 1.0) * (2.0 * J2 + 1.0) * (2.0 * L1 + 1.0) *
                    (2.0 * L2 + 1.0) / (4 / consPi / (2.0 * L + 1))) *
@@ -169,6 +199,48 @@ double W(int L1, int J1, int M1, int L2, int J2, int M2, int L, int M) {
          CleGor(L, M, J1, M1, J2, M2);
 }
 
+// The symbols below all include a factor CleGor(L, M, J1, M1, J2, M2), which is zero unless M =
+// M1 + M2. Hence M is not needed in the cache index.
+double C_01m1(int J1, int M1, int J2, int M2, int J, int M) {
+  static SymbolTable<int, int, int, int, int> table;
+  if(M != M1 + M2)
+    return 0;
+  return table(std::make_tuple(J1, M1, J2, M2, J),
+               [=]() { return compute_C_01m1(J1, M1, J2, M2, J, M); });
+}
+
+double C_10m1(int J1, int M1, int J2, int M2, int J, int M) {
+  static SymbolTable<int, int, int, int, int> table;
+  if(M != M1 + M2)
+    return 0;
+  return table(std::make_tuple(J1, M1, J2, M2, J),
+               [=]() { return compute_C_10m1(J1, M1, J2, M2, J, M); });
+}
+
+double C_00m1(int J1, int M1, int J2, int M2, int J, int M) {
+  static SymbolTable<int, int, int, int, int> table;
+  if(M != M1 + M2)
+    return 0;
+  return table(std::make_tuple(J1, M1, J2, M2, J),
+               [=]() { return compute_C_00m1(J1, M1, J2, M2, J, M); });
+}
+
+double C_11m1(int J1, int M1, int J2, int M2, int J, int M) {
+  static SymbolTable<int, int, int, int, int> table;
+  if(M != M1 + M2)
+    return 0;
+  return table(std::make_tuple(J1, M1, J2, M2, J),
+               [=]() { return compute_C_11m1(J1, M1, J2, M2, J, M); });
+}
+
+double W(int L1, int J1, int M1, int L2, int J2, int M2, int L, int M) {
+  static SymbolTable<int, int, int, int, int, int, int> table;
+  if(M != M1 + M2)
+    return 0;
+  return table(std::make_tuple(L1, J1, M1, L2, J2, M2, L),
+               [=]() { return compute_W(L1, J1, M1, L2, J2, M2, L, M); });
+}
+
 } // namespace
 
 // In what follows, need to devise CompoundIterator to start from n=0.
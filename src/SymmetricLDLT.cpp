@@ -0,0 +1,180 @@
+// (C) University College London 2017
+// This file is part of Optimet, licensed under the terms of the GNU Public License
+//
+// Optimet is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Optimet is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Optimet. If not, see <http://www.gnu.org/licenses/>.
+
+#include "SymmetricLDLT.h"
+#include <cmath>
+
+namespace optimet {
+
+PackedLower PackedLower::lower_triangle(Matrix<t_complex> const &A) {
+  if(A.rows() != A.cols())
+    throw std::runtime_error("Matrix should be square");
+  PackedLower result(A.rows());
+  for(t_int j = 0; j < A.cols(); ++j)
+    result.column(j) = A.col(j).tail(A.rows() - j);
+  return result;
+}
+
+Matrix<t_complex> PackedLower::unpack() const {
+  Matrix<t_complex> result = Matrix<t_complex>::Zero(n_, n_);
+  for(t_int j = 0; j < n_; ++j)
+    result.col(j).tail(n_ - j) = column(j);
+  return result;
+}
+
+SymmetricLDLT &SymmetricLDLT::compute(Matrix<t_complex> const &A) {
+  return compute(PackedLower::lower_triangle(A));
+}
+
+SymmetricLDLT &SymmetricLDLT::compute(PackedLower &&A) {
+  factors_ = std::move(A);
+  auto &a = factors_;
+  t_int const n = a.rows();
+  pivots_.resize(n);
+  is_2x2_.assign(n, false);
+  info_ = 0;
+
+  // Bunch-Kaufman growth bound
+  t_real const alpha = (1e0 + std::sqrt(17e0)) / 8e0;
+  t_int k = 0;
+  while(k < n) {
+    t_int kstep = 1, kp = k;
+    t_real const absakk = std::abs(a(k, k));
+    t_int imax = k;
+    t_real const colmax =
+        k + 1 < n ? a.column(k).tail(n - k - 1).cwiseAbs().maxCoeff(&imax) : 0e0;
+    imax += k + 1;
+    if(std::max(absakk, colmax) == 0e0) {
+      if(info_ == 0)
+        info_ = k + 1;
+    } else if(absakk < alpha * colmax) {
+      // largest off-diagonal element in row imax of the trailing matrix
+      t_real rowmax = 0e0;
+      for(t_int j = k; j < imax; ++j)
+        rowmax = std::max(rowmax, std::abs(a(imax, j)));
+      if(imax + 1 < n)
+        rowmax = std::max(rowmax, a.column(imax).tail(n - imax - 1).cwiseAbs().maxCoeff());
+      if(absakk * rowmax < alpha * colmax * colmax)
+        kp = imax, kstep = std::abs(a(imax, imax)) >= alpha * rowmax ? 1 : 2;
+    }
+
+    // interchange rows and columns kk and kp of the trailing matrix
+    auto const kk = k + kstep - 1;
+    if(kp != kk) {
+      if(kp + 1 < n)
+        a.column(kk).tail(n - kp - 1).swap(a.column(kp).tail(n - kp - 1));
+      for(t_int j = kk + 1; j < kp; ++j)
+        std::swap(a(j, kk), a(kp, j));
+      std::swap(a(kk, kk), a(kp, kp));
+      if(kstep == 2)
+        std::swap(a(k + 1, k), a(kp, k));
+    }
+
+    // update of the lower triangle of the trailing matrix, one packed column at a time
+    t_int const m = n - k - kstep;
+    if(kstep == 1) {
+      pivots_[k] = kp;
+      if(m > 0 and a(k, k) != 0e0) {
+        auto const d11 = 1e0 / a(k, k);
+        Vector<t_complex> const x = a.column(k).tail(m);
+        for(t_int j = 0; j < m; ++j)
+          a.column(k + 1 + j) -= (d11 * x(j)) * x.tail(m - j);
+        a.column(k).tail(m) *= d11;
+      }
+    } else {
+      pivots_[k] = pivots_[k + 1] = kp;
+      is_2x2_[k] = true;
+      if(m > 0) {
+        auto const d21 = a(k + 1, k);
+        auto const d11 = a(k + 1, k + 1) / d21;
+        auto const d22 = a(k, k) / d21;
+        auto const t = 1e0 / (d11 * d22 - 1e0);
+        Matrix<t_complex> X(m, 2);
+        X << a.column(k).tail(m), a.column(k + 1).tail(m);
+        Matrix<t_complex> W(m, 2);
+        W.col(0) = (t / d21) * (d11 * X.col(0) - X.col(1));
+        W.col(1) = (t / d21) * (d22 * X.col(1) - X.col(0));
+        for(t_int j = 0; j < m; ++j)
+          a.column(k + 2 + j) -= X.bottomRows(m - j) * W.row(j).transpose();
+        a.column(k).tail(m) = W.col(0);
+        a.column(k + 1).tail(m) = W.col(1);
+      }
+    }
+    k += kstep;
+  }
+  return *this;
+}
+
+Matrix<t_complex> SymmetricLDLT::solve(Matrix<t_complex> const &B) const {
+  auto const &a = factors_;
+  t_int const n = a.rows();
+  if(B.rows() != n)
+    throw std::runtime_error("Right-hand-side does not match factorized matrix");
+  Matrix<t_complex> X = B;
+
+  // Solve L D Y = P B
+  t_int k = 0;
+  while(k < n) {
+    if(not is_2x2_[k]) {
+      if(pivots_[k] != static_cast<t_uint>(k))
+        X.row(k).swap(X.row(pivots_[k]));
+      if(k + 1 < n)
+        X.bottomRows(n - k - 1) -= a.column(k).tail(n - k - 1) * X.row(k);
+      X.row(k) /= a(k, k);
+      k += 1;
+    } else {
+      if(pivots_[k] != static_cast<t_uint>(k + 1))
+        X.row(k + 1).swap(X.row(pivots_[k]));
+      if(k + 2 < n) {
+        X.bottomRows(n - k - 2) -= a.column(k).tail(n - k - 2) * X.row(k);
+        X.bottomRows(n - k - 2) -= a.column(k + 1).tail(n - k - 2) * X.row(k + 1);
+      }
+      auto const akm1k = a(k + 1, k);
+      auto const akm1 = a(k, k) / akm1k;
+      auto const ak = a(k + 1, k + 1) / akm1k;
+      auto const denom = akm1 * ak - 1e0;
+      for(t_int j = 0; j < X.cols(); ++j) {
+        auto const bkm1 = X(k, j) / akm1k;
+        auto const bk = X(k + 1, j) / akm1k;
+        X(k, j) = (ak * bkm1 - bk) / denom;
+        X(k + 1, j) = (akm1 * bk - bkm1) / denom;
+      }
+      k += 2;
+    }
+  }
+
+  // Solve L^T P^T X = Y
+  k = n - 1;
+  while(k >= 0) {
+    if(k == 0 or not is_2x2_[k - 1]) {
+      if(k + 1 < n)
+        X.row(k) -= a.column(k).tail(n - k - 1).transpose() * X.bottomRows(n - k - 1);
+      if(pivots_[k] != static_cast<t_uint>(k))
+        X.row(k).swap(X.row(pivots_[k]));
+      k -= 1;
+    } else {
+      if(k + 1 < n) {
+        X.row(k) -= a.column(k).tail(n - k - 1).transpose() * X.bottomRows(n - k - 1);
+        X.row(k - 1) -= a.column(k - 1).tail(n - k - 1).transpose() * X.bottomRows(n - k - 1);
+      }
+      if(pivots_[k] != static_cast<t_uint>(k))
+        X.row(k).swap(X.row(pivots_[k]));
+      k -= 2;
+    }
+  }
+  return X;
+}
+}
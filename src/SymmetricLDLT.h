@@ -0,0 +1,97 @@
+// (C) University College London 2017
+// This file is part of Optimet, licensed under the terms of the GNU Public License
+//
+// Optimet is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Optimet is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Optimet. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef OPTIMET_SYMMETRIC_LDLT_H
+#define OPTIMET_SYMMETRIC_LDLT_H
+
+#include "Types.h"
+#include <vector>
+
+namespace optimet {
+//! \brief Lower triangle of a symmetric matrix, packed column by column
+//! \details Same layout as LAPACK's packed storage with uplo = 'L': column j holds rows j to n - 1,
+//! contiguously. Only n (n + 1) / 2 elements are stored.
+class PackedLower {
+public:
+  PackedLower(t_int n = 0) : n_(n), data_(n * (n + 1) / 2) {}
+  //! Packs the lower triangle of a square matrix
+  static PackedLower lower_triangle(Matrix<t_complex> const &A);
+
+  t_int rows() const { return n_; }
+  t_int cols() const { return n_; }
+  //! Element (i, j), with i >= j
+  t_complex &operator()(t_int i, t_int j) { return data_(index(i, j)); }
+  //! Element (i, j), with i >= j
+  t_complex const &operator()(t_int i, t_int j) const { return data_(index(i, j)); }
+  //! Rows j to n - 1 of column j
+  Eigen::VectorBlock<Vector<t_complex>> column(t_int j) {
+    return data_.segment(index(j, j), n_ - j);
+  }
+  //! Rows j to n - 1 of column j
+  Eigen::VectorBlock<Vector<t_complex> const> column(t_int j) const {
+    return data_.segment(index(j, j), n_ - j);
+  }
+  //! Unpacks to a square matrix, with the strictly upper triangle set to zero
+  Matrix<t_complex> unpack() const;
+
+protected:
+  //! Size of the matrix
+  t_int n_;
+  //! Packed elements
+  Vector<t_complex> data_;
+
+  t_int index(t_int i, t_int j) const { return i + j * (2 * n_ - j - 1) / 2; }
+};
+
+//! \brief Bunch-Kaufman LDL^T factorization of a complex-symmetric matrix
+//! \details The matrix is symmetric, not hermitian: A = A^T. Only the lower triangle of the input
+//! is referenced. D is block-diagonal with 1x1 and 2x2 blocks, and L is unit lower triangular,
+//! with the same pivoting strategy as LAPACK's zsptrf. The factors are kept in packed storage.
+class SymmetricLDLT {
+public:
+  SymmetricLDLT() : info_(0) {}
+  //! Factorizes the lower triangle of the input matrix
+  SymmetricLDLT(Matrix<t_complex> const &A) : SymmetricLDLT() { compute(A); }
+  //! Factorizes the packed lower triangle of the input matrix
+  SymmetricLDLT(PackedLower A) : SymmetricLDLT() { compute(std::move(A)); }
+
+  //! Factorizes the lower triangle of the input matrix
+  SymmetricLDLT &compute(Matrix<t_complex> const &A);
+  //! Factorizes the packed lower triangle of the input matrix, reusing its memory
+  SymmetricLDLT &compute(PackedLower &&A);
+
+  //! Solves A X = B
+  Matrix<t_complex> solve(Matrix<t_complex> const &B) const;
+
+  //! \brief Zero if successful
+  //! \details If positive, D(info - 1, info - 1) is exactly zero and the matrix is singular.
+  t_uint info() const { return info_; }
+  //! Factors L and D, in the packed lower triangle
+  PackedLower const &factors() const { return factors_; }
+
+protected:
+  //! Factors L and D
+  PackedLower factors_;
+  //! \brief Row interchanged with k at step k
+  //! \details For 2x2 pivots, the pivot of the second row is stored for both rows.
+  std::vector<t_uint> pivots_;
+  //! Whether the pivot at k is the start of a 2x2 block
+  std::vector<bool> is_2x2_;
+  //! Status of last factorization
+  t_uint info_;
+};
+}
+#endif
@@ -0,0 +1,70 @@
+// (C) University College London 2017
+// This file is part of Optimet, licensed under the terms of the GNU Public License
+//
+// Optimet is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Optimet is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Optimet. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "Telemetry.h"
+#include <algorithm>
+
+namespace optimet {
+namespace solver {
+void Telemetry::finish(krylov::Convergence const &convergence, t_real seconds) {
+  iterations = convergence.iterations;
+  converged = convergence.converged;
+  residuals = convergence.history;
+  true_residual = convergence.residual;
+  total = seconds;
+  orthogonalization = std::max(0e0, total - apply - preconditioner);
+}
+
+t_real seconds_since(TelemetryClock::time_point const &start) {
+  return std::chrono::duration<t_real>(TelemetryClock::now() - start).count();
+}
+
+krylov::Operator timed(krylov::Operator const &op, t_real &seconds) {
+  if(not op)
+    return op;
+  return [op, &seconds](Vector<t_complex> const &in, Vector<t_complex> &out) {
+    auto const start = TelemetryClock::now();
+    op(in, out);
+    seconds += seconds_since(start);
+  };
+}
+
+void telemetry_header(std::ostream &stream, std::vector<std::string> const &parameters) {
+  stream << "#";
+  for(auto const &parameter : parameters)
+    stream << " " << parameter << "\t";
+  stream << "solve\tmethod\titerations\tconverged\ttotal\tapply\tpreconditioner"
+            "\torthogonalization\ttrue_residual\tresiduals\n";
+}
+
+void write_telemetry(std::ostream &stream, std::vector<t_real> const &parameters,
+                     std::vector<Telemetry> const &records) {
+  for(std::size_t i(0); i < records.size(); ++i) {
+    auto const &record = records[i];
+    for(auto const parameter : parameters)
+      stream << parameter << "\t";
+    stream << i << "\t" << record.method << "\t" << record.iterations << "\t" << record.converged
+           << "\t" << record.total << "\t" << record.apply << "\t" << record.preconditioner
+           << "\t" << record.orthogonalization << "\t" << record.true_residual << "\t";
+    for(std::size_t j(0); j < record.residuals.size(); ++j)
+      stream << (j == 0 ? "" : ",") << record.residuals[j];
+    stream << "\n";
+  }
+  stream.flush();
+}
+}
+}
@@ -0,0 +1,83 @@
+// (C) University College London 2017
+// This file is part of Optimet, licensed under the terms of the GNU Public License
+//
+// Optimet is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Optimet is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Optimet. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef OPTIMET_TELEMETRY_H
+#define OPTIMET_TELEMETRY_H
+
+#include "Krylov.h"
+#include "Types.h"
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace optimet {
+namespace solver {
+//! \brief Convergence and timings of a single iterative solve
+//! \details Times are in seconds, on the calling process. Those a solver cannot separate are
+//! left at zero, and counted in the total only.
+struct Telemetry {
+  //! Iterative method
+  std::string method;
+  //! Number of iterations
+  t_uint iterations;
+  //! Whether the solve reached the tolerance
+  bool converged;
+  //! Relative residual before the first iteration and after each one, as estimated by the method
+  std::vector<t_real> residuals;
+  //! Time spent in the whole solve
+  t_real total;
+  //! Time spent applying the operator
+  t_real apply;
+  //! Time spent applying the preconditioner
+  t_real preconditioner;
+  //! Time spent elsewhere in the iterations, mostly orthogonalizing the Krylov basis
+  t_real orthogonalization;
+  //! \brief Relative residual ||b - A x|| / ||b|| of the solution, computed explicitly
+  //! \details Zero if not computed. The distributed solvers only compute it when the telemetry
+  //! parameter is set, since it costs an extra product with the matrix.
+  t_real true_residual;
+
+  Telemetry(std::string const &method = "")
+      : method(method), iterations(0), converged(false), total(0), apply(0), preconditioner(0),
+        orthogonalization(0), true_residual(0) {}
+
+  //! \brief Sets convergence and total time of a native Krylov solve
+  //! \details The final residual of the native methods is computed explicitly.
+  void finish(krylov::Convergence const &convergence, t_real seconds);
+};
+
+//! Clock used for the telemetry
+typedef std::chrono::steady_clock TelemetryClock;
+//! Seconds elapsed since start
+t_real seconds_since(TelemetryClock::time_point const &start);
+//! \brief Wraps an operator so that its applications add to seconds
+//! \details Returns an empty operator if op is empty.
+krylov::Operator timed(krylov::Operator const &op, t_real &seconds);
+
+//! \brief Writes the names of the columns of the telemetry file, as a comment line
+//! \param[in] parameters: names of the parameters of each scan step
+void telemetry_header(std::ostream &stream, std::vector<std::string> const &parameters);
+//! \brief Writes one line per solve of a scan step
+//! \details Columns are tab-separated. They start with the parameters of the scan step and the
+//! index of the solve within the step. The last column lists the residual history, separated by
+//! commas.
+void write_telemetry(std::ostream &stream, std::vector<t_real> const &parameters,
+                     std::vector<Telemetry> const &records);
+}
+}
+#endif
@@ -0,0 +1,47 @@
+// (C) University College London 2017
+// This file is part of Optimet, licensed under the terms of the GNU Public License
+//
+// Optimet is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Optimet is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Optimet. If not, see <http://www.gnu.org/licenses/>.
+
+#include "Threads.h"
+#include <Eigen/Core>
+#ifdef OPTIMET_OPENMP
+#include <omp.h>
+#endif
+
+// Thread controls of the optimized BLAS libraries, resolved to null if not linked in
+extern "C" {
+void openblas_set_num_threads(int) __attribute__((weak));
+void bli_thread_set_num_threads(long) __attribute__((weak));
+void MKL_Set_Num_Threads(int) __attribute__((weak));
+}
+
+namespace optimet {
+void dense_threads(t_uint n) {
+  if(n == 0)
+    return;
+#ifdef OPTIMET_OPENMP
+  omp_set_num_threads(n);
+#endif
+  Eigen::setNbThreads(n);
+  if(openblas_set_num_threads)
+    openblas_set_num_threads(n);
+  if(bli_thread_set_num_threads)
+    bli_thread_set_num_threads(n);
+  if(MKL_Set_Num_Threads)
+    MKL_Set_Num_Threads(n);
+}
+
+t_uint dense_threads() { return Eigen::nbThreads(); }
+}
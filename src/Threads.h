@@ -0,0 +1,50 @@
+// (C) University College London 2017
+// This file is part of Optimet, licensed under the terms of the GNU Public License
+//
+// Optimet is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Optimet is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Optimet. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef OPTIMET_THREADS_H
+#define OPTIMET_THREADS_H
+
+#include "Types.h"
+#include <exception>
+
+namespace optimet {
+//! \brief Sets the number of threads used by dense linear algebra
+//! \details Applies to OpenMP, to Eigen's products, and to the optimized BLAS when it is
+//! OpenBLAS, BLIS, or MKL. Zero leaves the current settings untouched.
+void dense_threads(t_uint n);
+//! Number of threads used by Eigen's dense products
+t_uint dense_threads();
+
+//! \brief Calls body(i) for each i in [0, n), over the OpenMP threads
+//! \details Iterations are scheduled dynamically. An exception escaping an OpenMP region would
+//! terminate the program, so the first one thrown is rethrown once the loop is done.
+template <class BODY> void parallel_for(t_int n, BODY const &body) {
+  std::exception_ptr error;
+#pragma omp parallel for schedule(dynamic)
+  for(t_int i = 0; i < n; ++i) {
+    try {
+      body(i);
+    } catch(...) {
+#pragma omp critical(optimet_parallel_for)
+      if(not error)
+        error = std::current_exception();
+    }
+  }
+  if(error)
+    std::rethrow_exception(error);
+}
+}
+#endif
@@ -0,0 +1,190 @@
+// (C) University College London 2017
+// This file is part of Optimet, licensed under the terms of the GNU Public License
+//
+// Optimet is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Optimet is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Optimet. If not, see <http://www.gnu.org/licenses/>.
+
+#include "TileStore.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+namespace optimet {
+namespace {
+//! Wall-clock time in seconds
+t_real now() {
+  return std::chrono::duration<t_real>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+//! Tiles of the same size, except possibly the last
+std::vector<t_uint> uniform_boundaries(t_uint N, t_uint tile_size) {
+  std::vector<t_uint> result(1, 0);
+  while(result.back() < N)
+    result.push_back(std::min(N, result.back() + std::max<t_uint>(1, tile_size)));
+  return result;
+}
+
+//! Creates a unique file in the given directory
+std::string unique_file(std::string const &directory) {
+  std::string path = directory + "/optimet_tiles_XXXXXX";
+  auto const fd = mkstemp(&path[0]);
+  if(fd == -1)
+    throw std::runtime_error("Could not create tile file in " + directory);
+  close(fd);
+  return path;
+}
+}
+
+TileStore::TileStore(t_uint N, t_uint tile_size, t_uint cache_size, std::string const &directory)
+    : TileStore(uniform_boundaries(N, tile_size), cache_size, directory) {}
+
+TileStore::TileStore(std::vector<t_uint> const &boundaries, t_uint cache_size,
+                     std::string const &directory)
+    : boundaries_(boundaries), cache_size_(cache_size), path_(unique_file(directory)),
+      io_time_(0), bytes_read_(0), bytes_written_(0) {
+  if(boundaries_.size() == 0 or boundaries_.front() != 0 or
+     not std::is_sorted(boundaries_.begin(), boundaries_.end()))
+    throw std::runtime_error("Tile boundaries should be increasing and start at zero");
+  file_.open(path_, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+  if(not file_)
+    throw std::runtime_error("Could not open tile file " + path_);
+}
+
+TileStore::~TileStore() {
+  for(auto &pending : pending_)
+    pending.second.wait();
+  file_.close();
+  std::remove(path_.c_str());
+}
+
+std::streamoff TileStore::offset(t_uint I, t_uint J) const {
+  // panels before column J, then tiles above row I in panel J
+  return (static_cast<std::streamoff>(start(J)) * rows() +
+          static_cast<std::streamoff>(start(I)) * width(J)) *
+         static_cast<std::streamoff>(sizeof(t_complex));
+}
+
+Matrix<t_complex> TileStore::read(t_uint I, t_uint J) {
+  Matrix<t_complex> result(width(I), width(J));
+  std::lock_guard<std::mutex> lock(file_mutex_);
+  file_.seekg(offset(I, J));
+  file_.read(reinterpret_cast<char *>(result.data()), result.size() * sizeof(t_complex));
+  if(not file_)
+    throw std::runtime_error("Could not read tile from " + path_);
+  bytes_read_ += result.size() * sizeof(t_complex);
+  return result;
+}
+
+void TileStore::write(t_uint I, t_uint J, Matrix<t_complex> const &tile) {
+  std::lock_guard<std::mutex> lock(file_mutex_);
+  file_.seekp(offset(I, J));
+  file_.write(reinterpret_cast<char const *>(tile.data()), tile.size() * sizeof(t_complex));
+  if(not file_)
+    throw std::runtime_error("Could not write tile to " + path_);
+  bytes_written_ += tile.size() * sizeof(t_complex);
+}
+
+void TileStore::cache(Key const &key, Matrix<t_complex> const &tile) {
+  if(cache_size_ == 0)
+    return;
+  auto const found = cached_.find(key);
+  if(found != cached_.end()) {
+    found->second->second = tile;
+    cache_.splice(cache_.begin(), cache_, found->second);
+    return;
+  }
+  while(cache_.size() >= cache_size_) {
+    cached_.erase(cache_.back().first);
+    cache_.pop_back();
+  }
+  cache_.emplace_front(key, tile);
+  cached_[key] = cache_.begin();
+}
+
+Matrix<t_complex> TileStore::tile(t_uint I, t_uint J) {
+  Key const key(I, J);
+  auto const found = cached_.find(key);
+  if(found != cached_.end()) {
+    cache_.splice(cache_.begin(), cache_, found->second);
+    return found->second->second;
+  }
+  auto const start = now();
+  auto const pending = pending_.find(key);
+  Matrix<t_complex> result;
+  if(pending != pending_.end()) {
+    result = pending->second.get();
+    pending_.erase(pending);
+  } else
+    result = read(I, J);
+  io_time_ += now() - start;
+  cache(key, result);
+  return result;
+}
+
+Matrix<t_complex> TileStore::panel(t_uint J) {
+  Matrix<t_complex> result(rows(), width(J));
+  for(t_uint I(0); I < tiles(); ++I)
+    result.middleRows(start(I), width(I)) = tile(I, J);
+  return result;
+}
+
+void TileStore::panel(t_uint J, Matrix<t_complex> const &input) {
+  if(static_cast<t_uint>(input.rows()) != rows() or static_cast<t_uint>(input.cols()) != width(J))
+    throw std::runtime_error("Panel does not match tile store");
+  auto const start_time = now();
+  for(t_uint I(0); I < tiles(); ++I) {
+    Key const key(I, J);
+    // stale background reads are discarded
+    auto const pending = pending_.find(key);
+    if(pending != pending_.end()) {
+      pending->second.wait();
+      pending_.erase(pending);
+    }
+    Matrix<t_complex> const tile = input.middleRows(start(I), width(I));
+    write(I, J, tile);
+    cache(key, tile);
+  }
+  io_time_ += now() - start_time;
+}
+
+void TileStore::prefetch(t_uint J) {
+  if(J >= tiles())
+    return;
+  // a single background thread reads all missing tiles of the panel, in order
+  auto promises =
+      std::make_shared<std::vector<std::pair<t_uint, std::promise<Matrix<t_complex>>>>>();
+  for(t_uint I(0); I < tiles(); ++I) {
+    Key const key(I, J);
+    if(cached_.count(key) > 0 or pending_.count(key) > 0)
+      continue;
+    promises->emplace_back(I, std::promise<Matrix<t_complex>>());
+    pending_[key] = promises->back().second.get_future().share();
+  }
+  if(promises->size() == 0)
+    return;
+  std::thread([this, promises, J]() {
+    for(auto &promise : *promises)
+      try {
+        promise.second.set_value(read(promise.first, J));
+      } catch(...) {
+        promise.second.set_exception(std::current_exception());
+      }
+  }).detach();
+}
+}
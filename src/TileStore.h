@@ -0,0 +1,119 @@
+// (C) University College London 2017
+// This file is part of Optimet, licensed under the terms of the GNU Public License
+//
+// Optimet is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Optimet is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Optimet. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef OPTIMET_TILE_STORE_H
+#define OPTIMET_TILE_STORE_H
+
+#include "Types.h"
+#include <atomic>
+#include <fstream>
+#include <future>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace optimet {
+//! \brief File-backed storage of a square matrix, cut into tiles
+//! \details Rows and columns are cut at the same boundaries, so that diagonal tiles are square.
+//! Tiles are stored column-major on disk, so that a column of tiles (a panel) is
+//! contiguous. At most a given number of tiles is kept in memory, in a least-recently-used cache.
+//! Panels can be read asynchronously ahead of time.
+class TileStore {
+public:
+  //! Tile indices (row, column)
+  typedef std::pair<t_uint, t_uint> Key;
+
+  //! \brief Creates a store for an N by N matrix
+  //! \param[in] N: number of rows and columns of the matrix
+  //! \param[in] tile_size: number of rows and columns of each tile
+  //! \param[in] cache_size: maximum number of tiles kept in memory
+  //! \param[in] directory: where to create the backing file
+  TileStore(t_uint N, t_uint tile_size, t_uint cache_size, std::string const &directory = ".");
+  //! \brief Creates a store with tiles of varying sizes
+  //! \param[in] boundaries: first row of each tile, followed by the number of rows
+  //! \param[in] cache_size: maximum number of tiles kept in memory
+  //! \param[in] directory: where to create the backing file
+  TileStore(std::vector<t_uint> const &boundaries, t_uint cache_size,
+            std::string const &directory = ".");
+  TileStore(TileStore const &) = delete;
+  //! Removes the backing file
+  ~TileStore();
+
+  //! Number of rows and columns in the matrix
+  t_uint rows() const { return boundaries_.back(); }
+  //! Number of tiles in each row and column
+  t_uint tiles() const { return boundaries_.size() - 1; }
+  //! Width of a given tile row or column
+  t_uint width(t_uint I) const { return boundaries_[I + 1] - boundaries_[I]; }
+  //! First row or column of a given tile
+  t_uint start(t_uint I) const { return boundaries_[I]; }
+  //! Path to the backing file
+  std::string const &path() const { return path_; }
+
+  //! Reads a single tile
+  Matrix<t_complex> tile(t_uint I, t_uint J);
+  //! Reads all tiles in a given column
+  Matrix<t_complex> panel(t_uint J);
+  //! Writes all tiles in a given column
+  void panel(t_uint J, Matrix<t_complex> const &input);
+  //! Starts reading a column of tiles in the background
+  void prefetch(t_uint J);
+
+  //! Seconds spent reading, writing, or waiting for tiles
+  t_real io_time() const { return io_time_; }
+  //! Number of bytes read from disk
+  t_uint bytes_read() const { return bytes_read_; }
+  //! Number of bytes written to disk
+  t_uint bytes_written() const { return bytes_written_; }
+
+protected:
+  //! First row of each tile, followed by the number of rows
+  std::vector<t_uint> boundaries_;
+  //! Maximum number of tiles in memory
+  t_uint cache_size_;
+  //! Path to backing file
+  std::string path_;
+  //! Backing file
+  std::fstream file_;
+  //! Serializes access to the file
+  std::mutex file_mutex_;
+  //! Tiles in memory, most recently used first
+  std::list<std::pair<Key, Matrix<t_complex>>> cache_;
+  //! Position of each tile in the cache
+  std::map<Key, decltype(cache_)::iterator> cached_;
+  //! Tiles being read in the background
+  std::map<Key, std::shared_future<Matrix<t_complex>>> pending_;
+  //! Seconds spent reading, writing, or waiting for tiles
+  t_real io_time_;
+  //! Number of bytes read, possibly from a background thread
+  std::atomic<t_uint> bytes_read_;
+  //! Number of bytes written
+  std::atomic<t_uint> bytes_written_;
+
+  //! Offset of a tile in the backing file
+  std::streamoff offset(t_uint I, t_uint J) const;
+  //! Reads tile directly from disk
+  Matrix<t_complex> read(t_uint I, t_uint J);
+  //! Writes tile directly to disk
+  void write(t_uint I, t_uint J, Matrix<t_complex> const &tile);
+  //! Adds tile to cache, evicting least recently used tiles as needed
+  void cache(Key const &key, Matrix<t_complex> const &tile);
+};
+}
+#endif
@@ -23,6 +23,8 @@
 
 #cmakedefine OPTIMET_BELOS
 #cmakedefine OPTIMET_MPI
+#cmakedefine OPTIMET_OPENMP
+#cmakedefine OPTIMET_BLAS
 #ifdef OPTIMET_MPI
 #cmakedefine OPTIMET_SCALAPACK
 #endif
@@ -0,0 +1,67 @@
+// (C) University College London 2017
+// This file is part of Optimet, licensed under the terms of the GNU Public License
+//
+// Optimet is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Optimet is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Optimet. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef OPTIMET_WARM_START_H
+#define OPTIMET_WARM_START_H
+
+#include "Types.h"
+#include <deque>
+
+namespace optimet {
+//! \brief Predicts the solution at the next step of a scan from the previous steps
+//! \details Steps are assumed equally spaced. With one previous solution, it is the guess. With
+//! two or three, the guess is their linear or quadratic extrapolation.
+class WarmStart {
+public:
+  //! \param[in] order: number of previous solutions to extrapolate from, zero to disable
+  WarmStart(t_uint order = 1) : order_(order) {}
+
+  //! Adds the solution of the latest step, ignoring empty solutions
+  void push(Vector<t_complex> const &solution) {
+    if(order_ == 0 or solution.size() == 0)
+      return;
+    if(not history_.empty() and history_.back().size() != solution.size())
+      history_.clear();
+    history_.push_back(solution);
+    while(history_.size() > order_)
+      history_.pop_front();
+  }
+  //! Forgets previous steps, e.g. when the scan jumps
+  void reset() { history_.clear(); }
+
+  //! Guess for the next step, empty if there are no previous steps
+  Vector<t_complex> guess() const {
+    auto const n = history_.size();
+    if(n == 0)
+      return Vector<t_complex>::Zero(0);
+    if(n == 1)
+      return history_[0];
+    if(n == 2)
+      return 2e0 * history_[1] - history_[0];
+    return 3e0 * history_[2] - 3e0 * history_[1] + history_[0];
+  }
+
+  //! Number of previous solutions used in the extrapolation
+  t_uint order() const { return order_; }
+
+protected:
+  //! Number of previous solutions to extrapolate from
+  t_uint order_;
+  //! Previous solutions, oldest first
+  std::deque<Vector<t_complex>> history_;
+};
+} // namespace optimet
+#endif
@@ -109,6 +109,15 @@ public:
     MPI_Allreduce(&value, &result, 1, registered_type(value), operation, **this);
     return result;
   }
+  //! Reduces each coefficient of a matrix or vector, with a single call
+  template <class T>
+  typename std::enable_if<is_registered_type<typename T::Scalar>::value, T>::type
+  all_reduce(Eigen::PlainObjectBase<T> const &value, MPI_Op operation) const {
+    T result(value.rows(), value.cols());
+    MPI_Allreduce(value.data(), result.data(), value.size(), Type<typename T::Scalar>::value,
+                  operation, **this);
+    return result;
+  }
 
   void barrier() const { return optimet::mpi::barrier(*this); }
 
@@ -53,6 +53,75 @@ Vector<t_int> vector_distribution(t_int nscatterers, t_int nprocs) {
   return result;
 }
 
+Vector<t_real>
+scatterer_costs(std::vector<Scatterer> const &scatterers, Matrix<bool> const &locals) {
+  assert(locals.rows() == locals.cols());
+  assert(static_cast<std::size_t>(locals.rows()) == scatterers.size());
+  Vector<t_real> result = Vector<t_real>::Zero(scatterers.size());
+  for(t_uint i(0); i < locals.rows(); ++i)
+    for(t_uint j(0); j < locals.cols(); ++j) {
+      auto const nMax = static_cast<t_real>(std::max(scatterers[i].nMax, scatterers[j].nMax));
+      // local couplings are computed by the owner of the input, others by that of the output
+      result(locals(i, j) ? j : i) += nMax * nMax;
+    }
+  return result;
+}
+
+Vector<t_int> vector_distribution(Vector<t_real> const &costs, t_int nprocs) {
+  assert(nprocs > 0);
+  assert((costs.array() >= 0).all());
+  t_int const nscatterers = costs.size();
+  auto const N = std::min(nscatterers, nprocs);
+  if(N == 0)
+    return Vector<t_int>::Zero(0);
+  // number of contiguous ranges needed when no range may exceed the bottleneck
+  auto const nranges = [&costs, nscatterers](t_real bottleneck) {
+    t_int result = 1;
+    t_real load = 0;
+    for(t_int i(0), n(0); i < nscatterers; ++i, ++n) {
+      if(n > 0 and load + costs(i) > bottleneck) {
+        ++result;
+        load = 0;
+        n = 0;
+      }
+      load += costs(i);
+    }
+    return result;
+  };
+  // bisection over the bottleneck: the costliest process defines the time of the product
+  t_real lower = costs.maxCoeff(), upper = costs.sum();
+  for(t_uint i(0); i < 200 and upper - lower > 1e-12 * upper; ++i) {
+    auto const middle = 0.5 * (lower + upper);
+    (nranges(middle) <= N ? upper : lower) = middle;
+  }
+
+  // fills each process up to the bottleneck, leaving at least one scatterer per process
+  Vector<t_int> result(nscatterers);
+  t_real load = 0;
+  for(t_int i(0), n(0), rank(0); i < nscatterers; ++i, ++n) {
+    if(n > 0 and rank + 1 < N and
+       (load + costs(i) > upper or nscatterers - i <= N - 1 - rank)) {
+      ++rank;
+      load = 0;
+      n = 0;
+    }
+    load += costs(i);
+    result(i) = rank;
+  }
+  assert((result.array() < N).all());
+  return result;
+}
+
+Vector<t_real>
+process_costs(Vector<t_real> const &costs, Vector<t_int> const &distribution, t_int nprocs) {
+  assert(costs.size() == distribution.size());
+  assert(distribution.size() == 0 or distribution.maxCoeff() < nprocs);
+  Vector<t_real> result = Vector<t_real>::Zero(nprocs);
+  for(t_uint i(0); i < costs.size(); ++i)
+    result(distribution(i)) += costs(i);
+  return result;
+}
+
 std::vector<std::set<t_uint>>
 graph_edges(Matrix<bool> const &considered, Vector<t_int> const &vecdist) {
   assert(considered.rows() == considered.cols());
@@ -117,6 +186,38 @@ void FastMatrixMultiply::operator()(Vector<t_complex> const &input, Vector<t_com
   reduce_computation_.reduce(out, computation_buffer);
 }
 
+void FastMatrixMultiply::operator()(Matrix<t_complex> const &input, Matrix<t_complex> &out) const {
+  auto const n = input.cols();
+  std::vector<Vector<t_complex>> inputs(n), distribute_buffers(n), send_buffers(n),
+      computation_buffers(n);
+  std::vector<Request> distribute_requests, reduction_requests;
+  /************* START FIRST COMMUNICATION, ALL COLUMNS **********/
+  for(t_int i(0); i < n; ++i) {
+    inputs[i] = input.col(i);
+    distribute_requests.push_back(distribute_input_.send(inputs[i], distribute_buffers[i]));
+  }
+  /************* START SECOND COMMUNICATION, ALL COLUMNS **********/
+  for(t_int i(0); i < n; ++i) {
+    auto const local_input = reconstruct(local_indices_, inputs[i]);
+    auto const nl_computations = local_fmm_(local_input);
+    reduction_requests.push_back(reduce_computation_.send(nl_computations, send_buffers[i],
+                                                          computation_buffers[i]));
+  }
+
+  out.resize(input.rows(), n);
+  Vector<t_complex> column(input.rows());
+  for(t_int i(0); i < n; ++i) {
+    column.fill(0);
+    mpi::wait(std::move(distribute_requests[i]));
+    auto const nonlocal_input = distribute_input_.synthesize(distribute_buffers[i]);
+    auto const nl_out = nonlocal_fmm_(nonlocal_input);
+    reconstruct(nonlocal_indices_, nl_out, column);
+    mpi::wait(std::move(reduction_requests[i]));
+    reduce_computation_.reduce(column, computation_buffers[i]);
+    out.col(i) = column;
+  }
+}
+
 void FastMatrixMultiply::transpose(Vector<t_complex> const &input, Vector<t_complex> &out) const {
   out.fill(0);
   /************* START FIRST COMMUNICATION **********/
@@ -185,7 +286,10 @@ FastMatrixMultiply::FastMatrixMultiply(ElectroMagnetic const &em_background, t_r
                                   (vector_distribution.transpose().array() == comm.rank())
                                       .replicate(vector_distribution.size(), 1)),
       distribute_input_(distribute_comm, locals.array() == false, vector_distribution, scatterers),
-      reduce_computation_(reduce_comm, locals.array(), vector_distribution, scatterers) {
+      reduce_computation_(reduce_comm, locals.array(), vector_distribution, scatterers),
+      distribution_(vector_distribution),
+      loads_(details::process_costs(details::scatterer_costs(scatterers, locals),
+                                    vector_distribution, comm.size())) {
 
   auto const owned = vector_distribution.array() == comm.rank();
   auto const sizes = compute_sizes(scatterers);
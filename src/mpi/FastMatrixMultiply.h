@@ -40,6 +40,26 @@ inline Matrix<bool> local_interactions(t_int nscatterers) {
 };
 //! \brief Distribution of input/output vector
 Vector<t_int> vector_distribution(t_int nscatterers, t_int nprocs);
+//! \brief Estimated cost of the couplings each scatterer is responsible for
+//! \details A coupling costs the square of the larger nMax of the pair. Local couplings are
+//! charged to the scatterer providing the input, the others to the scatterer receiving the output,
+//! as they are computed by the processes owning those scatterers.
+Vector<t_real>
+scatterer_costs(std::vector<Scatterer> const &scatterers, Matrix<bool> const &locals);
+//! \brief Contiguous distribution of input/output vector balancing the cost of each process
+//! \details Minimizes the largest total cost over processes. Each process owns at least one
+//! scatterer, as long as there are enough. The costs can be estimates, as from scatterer_costs,
+//! or measured timings.
+Vector<t_int> vector_distribution(Vector<t_real> const &costs, t_int nprocs);
+//! Distribution balancing the estimated cost of the given couplings
+inline Vector<t_int> vector_distribution(std::vector<Scatterer> const &scatterers,
+                                         Matrix<bool> const &locals, t_int nprocs) {
+  return vector_distribution(scatterer_costs(scatterers, locals), nprocs);
+}
+//! \brief Total cost of each of nprocs processes
+//! \details Processes without scatterers have a zero cost.
+Vector<t_real>
+process_costs(Vector<t_real> const &costs, Vector<t_int> const &distribution, t_int nprocs);
 //! \brief Splits interactions into local and non-local processes
 inline Matrix<t_int> matrix_distribution(Matrix<bool> const &local, Vector<t_int> const &columns) {
   return local.select(columns.transpose().replicate(columns.size(), 1),
@@ -61,8 +81,9 @@ graph_edges(Matrix<bool> const &locals, Vector<t_int> const &vector_distribution
 //! outside this operation are the input/output vectors. The matrix/operation can be distributed as
 //! we best see fit.
 //!
-//! The vectors are distributed across procs homogeneously: each proc owns all the coefficients
-//! associated with a set of particles, contiguous in the array of input particles.
+//! Each proc owns all the coefficients associated with a set of particles, contiguous in the array
+//! of input particles. Unless given explicitly, the sets balance the estimated cost of the
+//! couplings computed by each proc, rather than the number of particles.
 //!
 //! To overlap calculations and communications, we perform several steps:
 //!
@@ -127,8 +148,8 @@ public:
   FastMatrixMultiply(ElectroMagnetic const &em_background, t_real wavenumber,
                      std::vector<Scatterer> const &scatterers, t_int diagonal,
                      Communicator const &comm = Communicator())
-      : FastMatrixMultiply(em_background, wavenumber, scatterers, diagonal,
-                           details::vector_distribution(scatterers.size(), comm.size()), comm) {}
+      : FastMatrixMultiply(em_background, wavenumber, scatterers,
+                           details::local_interactions(scatterers.size(), diagonal), comm) {}
   FastMatrixMultiply(t_real wavenumber, std::vector<Scatterer> const &scatterers, t_int diagonal,
                      Vector<t_int> const &vector_distribution,
                      Communicator const &comm = Communicator())
@@ -138,15 +159,13 @@ public:
                      std::vector<Scatterer> const &scatterers,
                      Communicator const &comm = Communicator())
       : FastMatrixMultiply(em_background, wavenumber, scatterers,
-                           details::local_interactions(scatterers.size()),
-                           details::vector_distribution(scatterers.size(), comm.size()), comm) {}
+                           details::local_interactions(scatterers.size()), comm) {}
   FastMatrixMultiply(t_real wavenumber, std::vector<Scatterer> const &scatterers,
                      Communicator const &comm = Communicator())
       : FastMatrixMultiply(ElectroMagnetic(), wavenumber, scatterers, comm) {}
   FastMatrixMultiply(t_real wavenumber, std::vector<Scatterer> const &scatterers, t_int diagonal,
                      Communicator const &comm = Communicator())
-      : FastMatrixMultiply(wavenumber, scatterers, diagonal,
-                           details::vector_distribution(scatterers.size(), comm.size()), comm) {}
+      : FastMatrixMultiply(ElectroMagnetic(), wavenumber, scatterers, diagonal, comm) {}
   FastMatrixMultiply(t_real wavenumber, std::vector<Scatterer> const &scatterers,
                      Matrix<bool> const &local_nonlocal, Vector<t_int> const &vector_distribution,
                      Communicator const &comm = Communicator())
@@ -154,8 +173,12 @@ public:
                            vector_distribution, comm) {}
   FastMatrixMultiply(t_real wavenumber, std::vector<Scatterer> const &scatterers,
                      Matrix<bool> const &local_nonlocal, Communicator const &comm = Communicator())
-      : FastMatrixMultiply(wavenumber, scatterers, local_nonlocal,
-                           details::vector_distribution(scatterers.size(), comm.size()), comm) {}
+      : FastMatrixMultiply(ElectroMagnetic(), wavenumber, scatterers, local_nonlocal, comm) {}
+  FastMatrixMultiply(ElectroMagnetic const &em_background, t_real wavenumber,
+                     std::vector<Scatterer> const &scatterers, Matrix<bool> const &locals,
+                     Communicator const &comm = Communicator())
+      : FastMatrixMultiply(em_background, wavenumber, scatterers, locals,
+                           details::vector_distribution(scatterers, locals, comm.size()), comm) {}
 
   //! \brief Applies fast matrix multiplication to effective incident field
   void operator()(Vector<t_complex> const &in, Vector<t_complex> &out) const;
@@ -163,6 +186,10 @@ public:
   Vector<t_complex> operator()(Vector<t_complex> const &in) const;
   //! \brief Applies fast matrix multiplication to effective incident field
   Vector<t_complex> operator*(Vector<t_complex> const &in) const { return operator()(in); }
+  //! \brief Applies fast matrix multiplication to several effective incident fields at once
+  //! \details Each column is a separate field. Communications for all columns are posted before
+  //! any computation, so that they overlap with the computations on the other columns.
+  void operator()(Matrix<t_complex> const &in, Matrix<t_complex> &out) const;
   //! \brief Applies transpose fast matrix multiplication to effective incident field
   void transpose(Vector<t_complex> const &in, Vector<t_complex> &out) const;
   //! \brief Applies transpose fast matrix multiplication to effective incident field
@@ -190,6 +217,14 @@ public:
   t_uint rows() const { return nonlocal_fmm_.rows(); }
   //! Local cols
   t_uint cols() const { return local_fmm_.cols(); }
+  //! Rank owning each scatterer
+  Vector<t_int> const &distribution() const { return distribution_; }
+  //! Estimated cost of the couplings computed by each process
+  Vector<t_real> const &loads() const { return loads_; }
+  //! Ratio of the largest to the mean estimated cost over processes
+  t_real imbalance() const {
+    return loads_.size() == 0 or loads_.sum() == 0 ? 1 : loads_.maxCoeff() / loads_.mean();
+  }
 
   //! Reconstructs output according to argument indices
   template <class T0, class T1>
@@ -288,6 +323,10 @@ private:
   std::vector<std::array<t_uint, 3>> nonlocal_indices_;
   //! Reconstruction indices for input to local_fmm_
   std::vector<std::array<t_uint, 3>> local_indices_;
+  //! Rank owning each scatterer
+  Vector<t_int> distribution_;
+  //! Estimated cost of the couplings computed by each process
+  Vector<t_real> loads_;
 
   //! End-point of the constructor chain
   FastMatrixMultiply(ElectroMagnetic const &em_background, t_real wavenumber,
@@ -47,6 +47,11 @@ void OPTIMET_FC_GLOBAL_(blacs_pcoord, BLACS_PCOORD)(int *context, int *pnum, int
       *ptrmynewblock, int ib, int jb, int *mb, int globcontext);                              \
   void OPTIMET_FC_GLOBAL(p ## letter ## gesv, P ## LETTER ## GESV)(int *n, int *nrhs,         \
       TYPE *a, int *ia, int *ja, int *desca, int *ipiv, TYPE *b, int *ib, int *jb,            \
+      int *descb, int *info);                                                                 \
+  void OPTIMET_FC_GLOBAL(p ## letter ## getrf, P ## LETTER ## GETRF)(int *m, int *n,          \
+      TYPE *a, int *ia, int *ja, int *desca, int *ipiv, int *info);                           \
+  void OPTIMET_FC_GLOBAL(p ## letter ## getrs, P ## LETTER ## GETRS)(char *trans, int *n,     \
+      int *nrhs, TYPE *a, int *ia, int *ja, int *desca, int *ipiv, TYPE *b, int *ib, int *jb, \
       int *descb, int *info);
 
 OPTIMET_MACRO(i, I, int);
@@ -56,6 +61,9 @@ OPTIMET_MACRO(c, C, std::complex<float>);
 OPTIMET_MACRO(z, Z, std::complex<double>);
 #undef OPTIMET_MACRO
 
+void OPTIMET_FC_GLOBAL(dgsum2d, DGSUM2D)(int *context, char const *scope, char const *top, int *m,
+                                        int *n, double *a, int *lda, int *rdest, int *cdest);
+
 #define OPTIMET_MACRO(func, FUNC)                                                             \
   int OPTIMET_FC_GLOBAL(indx ## func, INDX ## FUNC)(int*, int*, int*, int*, int*)
 OPTIMET_MACRO(g2l, G2L);
@@ -29,6 +29,7 @@
 #endif
 
 #include <tuple>
+#include <vector>
 
 namespace optimet {
 namespace scalapack {
@@ -42,13 +43,33 @@ template <class SCALAR>
 std::tuple<typename Matrix<SCALAR>::ConcreteMatrix, int>
 general_linear_system(Matrix<SCALAR> const &A, Matrix<SCALAR> const &b);
 
+//! \brief LU factorization with partial pivoting, overwriting the input
+//! \param A: matrix to factorize on input, factors L and U on output
+//! \param ipiv: pivots on output
+template <class SCALAR> int lu_factorization_inplace(Matrix<SCALAR> &A, std::vector<int> &ipiv);
+//! \brief Solves a system of linear equations from a prior LU factorization
+//! \param LU: factors and pivots from lu_factorization_inplace
+//! \param b: right-hand size on input, X on output
+template <class SCALAR>
+int lu_solve_inplace(Matrix<SCALAR> const &LU, std::vector<int> const &ipiv, Matrix<SCALAR> &b);
+//! \brief Solves a system of linear equations with a single precision LU and iterative refinement
+//! \details Residuals are computed in the precision of the input. Falls back to
+//! general_linear_system if the refinement stalls before reaching the requested relative residual.
+template <class SCALAR>
+std::tuple<typename Matrix<SCALAR>::ConcreteMatrix, int>
+mixed_precision_linear_system(Matrix<SCALAR> const &A, Matrix<SCALAR> const &b,
+                              t_real tolerance = 1e-10, t_uint iterations = 10);
+
 #ifdef OPTIMET_BELOS
-//! Solve a system of linear equations using Belos
+//! \brief Solve a system of linear equations using Belos
+//! \param history: if given, receives the relative residual of each iteration, when the solver
+//! manager accepts user-defined status tests
 template <class SCALARA, class SCALARB>
 std::tuple<typename Matrix<SCALARA>::ConcreteMatrix, int>
 gmres_linear_system(Matrix<SCALARA> const &A, Matrix<SCALARB> const &b,
                     Teuchos::RCP<Teuchos::ParameterList> const &parameters,
-                    mpi::Communicator const &comm = mpi::Communicator());
+                    mpi::Communicator const &comm = mpi::Communicator(),
+                    std::vector<t_real> *history = nullptr);
 template <class SCALARA, class SCALARB>
 std::tuple<typename Matrix<SCALARA>::ConcreteMatrix, int>
 gmres_linear_system(Matrix<SCALARA> const &A, Matrix<SCALARB> const &b,
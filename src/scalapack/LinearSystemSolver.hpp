@@ -17,11 +17,13 @@
 #ifndef OPTIMET_SCALAPACK_LINEAR_SYSTEM_SOLVER_HPP_
 #define OPTIMET_SCALAPACK_LINEAR_SYSTEM_SOLVER_HPP_
 
+#include "ResidualHistory.h"
 #include "scalapack/Blacs.h"
 #include "scalapack/InitExit.h"
 #include "scalapack/LinearSystemSolver.h"
 #include "scalapack/Matrix.h"
 
+#include <cmath>
 #include <vector>
 
 #ifdef OPTIMET_BELOS
@@ -64,6 +66,34 @@ OPTIMET_MACRO(c, C, std::complex<float>);
 OPTIMET_MACRO(z, Z, std::complex<double>);
 #undef OPTIMET_MACRO
 
+#define OPTIMET_MACRO(letter, LETTER, TYPE)                                                        \
+  inline void getrf(int *m, int *n, TYPE *a, int *ia, int *ja, int *desca, int *ipiv, int *info) { \
+    OPTIMET_FC_GLOBAL(p##letter##getrf, P##LETTER##GETRF)(m, n, a, ia, ja, desca, ipiv, info);     \
+  }                                                                                                \
+  inline void getrs(char *trans, int *n, int *nrhs, TYPE *a, int *ia, int *ja, int *desca,         \
+                    int *ipiv, TYPE *b, int *ib, int *jb, int *descb, int *info) {                 \
+    OPTIMET_FC_GLOBAL(p##letter##getrs, P##LETTER##GETRS)                                          \
+    (trans, n, nrhs, a, ia, ja, desca, ipiv, b, ib, jb, descb, info);                              \
+  }
+OPTIMET_MACRO(s, S, float);
+OPTIMET_MACRO(d, D, double);
+OPTIMET_MACRO(c, C, std::complex<float>);
+OPTIMET_MACRO(z, Z, std::complex<double>);
+#undef OPTIMET_MACRO
+
+//! Scalar type with which to factorize in mixed-precision
+template <class SCALAR> struct single_precision;
+template <> struct single_precision<double> { typedef float type; };
+template <> struct single_precision<std::complex<double>> { typedef std::complex<float> type; };
+
+//! Frobenius norm of a distributed matrix, known to all processes in the context
+template <class SCALAR> t_real norm(Matrix<SCALAR> const &matrix) {
+  t_real result = matrix.local().squaredNorm();
+  int context = *matrix.context(), one = 1, all = -1;
+  OPTIMET_FC_GLOBAL(dgsum2d, DGSUM2D)(&context, "A", " ", &one, &one, &result, &one, &all, &all);
+  return std::sqrt(result);
+}
+
 template <class SCALARA, class SCALARB>
 void sane_input(Matrix<SCALARA> const &A, Matrix<SCALARB> const &b) {
   if(A.rows() != A.cols())
@@ -90,17 +120,76 @@ template <class SCALAR> int general_linear_system_inplace(Matrix<SCALAR> &A, Mat
   return info;
 }
 
+template <class SCALAR> int lu_factorization_inplace(Matrix<SCALAR> &A, std::vector<int> &ipiv) {
+  if(A.rows() != A.cols())
+    throw std::runtime_error("Matrix should be square");
+  int n = A.rows(), one = 1, info;
+  ipiv.resize(A.local().rows() + A.blocks().rows);
+  getrf(&n, &n, A.local().data(), &one, &one, const_cast<int *>(A.blacs().data()), ipiv.data(),
+        &info);
+  return info;
+}
+
+template <class SCALAR>
+int lu_solve_inplace(Matrix<SCALAR> const &LU, std::vector<int> const &ipiv, Matrix<SCALAR> &b) {
+  sane_input(LU, b);
+  char trans = 'N';
+  int n = LU.rows(), nrhs = b.cols(), one = 1, info;
+  getrs(&trans, &n, &nrhs, const_cast<SCALAR *>(LU.local().data()), &one, &one,
+        const_cast<int *>(LU.blacs().data()), const_cast<int *>(ipiv.data()), b.local().data(),
+        &one, &one, const_cast<int *>(b.blacs().data()), &info);
+  return info;
+}
+
+template <class SCALAR>
+std::tuple<typename Matrix<SCALAR>::ConcreteMatrix, int>
+mixed_precision_linear_system(Matrix<SCALAR> const &A, Matrix<SCALAR> const &b, t_real tolerance,
+                              t_uint iterations) {
+  typedef typename Matrix<SCALAR>::ConcreteMatrix ConcreteMatrix;
+  typedef typename single_precision<SCALAR>::type Single;
+  sane_input(A, b);
+  if(not(A.context().is_valid() and b.context().is_valid()))
+    return std::tuple<ConcreteMatrix, int>{ConcreteMatrix(b.context(), b.sizes(), b.blocks()), 0};
+
+  Matrix<Single> LU(A.local().template cast<Single>(), A.context(), A.sizes(), A.blocks());
+  std::vector<int> ipiv;
+  if(lu_factorization_inplace(LU, ipiv) != 0)
+    return general_linear_system(A, b);
+
+  auto const threshold = tolerance * norm(b);
+  ConcreteMatrix result(b.context(), b.sizes(), b.blocks());
+  ConcreteMatrix residual(b.local(), b.context(), b.sizes(), b.blocks());
+  auto previous = norm(residual);
+  for(t_uint i(0); i <= iterations and previous > threshold; ++i) {
+    Matrix<Single> correction(residual.local().template cast<Single>(), residual.context(),
+                              residual.sizes(), residual.blocks());
+    if(lu_solve_inplace(LU, ipiv, correction) != 0)
+      break;
+    result.local() += correction.local().template cast<SCALAR>();
+    residual.local() = b.local();
+    pdgemm(SCALAR(-1), A, result, SCALAR(1), residual);
+    auto const current = norm(residual);
+    // stalled: each step should at least halve the residual
+    if(current > 0.5 * previous and current > threshold)
+      break;
+    previous = current;
+  }
+  if(previous > threshold)
+    return general_linear_system(A, b);
+  return std::tuple<ConcreteMatrix, int>{std::move(result), 0};
+}
+
 #ifdef OPTIMET_BELOS
 template <class SCALARA, class SCALARB>
 std::tuple<typename Matrix<SCALARA>::ConcreteMatrix, int>
 gmres_linear_system(Matrix<SCALARA> const &A, Matrix<SCALARB> const &b,
                     Teuchos::RCP<Teuchos::ParameterList> const &parameters,
-                    mpi::Communicator const &comm) {
+                    mpi::Communicator const &comm, std::vector<t_real> *history) {
   typedef typename Matrix<SCALARA>::ConcreteMatrix ConcreteMatrix;
   sane_input(A, b);
   if(b.context() != A.context()) {
     auto const b_in_A = b.transfer_to(A.context());
-    return gmres_linear_system(A, b_in_A, parameters, comm);
+    return gmres_linear_system(A, b_in_A, parameters, comm, history);
   }
   if(A.size() == 0)
     return std::tuple<ConcreteMatrix, int>{ConcreteMatrix(b.context(), b.sizes(), b.blocks()), 0};
@@ -133,7 +222,10 @@ gmres_linear_system(Matrix<SCALARA> const &A, Matrix<SCALARB> const &b,
   // Attempt to solve the linear system.  result == Belos::Converged
   // means that it was solved to the desired tolerance.  This call
   // overwrites X with the computed approximate solution.
+  auto const residuals = history ? monitor_residuals(*solver) : nullptr;
   int info = solver->solve() == Belos::Converged ? 0 : 1;
+  if(history)
+    *history = *residuals;
 
   auto const view = as_matrix(*X, b);
   ConcreteMatrix result(b.context(), b.sizes(), b.blocks());
@@ -102,6 +102,20 @@ Matrix<SCALAR>::local_indices(std::tuple<t_uint, t_uint> const &i) const {
       OPTIMET_FC_GLOBAL(indxg2p, INDXG2P)(&i_col, &nb_col, &dummy, &f_col, &np_col));
 }
 
+template <class SCALAR>
+std::tuple<t_uint, t_uint>
+Matrix<SCALAR>::global_indices(std::tuple<t_uint, t_uint, t_uint, t_uint> const &i) const {
+  int np_row(context().rows()), np_col(context().cols());
+  int nb_row(blocks().rows), nb_col(blocks().cols);
+  // fortran indices start at 1
+  int i_row(std::get<0>(i) + 1), i_col(std::get<1>(i) + 1);
+  int p_row(std::get<2>(i)), p_col(std::get<3>(i));
+  int f_row(first_row()), f_col(first_col());
+  return std::tuple<t_uint, t_uint>(
+      OPTIMET_FC_GLOBAL(indxl2g, INDXL2G)(&i_row, &nb_row, &p_row, &f_row, &np_row) - 1,
+      OPTIMET_FC_GLOBAL(indxl2g, INDXL2G)(&i_col, &nb_col, &p_col, &f_col, &np_col) - 1);
+}
+
 template <class SCALAR> void Matrix<SCALAR>::operator=(Matrix<SCALAR> const &other) {
   if(rows() != other.rows() or cols() != other.cols())
     throw std::runtime_error("Matrices have different sizes.");
@@ -18,6 +18,7 @@
 #define OPTIMET_PARALLEL_PARAMETERS_H
 
 #include "Types.h"
+#include <string>
 
 namespace optimet {
 namespace scalapack {
@@ -34,6 +35,12 @@ struct Index {
 struct Parameters {
   t_uint block_size;
   Sizes grid;
+  //! Whether to pick block size and grid from trial runs, see scalapack::autotune
+  bool autotune = false;
+  //! File caching the tuned parameters across runs
+  std::string tuning_file = "optimet.tuning";
+  //! Largest size of the trial problems
+  t_uint trial_size = 1024;
 
   Parameters(t_uint block_size = 64, Sizes grid = {0, 0})
       : block_size(block_size), grid(grid) {}
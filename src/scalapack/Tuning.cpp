@@ -0,0 +1,167 @@
+// (C) University College London 2017
+// This file is part of Optimet, licensed under the terms of the GNU Public License
+//
+// Optimet is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Optimet is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Optimet. If not, see <http://www.gnu.org/licenses/>.
+
+#include "scalapack/Tuning.h"
+#include "mpi/Collectives.h"
+#include "scalapack/LinearSystemSolver.h"
+#include "scalapack/Matrix.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+namespace optimet {
+namespace scalapack {
+namespace {
+//! Name of the workload in the cache file
+std::string workload_name(Workload workload) {
+  return workload == Workload::factorization ? "factorization" : "multiplication";
+}
+
+//! Number of products per multiplication trial, so that it is not dominated by latency
+constexpr t_uint multiplications = 10;
+}
+
+std::vector<Parameters> tuning_candidates(t_uint N, t_uint nprocs) {
+  std::vector<Sizes> grids;
+  for(t_uint rows(1); rows <= nprocs; ++rows)
+    if(nprocs % rows == 0)
+      grids.push_back({rows, nprocs / rows});
+  auto const squarest = squarest_largest_grid(nprocs);
+  if(squarest.rows * squarest.cols != nprocs)
+    grids.push_back(squarest);
+
+  t_uint const blocks[] = {16, 32, 64, 128, 256};
+  std::vector<Parameters> result;
+  for(auto const &grid : grids) {
+    auto const procs = std::max(grid.rows, grid.cols);
+    auto const n = result.size();
+    for(auto const block : blocks)
+      if(block * procs <= N)
+        result.emplace_back(block, grid);
+    if(n == result.size())
+      result.emplace_back(blocks[0], grid);
+  }
+  return result;
+}
+
+t_real trial_time(Parameters const &parameters, t_uint N, Workload workload,
+                  mpi::Communicator const &comm) {
+  Context const context(parameters.grid);
+  Sizes const blocks{parameters.block_size, parameters.block_size};
+  Matrix<t_complex> A(context, {N, N}, blocks);
+  Matrix<t_complex> x(context, {N, 1}, blocks);
+  Matrix<t_complex> y(context, {N, 1}, blocks);
+  if(A.local().size() > 0)
+    A.local().setRandom();
+  if(x.local().size() > 0)
+    x.local().setRandom();
+  std::vector<int> ipiv;
+
+  comm.barrier();
+  auto const start = std::chrono::high_resolution_clock::now();
+  if(context.is_valid()) {
+    if(workload == Workload::factorization)
+      lu_factorization_inplace(A, ipiv);
+    else
+      for(t_uint i(0); i < multiplications; ++i)
+        pdgemm(1e0, A, x, 0e0, y);
+  }
+  auto const end = std::chrono::high_resolution_clock::now();
+  t_real const elapsed = std::chrono::duration<t_real>(end - start).count();
+  return comm.all_reduce(elapsed, MPI_MAX);
+}
+
+bool read_tuning(std::string const &filename, t_uint N, t_uint nprocs, Workload workload,
+                 Parameters &result) {
+  std::ifstream file(filename);
+  std::string line;
+  while(std::getline(file, line)) {
+    if(line.empty() or line[0] == '#')
+      continue;
+    std::istringstream sstr(line);
+    std::string name;
+    t_uint n, procs, block_size, rows, cols;
+    if(not(sstr >> name >> n >> procs >> block_size >> rows >> cols))
+      continue;
+    if(name == workload_name(workload) and n == N and procs == nprocs) {
+      result.block_size = block_size;
+      result.grid = {rows, cols};
+      return true;
+    }
+  }
+  return false;
+}
+
+void write_tuning(std::string const &filename, t_uint N, t_uint nprocs, Workload workload,
+                  Parameters const &parameters) {
+  // keeps other entries, drops the one being replaced
+  std::vector<std::string> lines;
+  {
+    std::ifstream file(filename);
+    std::string line;
+    while(std::getline(file, line)) {
+      std::istringstream sstr(line);
+      std::string name;
+      t_uint n, procs;
+      if(line.empty() or line[0] == '#')
+        continue;
+      if(sstr >> name >> n >> procs and name == workload_name(workload) and n == N and
+         procs == nprocs)
+        continue;
+      lines.push_back(line);
+    }
+  }
+  std::ofstream file(filename);
+  if(not file)
+    throw std::runtime_error("Could not open tuning file " + filename);
+  file << "# workload size nprocs block_size grid_rows grid_cols\n";
+  for(auto const &line : lines)
+    file << line << "\n";
+  file << workload_name(workload) << " " << N << " " << nprocs << " " << parameters.block_size
+       << " " << parameters.grid.rows << " " << parameters.grid.cols << "\n";
+}
+
+Parameters autotune(t_uint N, Workload workload, mpi::Communicator const &comm,
+                    Parameters const &parameters) {
+  auto const nprocs = comm.size();
+  Parameters result = parameters;
+  int found = comm.is_root() and
+              read_tuning(parameters.tuning_file, N, nprocs, workload, result);
+  if(comm.broadcast(found)) {
+    result.block_size = comm.broadcast(result.block_size);
+    result.grid.rows = comm.broadcast(result.grid.rows);
+    result.grid.cols = comm.broadcast(result.grid.cols);
+    return result;
+  }
+
+  auto const n = std::max<t_uint>(1, std::min(N, parameters.trial_size));
+  auto best = std::numeric_limits<t_real>::infinity();
+  for(auto const &candidate : tuning_candidates(n, nprocs)) {
+    auto const time = trial_time(candidate, n, workload, comm);
+    if(time < best) {
+      best = time;
+      result.block_size = candidate.block_size;
+      result.grid = candidate.grid;
+    }
+  }
+  if(comm.is_root())
+    write_tuning(parameters.tuning_file, N, nprocs, workload, result);
+  return result;
+}
+} // namespace scalapack
+} // namespace optimet
@@ -0,0 +1,69 @@
+// (C) University College London 2017
+// This file is part of Optimet, licensed under the terms of the GNU Public License
+//
+// Optimet is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Optimet is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Optimet. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef OPTIMET_SCALAPACK_TUNING_H
+#define OPTIMET_SCALAPACK_TUNING_H
+
+#include "Types.h"
+
+#ifdef OPTIMET_SCALAPACK
+#include "mpi/Communicator.h"
+#include "scalapack/Parameters.h"
+#include <string>
+#include <vector>
+
+namespace optimet {
+namespace scalapack {
+
+//! Operation the parallel layout is tuned for
+enum class Workload {
+  //! LU factorization and triangular solves, as in solver::Scalapack
+  factorization,
+  //! Matrix-vector products, as in the iterative solver::MatrixBelos
+  multiplication
+};
+
+//! Block sizes and grids worth trying for a given problem size and number of procs
+//! \details Grids use all procs, plus the squarest-largest grid which may leave some procs out.
+//! Blocks that would leave procs without any data are skipped, unless none fit.
+std::vector<Parameters> tuning_candidates(t_uint N, t_uint nprocs);
+
+//! \brief Wall-time of a trial run for the given layout
+//! \details Factorizes or multiplies a random matrix of size N. All procs of the communicator
+//! must participate. Returns the slowest time across procs.
+t_real trial_time(Parameters const &parameters, t_uint N, Workload workload,
+                  mpi::Communicator const &comm);
+
+//! \brief Reads tuned parameters from the cache file
+//! \returns true if an entry exists for (N, nprocs, workload), in which case block size and
+//! grid of result are set.
+bool read_tuning(std::string const &filename, t_uint N, t_uint nprocs, Workload workload,
+                 Parameters &result);
+//! Adds or replaces the entry for (N, nprocs, workload) in the cache file
+void write_tuning(std::string const &filename, t_uint N, t_uint nprocs, Workload workload,
+                  Parameters const &parameters);
+
+//! \brief Picks block size and grid for a problem of size N
+//! \details Tuned values are read from parameters.tuning_file if present. Otherwise, each
+//! candidate layout is timed on a sub-problem of size min(N, parameters.trial_size), the fastest
+//! is kept and cached. Must be called by all procs of the communicator. Nothing is printed: callers
+//! decide whether to report the choice.
+Parameters autotune(t_uint N, Workload workload, mpi::Communicator const &comm,
+                    Parameters const &parameters = Parameters());
+} // namespace scalapack
+} // namespace optimet
+#endif
+#endif
@@ -18,6 +18,7 @@
 #include "catch.hpp"
 
 #include "AuxCoefficients.h"
+#include "Tools.h"
 
 using namespace optimet;
 
@@ -109,3 +110,37 @@ TEST_CASE("AuxCoefficients") {
     CHECK(dWigner[7] == Approx(2.1875));
   }
 }
+
+TEST_CASE("AuxCoefficients workspace") {
+  t_complex const waveK(2.3, 0.1);
+  // a single workspace is reused for all points, regularity and nMax
+  AuxCoefficientsWorkspace workspace;
+
+  auto const check = [&workspace, &waveK](Spherical<t_real> const &R, bool regular, t_uint nMax) {
+    workspace.nMax(nMax).compute(R, waveK, regular);
+    AuxCoefficients const expected(R, waveK, regular, nMax);
+    CHECK(workspace.M().cols() == Tools::iteratorMax(nMax));
+    for(t_uint i(0); i < Tools::iteratorMax(nMax); ++i) {
+      for(auto const &pair : {std::make_pair(expected.M(i), workspace.M(i)),
+                              std::make_pair(expected.N(i), workspace.N(i)),
+                              std::make_pair(expected.B(i), workspace.B(i)),
+                              std::make_pair(expected.C(i), workspace.C(i))}) {
+        CHECK(pair.first.rrr.real() == Approx(pair.second.rrr.real()));
+        CHECK(pair.first.rrr.imag() == Approx(pair.second.rrr.imag()));
+        CHECK(pair.first.the.real() == Approx(pair.second.the.real()));
+        CHECK(pair.first.the.imag() == Approx(pair.second.the.imag()));
+        CHECK(pair.first.phi.real() == Approx(pair.second.phi.real()));
+        CHECK(pair.first.phi.imag() == Approx(pair.second.phi.imag()));
+      }
+    }
+    for(t_uint n(1); n <= nMax; ++n)
+      CHECK(workspace.dn(n) == Approx(expected.dn(n)));
+  };
+
+  for(auto const nMax : {1u, 4u, 7u})
+    for(auto const regular : {true, false}) {
+      check({1.5, 0.3, 2.1}, regular, nMax);
+      check({0.7, 1e-12, 0.5}, regular, nMax); // pole
+      check({2.0, 3.0, -1.0}, regular, nMax);
+    }
+}
@@ -162,6 +162,25 @@ TEST_CASE("Standard vs Fast matrix multiply") {
       CHECK(expected.isApprox(actual));
     }
   }
+
+  SECTION("Particles with different number of harmonics") {
+    auto const x = Eigen::Matrix<t_real, 3, 1>::Unit(0).eval();
+    geometry->pushObject(
+        {direction * 1.5 * radius * 1.500001 + x * radius * 8, silicon, 0.5 * radius, 2});
+    optimet::FastMatrixMultiply fmm(geometry->bground, excitation->omega() / constant::c,
+                                    geometry->objects);
+    auto const S = preconditioned_scattering_matrix(*geometry, excitation);
+    CHECK(S.rows() == geometry->scatterer_size());
+    CHECK(S.cols() == geometry->scatterer_size());
+    auto const size = S.cols();
+
+    for(t_int i(0); i < size; ++i) {
+      auto const input = Vector<t_complex>::Unit(size, i);
+      Vector<t_complex> const expected = S * input;
+      Vector<t_complex> const actual = fmm * input;
+      CHECK(expected.isApprox(actual));
+    }
+  }
 }
 
 TEST_CASE("Ranged matrices") {
@@ -47,6 +47,64 @@ TEST_CASE("Column and row distributions") {
     CHECK(vector_distribution(5, 2).segment(3, 2) == Vector<t_int>::Ones(2));
   }
 
+  SECTION("Cost-weighted distributions") {
+    using optimet::mpi::details::vector_distribution;
+    using optimet::mpi::details::process_costs;
+    CHECK(vector_distribution(Vector<t_real>::Zero(0), 4).size() == 0);
+    CHECK(vector_distribution(Vector<t_real>::Ones(2), 4) == vector_distribution(2, 4));
+    CHECK(vector_distribution(Vector<t_real>::Ones(5), 4) == vector_distribution(5, 4));
+    CHECK(vector_distribution(Vector<t_real>::Ones(5), 2) == vector_distribution(5, 2));
+
+    // a single costly scatterer gets a process of its own
+    Vector<t_real> costs = Vector<t_real>::Ones(10);
+    costs(0) = 10;
+    auto const distribution = vector_distribution(costs, 2);
+    CHECK(distribution(0) == 0);
+    CHECK(distribution.tail(9) == Vector<t_int>::Ones(9));
+    CHECK(process_costs(costs, distribution, 2)(0) == Approx(10));
+    CHECK(process_costs(costs, distribution, 2)(1) == Approx(9));
+
+    // every process owns at least one scatterer, and ranges are contiguous
+    costs = Vector<t_real>::Ones(4);
+    costs(3) = 100;
+    auto const tail_heavy = vector_distribution(costs, 3);
+    CHECK(tail_heavy(0) == 0);
+    CHECK(tail_heavy(1) == 0);
+    CHECK(tail_heavy(2) == 1);
+    CHECK(tail_heavy(3) == 2);
+
+    costs = Vector<t_real>::Random(50).array().abs() + 0.1;
+    auto const random = vector_distribution(costs, 7);
+    CHECK(random(0) == 0);
+    CHECK(random(49) == 6);
+    for(t_int i(1); i < random.size(); ++i)
+      CHECK((random(i) == random(i - 1) or random(i) == random(i - 1) + 1));
+    auto const loads = process_costs(costs, random, 7);
+    CHECK(loads.sum() == Approx(costs.sum()));
+    CHECK(loads.maxCoeff() <=
+          process_costs(costs, vector_distribution(50, 7), 7).maxCoeff() + 1e-8);
+
+    // idle processes have a zero cost
+    auto const idle = process_costs(Vector<t_real>::Ones(2), vector_distribution(2, 4), 4);
+    REQUIRE(idle.size() == 4);
+    CHECK(idle.head(2).isApprox(Vector<t_real>::Ones(2)));
+    CHECK(idle.tail(2).isZero());
+  }
+
+  SECTION("Cost of the couplings") {
+    using optimet::mpi::details::scatterer_costs;
+    std::vector<Scatterer> scatterers;
+    for(t_uint n : {1, 2, 3})
+      scatterers.emplace_back(Vector<t_real>::Zero(3), ElectroMagnetic(), 0.5, n);
+    // a coupling costs the larger nMax squared
+    Vector<t_real> const columns = scatterer_costs(scatterers, Matrix<bool>::Ones(3, 3));
+    CHECK(columns.isApprox((Vector<t_real>(3) << 14, 17, 27).finished()));
+    CHECK(scatterer_costs(scatterers, Matrix<bool>::Zero(3, 3)).isApprox(columns));
+    // local couplings are charged to the input scatterer, others to the output scatterer
+    Matrix<bool> const upper = Matrix<bool>::Ones(3, 3).triangularView<Eigen::Upper>();
+    CHECK(scatterer_costs(scatterers, upper).isApprox((Vector<t_real>(3) << 1, 12, 45).finished()));
+  }
+
   SECTION("Local vs non-local") {
     using optimet::mpi::details::local_interactions;
     CHECK(local_interactions(0).rows() == 0);
@@ -0,0 +1,78 @@
+// (C) University College London 2017
+// This file is part of Optimet, licensed under the terms of the GNU Public License
+//
+// Optimet is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Optimet is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Optimet. If not, see <http://www.gnu.org/licenses/>.
+
+#include "catch.hpp"
+
+#include "Geometry.h"
+#include "HierarchicalMatrix.h"
+#include "HierarchicalMatrixSolver.h"
+#include "PreconditionedMatrix.h"
+#include "PreconditionedMatrixSolver.h"
+#include "Tools.h"
+#include "Types.h"
+#include "constants.h"
+
+using namespace optimet;
+
+TEST_CASE("Hierarchical matrix") {
+  // a chain of spheres, with one smaller expansion to exercise varying block sizes
+  auto geometry = std::make_shared<Geometry>();
+  for(t_int i(0); i < 64; ++i) {
+    Eigen::Matrix<t_real, 3, 1> const x(1.5 * i, 0.3 * (i % 3), 0.2 * (i % 2));
+    geometry->pushObject(
+        {Spherical<t_real>::toSpherical(x), {1.8e0, 1.0e0}, 0.4, i == 5 ? 1 : 2});
+  }
+
+  auto const wavelength = 3.0;
+  Spherical<t_real> const vKinc{2 * consPi / wavelength, 0.3, 0.2};
+  auto const excitation = std::make_shared<Excitation>(
+      0, Tools::toProjection(vKinc, SphericalP<t_complex>{0e0, 1e0, 0e0}), vKinc, 2);
+  excitation->populate();
+  geometry->update(excitation);
+
+  auto const S = preconditioned_scattering_matrix(*geometry, excitation);
+  auto const N = S.rows();
+  HierarchicalMatrix const matrix(geometry->objects, geometry->bground, excitation, 1e-8, 50);
+  REQUIRE(matrix.rows() == N);
+  CHECK(matrix.depth() > 1);
+  CHECK(matrix.max_rank() < N / 2);
+  CHECK(matrix.memory() < N * N);
+
+  SECTION("Application") {
+    Matrix<t_complex> const X = Matrix<t_complex>::Random(N, 3);
+    CHECK(matrix.apply(X).isApprox(S * X, 1e-6));
+  }
+
+  SECTION("Direct solver") {
+    Matrix<t_complex> const B = Matrix<t_complex>::Random(N, 2);
+    Matrix<t_complex> const X = matrix.solve(B);
+    CHECK((S * X - B).norm() < 1e-6 * B.norm());
+  }
+
+  SECTION("Solver") {
+    solver::Parameters parameters;
+    parameters.method = "hmatrix";
+    parameters.compression_tolerance = 1e-8;
+    parameters.leaf_size = 50;
+    solver::HierarchicalMatrix const hmatrix(geometry, excitation, mpi::Communicator(),
+                                             parameters);
+    Vector<t_complex> expected_sca, expected_int, sca, internal;
+    solver::PreconditionedMatrix(geometry, excitation).solve(expected_sca, expected_int);
+    hmatrix.solve(sca, internal);
+    CHECK(sca.isApprox(expected_sca, 1e-6));
+    CHECK(internal.isApprox(expected_int, 1e-6));
+  }
+}
@@ -0,0 +1,597 @@
+// (C) University College London 2017
+// This file is part of Optimet, licensed under the terms of the GNU Public License
+//
+// Optimet is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Optimet is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Optimet. If not, see <http://www.gnu.org/licenses/>.
+
+#include "catch.hpp"
+
+#include "BlockJacobi.h"
+#include "FMMKrylovSolver.h"
+#include "Geometry.h"
+#include "HierarchicalMatrixSolver.h"
+#include "Krylov.h"
+#include "OrderOfScatteringSolver.h"
+#include "PMultigrid.h"
+#include "PreconditionedMatrixSolver.h"
+#include "Solver.h"
+#include "Tools.h"
+#include "Types.h"
+#include "WarmStart.h"
+#include "constants.h"
+#include <map>
+#include <sstream>
+
+using namespace optimet;
+
+TEST_CASE("Krylov methods on a dense matrix") {
+  t_uint const N = 60;
+  Matrix<t_complex> const A =
+      Matrix<t_complex>::Identity(N, N) + 0.3 * Matrix<t_complex>::Random(N, N) / std::sqrt(N);
+  Vector<t_complex> const b = Vector<t_complex>::Random(N);
+  Vector<t_complex> const expected = A.lu().solve(b);
+  auto const op = [&A](Vector<t_complex> const &in, Vector<t_complex> &out) { out = A * in; };
+
+  for(std::string const method : {"GMRES", "GCRODR", "BiCGStab", "TFQMR"}) {
+    SECTION(method) {
+      Vector<t_complex> x = Vector<t_complex>::Zero(N);
+      auto const convergence = krylov::solve(method, op, b, x, 1e-10, 200, 10);
+      CHECK(convergence.converged);
+      CHECK(convergence.iterations > 0);
+      CHECK(convergence.residual <= 1e-10);
+      CHECK(x.isApprox(expected, 1e-8));
+      // one estimate before the first iteration and one after each
+      REQUIRE(convergence.history.size() == convergence.iterations + 1);
+      CHECK(convergence.history.front() == Approx(1));
+      CHECK(convergence.history.back() <= 1e-10);
+    }
+  }
+
+  SECTION("s-step GMRES") {
+    std::map<t_uint, t_uint> reductions;
+    for(t_uint const steps : {1, 4, 10}) {
+      auto const count = [&reductions, steps](Matrix<t_complex> &) { ++reductions[steps]; };
+      Vector<t_complex> x = Vector<t_complex>::Zero(N);
+      auto const convergence =
+          krylov::sstep_gmres(op, b, x, 1e-10, 200, 20, steps, krylov::Operator(), count);
+      CHECK(convergence.converged);
+      CHECK(convergence.residual <= 1e-10);
+      CHECK(x.isApprox(expected, 1e-8));
+      CHECK(convergence.history.size() == convergence.iterations + 1);
+    }
+    // synchronizes twice per block rather than twice per iteration
+    CHECK(3 * reductions[4] < reductions[1]);
+    CHECK(2 * reductions[10] < reductions[1]);
+
+    Matrix<t_complex> const inverse = A.inverse();
+    auto const preconditioner = [&inverse](Vector<t_complex> const &in, Vector<t_complex> &out) {
+      out = inverse * in;
+    };
+    Vector<t_complex> x = Vector<t_complex>::Zero(N);
+    auto const convergence = krylov::sstep_gmres(op, b, x, 1e-10, 200, 20, 4, preconditioner);
+    CHECK(convergence.converged);
+    CHECK(convergence.iterations <= 2);
+    CHECK(x.isApprox(expected, 1e-8));
+  }
+
+  SECTION("Stops at the maximum number of iterations") {
+    Vector<t_complex> x = Vector<t_complex>::Zero(N);
+    auto const convergence = krylov::gmres(op, b, x, 1e-14, 3, 10);
+    CHECK(not convergence.converged);
+    CHECK(convergence.iterations == 3);
+  }
+
+  SECTION("Unknown method") {
+    Vector<t_complex> x;
+    CHECK_THROWS_AS(krylov::solve("CG", op, b, x, 1e-10, 10, 10), std::runtime_error);
+  }
+}
+
+TEST_CASE("Inexact GMRES") {
+  t_uint const N = 80;
+  Matrix<t_complex> const A =
+      Matrix<t_complex>::Identity(N, N) + 0.5 * Matrix<t_complex>::Random(N, N) / std::sqrt(N);
+  Matrix<t_complex> const E = Matrix<t_complex>::Random(N, N) / std::sqrt(N);
+  Vector<t_complex> const b = Vector<t_complex>::Random(N);
+  Vector<t_complex> const expected = A.lu().solve(b);
+  std::vector<krylov::Operator> levels;
+  for(auto const epsilon : {0e0, 1e-6, 1e-3})
+    levels.push_back([&A, &E, epsilon](Vector<t_complex> const &in, Vector<t_complex> &out) {
+      out = A * in + epsilon * (E * in);
+    });
+  std::vector<t_real> errors{0};
+  for(std::size_t i(1); i < levels.size(); ++i)
+    errors.push_back(krylov::relative_change(levels[0], levels[i], N));
+  CHECK(errors[1] < errors[2]);
+
+  Vector<t_complex> x = Vector<t_complex>::Zero(N);
+  std::vector<t_uint> applications;
+  auto const convergence =
+      krylov::inexact_gmres(levels, errors, b, x, 1e-10, 500, 20, &applications);
+  CHECK(convergence.converged);
+  CHECK(convergence.residual <= 1e-10);
+  CHECK(x.isApprox(expected, 1e-8));
+  REQUIRE(applications.size() == levels.size());
+  CHECK(applications[0] > 0);
+  CHECK(applications[2] > 0);
+
+  SECTION("A single level is plain GMRES") {
+    Vector<t_complex> y = Vector<t_complex>::Zero(N);
+    auto const plain = krylov::gmres(levels[0], b, y, 1e-10, 500, 20);
+    Vector<t_complex> z = Vector<t_complex>::Zero(N);
+    auto const single = krylov::inexact_gmres({levels[0]}, {0}, b, z, 1e-10, 500, 20);
+    CHECK(single.iterations == plain.iterations);
+    CHECK(z.isApprox(y));
+  }
+
+  SECTION("Each level requires an error") {
+    CHECK_THROWS_AS(krylov::inexact_gmres(levels, {0}, b, x, 1e-10, 500, 20),
+                    std::runtime_error);
+  }
+}
+
+TEST_CASE("Subspace recycling") {
+  // a few small eigenvalues stall restarted GMRES
+  t_uint const N = 120;
+  Vector<t_complex> diagonal = Vector<t_real>::LinSpaced(N, 1, 10).cast<t_complex>();
+  diagonal.head(4) << 1e-2, 2e-2, 3e-2, 4e-2;
+  Matrix<t_complex> const A = Matrix<t_complex>(diagonal.asDiagonal()) +
+                              1e-2 * Matrix<t_complex>::Random(N, N) / std::sqrt(N);
+  Matrix<t_complex> const B = A + 1e-4 * Matrix<t_complex>::Random(N, N) / std::sqrt(N);
+  auto const opA = [&A](Vector<t_complex> const &in, Vector<t_complex> &out) { out = A * in; };
+  auto const opB = [&B](Vector<t_complex> const &in, Vector<t_complex> &out) { out = B * in; };
+  Vector<t_complex> const b = Vector<t_complex>::Random(N);
+
+  Matrix<t_complex> U;
+  Vector<t_complex> x = Vector<t_complex>::Zero(N);
+  auto const first = krylov::gcrodr(opA, b, x, 1e-10, 1000, 20, 5, U);
+  CHECK(first.converged);
+  CHECK(x.isApprox(A.lu().solve(b), 1e-8));
+  CHECK(U.rows() == N);
+  CHECK(U.cols() == 5);
+
+  Vector<t_complex> const c = Vector<t_complex>::Random(N);
+  Vector<t_complex> y = Vector<t_complex>::Zero(N);
+  Matrix<t_complex> none;
+  auto const cold = krylov::gcrodr(opB, c, y, 1e-10, 1000, 20, 5, none);
+  y.fill(0);
+  auto const recycled = krylov::gcrodr(opB, c, y, 1e-10, 1000, 20, 5, U);
+  CHECK(cold.converged);
+  CHECK(recycled.converged);
+  CHECK(recycled.iterations < cold.iterations);
+  CHECK(y.isApprox(B.lu().solve(c), 1e-8));
+
+  SECTION("Deflation beats plain restarts") {
+    y.fill(0);
+    auto const gmres = krylov::gmres(opB, c, y, 1e-10, 1000, 20);
+    CHECK(cold.iterations < gmres.iterations);
+  }
+
+  SECTION("Recycled space of the wrong size is ignored") {
+    Matrix<t_complex> wrong = Matrix<t_complex>::Random(N / 2, 5);
+    y.fill(0);
+    auto const result = krylov::gcrodr(opB, c, y, 1e-10, 1000, 20, 5, wrong);
+    CHECK(result.converged);
+    CHECK(result.iterations == cold.iterations);
+    CHECK(wrong.rows() == N);
+  }
+
+  SECTION("Change of operator") {
+    CHECK(krylov::relative_change(opA, opA, N) == 0);
+    CHECK(krylov::relative_change(opA, opB, N) < 1e-3);
+    CHECK(krylov::relative_change(opA, opB, N) > 0);
+  }
+}
+
+TEST_CASE("Serial FMM Krylov solver") {
+  auto geometry = std::make_shared<Geometry>();
+  auto const nHarmonics = 3;
+  geometry->pushObject({{0, 0, 0}, {1.5e0, 1.0e0}, 0.5, nHarmonics});
+  geometry->pushObject({{1.5, 0.5, 0.2}, {2.0e0, 1.0e0}, 0.6, nHarmonics});
+  geometry->pushObject({{3.0, 1.0, 0.4}, {1.8e0, 1.0e0}, 0.4, nHarmonics});
+  geometry->pushObject({{4.5, 0.8, 3.0}, {2.2e0, 1.0e0}, 0.3, 2});
+
+  auto const wavelength = 1.5;
+  Spherical<t_real> const vKinc{2 * consPi / wavelength, 0.3, 0.2};
+  auto const excitation = std::make_shared<Excitation>(
+      0, Tools::toProjection(vKinc, SphericalP<t_complex>{0e0, 1e0, 0e0}), vKinc, nHarmonics);
+  excitation->populate();
+  geometry->update(excitation);
+
+  Vector<t_complex> expected_sca, expected_int;
+  solver::PreconditionedMatrix(geometry, excitation).solve(expected_sca, expected_int);
+
+  for(std::string const method : {"GMRES", "BiCGStab", "TFQMR"}) {
+    SECTION(method) {
+      solver::Parameters parameters;
+      parameters.method = "fmm";
+      parameters.krylov = method;
+      parameters.tolerance = 1e-12;
+      solver::FMMKrylov const solver(geometry, excitation, mpi::Communicator(), parameters);
+
+      Vector<t_complex> sca, internal;
+      solver.solve(sca, internal);
+      CHECK(solver.convergence().converged);
+      CHECK(sca.isApprox(expected_sca, 1e-8));
+      CHECK(internal.isApprox(expected_int, 1e-8));
+
+      REQUIRE(solver.telemetry().size() == 1);
+      auto const &telemetry = solver.telemetry().front();
+      CHECK(telemetry.method == method);
+      CHECK(telemetry.converged);
+      CHECK(telemetry.iterations == solver.convergence().iterations);
+      CHECK(telemetry.residuals.size() == telemetry.iterations + 1);
+      CHECK(telemetry.true_residual <= 1e-12);
+      CHECK(telemetry.apply > 0);
+      CHECK(telemetry.total >= telemetry.apply + telemetry.preconditioner);
+    }
+  }
+
+  SECTION("Warm start") {
+    solver::Parameters parameters;
+    parameters.method = "fmm";
+    parameters.tolerance = 1e-10;
+    solver::FMMKrylov solver(geometry, excitation, mpi::Communicator(), parameters);
+    Vector<t_complex> sca, internal;
+    solver.solve(sca, internal);
+    REQUIRE(solver.solution().size() == sca.size());
+    Vector<t_complex> const guess = solver.solution();
+
+    excitation->updateWavelength(wavelength * 1.001);
+    geometry->update(excitation);
+    solver.update(geometry, excitation);
+    solver.solve(sca, internal);
+    auto const cold = solver.iterations();
+
+    solver.initial_guess(guess);
+    solver.solve(sca, internal);
+    CHECK(solver.iterations() < cold);
+    Vector<t_complex> expected, unused;
+    solver::PreconditionedMatrix(geometry, excitation).solve(expected, unused);
+    CHECK(sca.isApprox(expected, 1e-8));
+
+    // wrong size is ignored
+    solver.initial_guess(Vector<t_complex>::Ones(3));
+    solver.solve(sca, internal);
+    CHECK(sca.isApprox(expected, 1e-8));
+  }
+
+  SECTION("Recycling across updates") {
+    solver::Parameters parameters;
+    parameters.method = "fmm";
+    parameters.krylov = "GCRODR";
+    parameters.tolerance = 1e-10;
+    parameters.restart = 10;
+    parameters.recycle = 4;
+    solver::FMMKrylov solver(geometry, excitation, mpi::Communicator(), parameters);
+    Vector<t_complex> sca, internal;
+    solver.solve(sca, internal);
+    CHECK(sca.isApprox(expected_sca, 1e-8));
+    CHECK(solver.recycled().cols() == 4);
+
+    // small change: the space is kept
+    excitation->updateWavelength(wavelength * 1.001);
+    geometry->update(excitation);
+    solver.update(geometry, excitation);
+    CHECK(solver.recycled().cols() == 4);
+    solver.solve(sca, internal);
+    Vector<t_complex> expected, unused;
+    solver::PreconditionedMatrix(geometry, excitation).solve(expected, unused);
+    CHECK(sca.isApprox(expected, 1e-8));
+
+    // large change: the space is discarded
+    excitation->updateWavelength(wavelength * 1.5);
+    geometry->update(excitation);
+    solver.update(geometry, excitation);
+    CHECK(solver.recycled().cols() == 0);
+  }
+
+  SECTION("Several incident waves") {
+    auto const waves = std::make_shared<Excitation>(*excitation);
+    Spherical<t_real> const direction{0, 1.2, -0.4};
+    waves->add_wave(direction,
+                    Tools::toProjection(direction, SphericalP<t_complex>{0e0, 0e0, 1e0}));
+    REQUIRE(waves->nwaves() == 2);
+    CHECK(waves->wave(0).dataIncAp.isApprox(excitation->dataIncAp));
+    CHECK(waves->wave(1).wavenumber() == Approx(excitation->wavenumber()));
+    CHECK_THROWS_AS(waves->wave(2), std::out_of_range);
+
+    solver::Parameters parameters;
+    parameters.method = "fmm";
+    parameters.tolerance = 1e-12;
+    solver::FMMKrylov const solver(geometry, waves, mpi::Communicator(), parameters);
+    Matrix<t_complex> scattered, internal;
+    solver.solve_waves(scattered, internal);
+    REQUIRE(scattered.cols() == 2);
+    CHECK(solver.telemetry().size() == 2);
+    CHECK(scattered.col(0).isApprox(expected_sca, 1e-8));
+    CHECK(internal.col(0).isApprox(expected_int, 1e-8));
+
+    Vector<t_complex> expected, expected_internal;
+    solver::PreconditionedMatrix(geometry, std::make_shared<Excitation>(waves->wave(1)))
+        .solve(expected, expected_internal);
+    CHECK(scattered.col(1).isApprox(expected, 1e-8));
+    CHECK(internal.col(1).isApprox(expected_internal, 1e-8));
+
+    // the dense solver factorizes once for all waves
+    solver::PreconditionedMatrix const dense(geometry, waves);
+    Matrix<t_complex> dense_scattered, dense_internal;
+    dense.solve_waves(dense_scattered, dense_internal);
+    REQUIRE(dense_scattered.cols() == 2);
+    CHECK(dense_scattered.col(0).isApprox(expected_sca, 1e-8));
+    CHECK(dense_internal.col(0).isApprox(expected_int, 1e-8));
+    CHECK(dense_scattered.col(1).isApprox(expected, 1e-8));
+    CHECK(dense_internal.col(1).isApprox(expected_internal, 1e-8));
+
+    // solvers without support for several waves say so
+    solver::HierarchicalMatrix const hmatrix(geometry, waves);
+    CHECK_THROWS_AS(hmatrix.solve_waves(scattered, internal), std::runtime_error);
+  }
+
+  SECTION("p-multigrid preconditioner") {
+    auto const S = preconditioned_scattering_matrix(*geometry, excitation);
+    Vector<t_complex> const x = Vector<t_complex>::Random(S.cols());
+
+    // all harmonics in the coarse level is the exact inverse
+    PMultigrid const exact(geometry->objects, geometry->bground, excitation, nHarmonics);
+    CHECK(exact.coarse_rows() == exact.rows());
+    CHECK((exact * (S * x)).isApprox(x, 1e-10));
+
+    auto const fine = [&S](Vector<t_complex> const &in, Vector<t_complex> &out) { out = S * in; };
+    PMultigrid const multigrid(geometry->objects, geometry->bground, excitation, 1, fine);
+    CHECK(multigrid.rows() == S.cols());
+    CHECK(multigrid.coarse_rows() == 4 * 6);
+    Vector<t_complex> const coarse = Vector<t_complex>::Random(multigrid.coarse_rows());
+    CHECK(multigrid.restriction(multigrid.prolongation(coarse)) == coarse);
+    CHECK_THROWS_AS(PMultigrid(geometry->objects, geometry->bground, excitation, 0),
+                    std::runtime_error);
+
+    solver::Parameters parameters;
+    parameters.method = "fmm";
+    parameters.tolerance = 1e-12;
+    solver::FMMKrylov const plain(geometry, excitation, mpi::Communicator(), parameters);
+    parameters.preconditioner = "p-multigrid";
+    parameters.coarse_nmax = 2;
+    solver::FMMKrylov const solver(geometry, excitation, mpi::Communicator(), parameters);
+    REQUIRE(solver.preconditioner());
+
+    Vector<t_complex> sca, internal;
+    plain.solve(sca, internal);
+    solver.solve(sca, internal);
+    CHECK(solver.convergence().converged);
+    CHECK(solver.convergence().iterations < plain.convergence().iterations);
+    CHECK(sca.isApprox(expected_sca, 1e-8));
+    CHECK(internal.isApprox(expected_int, 1e-8));
+  }
+
+  SECTION("Inexact GMRES with relaxed couplings") {
+    solver::Parameters parameters;
+    parameters.method = "fmm";
+    parameters.tolerance = 1e-10;
+    parameters.inexact_levels = 3;
+    solver::FMMKrylov const solver(geometry, excitation, mpi::Communicator(), parameters);
+    REQUIRE(solver.relaxed().size() > 0);
+    REQUIRE(solver.relaxed().size() == solver.relaxed_errors().size());
+    CHECK(solver.relaxed().front()->couplings().size() < solver.fmm()->couplings().size());
+    CHECK(solver.relaxed_errors().front() > 0);
+
+    Vector<t_complex> sca, internal;
+    solver.solve(sca, internal);
+    CHECK(solver.convergence().converged);
+    REQUIRE(solver.applications().size() == solver.relaxed().size() + 1);
+    CHECK(sca.isApprox(expected_sca, 1e-8));
+    CHECK(internal.isApprox(expected_int, 1e-8));
+  }
+
+  SECTION("s-step GMRES") {
+    solver::Parameters parameters;
+    parameters.method = "fmm";
+    parameters.krylov = "s-step GMRES";
+    parameters.tolerance = 1e-12;
+    parameters.sstep = 5;
+    solver::FMMKrylov const solver(geometry, excitation, mpi::Communicator(), parameters);
+    Vector<t_complex> sca, internal;
+    solver.solve(sca, internal);
+    CHECK(solver.convergence().converged);
+    CHECK(sca.isApprox(expected_sca, 1e-8));
+    CHECK(internal.isApprox(expected_int, 1e-8));
+  }
+
+  SECTION("Block-Jacobi preconditioner") {
+    auto const S = preconditioned_scattering_matrix(*geometry, excitation);
+    Vector<t_complex> const x = Vector<t_complex>::Random(S.cols());
+
+    // a single cluster is the exact inverse
+    BlockJacobi const exact(geometry->objects, geometry->bground, excitation, S.cols());
+    CHECK(exact.clusters() == 1);
+    CHECK((exact * (S * x)).isApprox(x, 1e-10));
+
+    BlockJacobi const jacobi(geometry->objects, geometry->bground, excitation, 60);
+    CHECK(jacobi.clusters() == 2);
+    CHECK(jacobi.rows() == S.cols());
+
+    solver::Parameters parameters;
+    parameters.method = "fmm";
+    parameters.tolerance = 1e-12;
+    solver::FMMKrylov const plain(geometry, excitation, mpi::Communicator(), parameters);
+    parameters.preconditioner = "block-jacobi";
+    parameters.preconditioner_size = 60;
+    solver::FMMKrylov const solver(geometry, excitation, mpi::Communicator(), parameters);
+    REQUIRE(solver.preconditioner());
+
+    Vector<t_complex> sca, internal;
+    plain.solve(sca, internal);
+    solver.solve(sca, internal);
+    CHECK(solver.convergence().converged);
+    CHECK(solver.convergence().iterations < plain.convergence().iterations);
+    CHECK(sca.isApprox(expected_sca, 1e-8));
+    CHECK(internal.isApprox(expected_int, 1e-8));
+  }
+}
+
+TEST_CASE("Order-of-scattering solver") {
+  // dilute ensemble, for which the Foldy-Lax series converges
+  auto geometry = std::make_shared<Geometry>();
+  auto const nHarmonics = 3;
+  geometry->pushObject({{0, 0, 0}, {1.5e0, 1.0e0}, 0.3, nHarmonics});
+  geometry->pushObject({{3.0, 0.5, 0.2}, {2.0e0, 1.0e0}, 0.4, nHarmonics});
+  geometry->pushObject({{6.0, 1.0, 0.4}, {1.8e0, 1.0e0}, 0.3, nHarmonics});
+
+  auto const wavelength = 1.5;
+  Spherical<t_real> const vKinc{2 * consPi / wavelength, 0.3, 0.2};
+  auto const excitation = std::make_shared<Excitation>(
+      0, Tools::toProjection(vKinc, SphericalP<t_complex>{0e0, 1e0, 0e0}), vKinc, nHarmonics);
+  excitation->populate();
+  geometry->update(excitation);
+
+  Vector<t_complex> expected_sca, expected_int;
+  solver::PreconditionedMatrix(geometry, excitation).solve(expected_sca, expected_int);
+
+  solver::Parameters parameters;
+  parameters.method = "order-of-scattering";
+  parameters.tolerance = 1e-10;
+  for(std::string const coupling : {"fmm", "dense"}) {
+    SECTION(coupling) {
+      parameters.series_operator = coupling;
+      solver::OrderOfScattering const solver(geometry, excitation, mpi::Communicator(),
+                                             parameters);
+      Vector<t_complex> sca, internal;
+      solver.solve(sca, internal);
+      CHECK(not solver.fallback());
+      CHECK(not solver.diverged());
+      CHECK(solver.orders() > 0);
+      CHECK(solver.orders() < parameters.scattering_orders);
+      CHECK(solver.iterations() == solver.orders());
+      CHECK(solver.convergence().residual <= 1e-10);
+      REQUIRE(solver.telemetry().size() == 1);
+      CHECK(solver.telemetry().front().method == "order-of-scattering");
+      CHECK(solver.telemetry().front().residuals.size() == solver.orders() + 1);
+      CHECK(sca.isApprox(expected_sca, 1e-8));
+      CHECK(internal.isApprox(expected_int, 1e-8));
+    }
+  }
+
+  SECTION("Falls back to GMRES") {
+    parameters.scattering_orders = 1;
+    solver::OrderOfScattering const solver(geometry, excitation, mpi::Communicator(), parameters);
+    Vector<t_complex> sca, internal;
+    solver.solve(sca, internal);
+    CHECK(solver.fallback());
+    CHECK(not solver.diverged());
+    CHECK(solver.orders() == 1);
+    CHECK(solver.convergence().converged);
+    CHECK(solver.convergence().iterations > 0);
+    // the history of the series continues with that of GMRES
+    REQUIRE(solver.telemetry().size() == 1);
+    CHECK(solver.telemetry().front().method == "order-of-scattering then GMRES");
+    CHECK(solver.telemetry().front().iterations == solver.iterations());
+    CHECK(solver.telemetry().front().residuals.size() == solver.iterations() + 1);
+    CHECK(sca.isApprox(expected_sca, 1e-8));
+  }
+
+  SECTION("Diverging series falls back to GMRES") {
+    // touching high-index spheres, for which the residual grows from one order to the next
+    auto dense = std::make_shared<Geometry>();
+    dense->pushObject({{0, 0, 0}, {16e0, 1.0e0}, 0.5, nHarmonics});
+    dense->pushObject({{1.02, 0, 0}, {16e0, 1.0e0}, 0.5, nHarmonics});
+    dense->pushObject({{1.02, consPi / 2, 0}, {16e0, 1.0e0}, 0.5, nHarmonics});
+    dense->pushObject({{1.02 * std::sqrt(2e0), consPi / 4, 0}, {16e0, 1.0e0}, 0.5, nHarmonics});
+    Spherical<t_real> const vKdense{2 * consPi / 4.0, 0.3, 0.2};
+    auto const incident = std::make_shared<Excitation>(
+        0, Tools::toProjection(vKdense, SphericalP<t_complex>{0e0, 1e0, 0e0}), vKdense,
+        nHarmonics);
+    incident->populate();
+    dense->update(incident);
+
+    Vector<t_complex> expected, expected_internal;
+    solver::PreconditionedMatrix(dense, incident).solve(expected, expected_internal);
+
+    parameters.series_operator = "dense";
+    solver::OrderOfScattering const solver(dense, incident, mpi::Communicator(), parameters);
+    Vector<t_complex> sca, internal;
+    solver.solve(sca, internal);
+    CHECK(solver.fallback());
+    CHECK(solver.diverged());
+    CHECK(solver.orders() < parameters.scattering_orders);
+    CHECK(solver.convergence().converged);
+    CHECK(solver.telemetry().front().method == "order-of-scattering then GMRES");
+    CHECK(sca.isApprox(expected, 1e-8));
+  }
+
+  SECTION("Unknown coupling operator") {
+    parameters.series_operator = "hmatrix";
+    CHECK_THROWS_AS(
+        solver::OrderOfScattering(geometry, excitation, mpi::Communicator(), parameters),
+        std::runtime_error);
+  }
+}
+
+TEST_CASE("Convergence telemetry output") {
+  solver::Telemetry record("GMRES");
+  record.iterations = 2;
+  record.converged = true;
+  record.apply = 0.5;
+  record.preconditioner = 0.25;
+  record.finish({2, 1e-9, true, {1, 1e-4, 1e-9}}, 1);
+  CHECK(record.orthogonalization == Approx(0.25));
+  CHECK(record.true_residual == Approx(1e-9));
+
+  std::ostringstream header;
+  solver::telemetry_header(header, {"lambda"});
+  CHECK(header.str().substr(0, 2) == "# ");
+
+  std::ostringstream stream;
+  solver::write_telemetry(stream, {1.5}, {record, solver::Telemetry("TFQMR")});
+  std::istringstream lines(stream.str());
+  std::string line;
+  REQUIRE(std::getline(lines, line));
+  CHECK(line == "1.5\t0\tGMRES\t2\t1\t1\t0.5\t0.25\t0.25\t1e-09\t1,0.0001,1e-09");
+  REQUIRE(std::getline(lines, line));
+  CHECK(line == "1.5\t1\tTFQMR\t0\t0\t0\t0\t0\t0\t0\t");
+  CHECK(not std::getline(lines, line));
+}
+
+TEST_CASE("Warm start extrapolation") {
+  Vector<t_complex> const a = Vector<t_complex>::Random(5), b = Vector<t_complex>::Random(5),
+                          c = Vector<t_complex>::Random(5);
+  // quadratic in the step
+  auto const step = [&](t_real t) -> Vector<t_complex> { return a + t * b + t * t * c; };
+
+  WarmStart none(0);
+  none.push(step(0));
+  CHECK(none.guess().size() == 0);
+
+  WarmStart previous(1);
+  CHECK(previous.guess().size() == 0);
+  previous.push(step(0));
+  previous.push(step(1));
+  CHECK(previous.guess().isApprox(step(1)));
+
+  WarmStart linear(2);
+  linear.push(step(0));
+  CHECK(linear.guess().isApprox(step(0)));
+  linear.push(step(1));
+  CHECK(linear.guess().isApprox(2e0 * step(1) - step(0)));
+
+  WarmStart quadratic(3);
+  for(t_uint i(0); i < 5; ++i)
+    quadratic.push(step(i));
+  CHECK(quadratic.guess().isApprox(step(5)));
+  quadratic.reset();
+  CHECK(quadratic.guess().size() == 0);
+
+  // changes of size restart the history
+  quadratic.push(step(0));
+  quadratic.push(Vector<t_complex>::Ones(2));
+  CHECK(quadratic.guess().isApprox(Vector<t_complex>::Ones(2)));
+}
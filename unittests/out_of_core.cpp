@@ -0,0 +1,100 @@
+// (C) University College London 2017
+// This file is part of Optimet, licensed under the terms of the GNU Public License
+//
+// Optimet is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Optimet is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Optimet. If not, see <http://www.gnu.org/licenses/>.
+
+#include "catch.hpp"
+
+#include "Geometry.h"
+#include "OutOfCoreSolver.h"
+#include "PreconditionedMatrixSolver.h"
+#include "Run.h"
+#include "Solver.h"
+#include "TileStore.h"
+#include "Tools.h"
+#include "Types.h"
+#include "constants.h"
+#include <fstream>
+
+using namespace optimet;
+
+TEST_CASE("Tile store") {
+  t_uint const N = 11;
+  Matrix<t_complex> const A = Matrix<t_complex>::Random(N, N);
+  std::string path;
+  {
+    TileStore store(N, 4, 2);
+    path = store.path();
+    CHECK(std::ifstream(path).good());
+    CHECK(store.tiles() == 3);
+    CHECK(store.width(2) == 3);
+    for(t_uint J(0); J < store.tiles(); ++J)
+      store.panel(J, A.middleCols(store.start(J), store.width(J)));
+    CHECK(store.bytes_written() == N * N * sizeof(t_complex));
+
+    // cache holds only two tiles, so most reads come from disk, some in the background
+    store.prefetch(1);
+    CHECK(store.panel(0).isApprox(A.leftCols(4)));
+    CHECK(store.panel(1).isApprox(A.middleCols(4, 4)));
+    CHECK(store.panel(2).isApprox(A.rightCols(3)));
+    CHECK(store.tile(2, 1).isApprox(A.block(8, 4, 3, 4)));
+    CHECK(store.bytes_read() > 0);
+  }
+  CHECK(not std::ifstream(path).good());
+}
+
+TEST_CASE("Out-of-core solver") {
+  auto geometry = std::make_shared<Geometry>();
+  auto const nHarmonics = 2;
+  geometry->pushObject({{0, 0, 0}, {1.5e0, 1.0e0}, 0.5, nHarmonics});
+  geometry->pushObject({{1.5, 0.5, 0.2}, {2.0e0, 1.0e0}, 0.6, nHarmonics});
+  geometry->pushObject({{3.0, 1.0, 0.4}, {1.8e0, 1.0e0}, 0.4, nHarmonics});
+  geometry->pushObject({{3.0, 2.0, 2.5}, {1.5e0, 1.0e0}, 0.5, nHarmonics});
+  geometry->pushObject({{4.5, 0.8, 3.0}, {2.2e0, 1.0e0}, 0.3, 1});
+
+  auto const wavelength = 1.5;
+  Spherical<t_real> const vKinc{2 * consPi / wavelength, 0.3, 0.2};
+  auto const excitation = std::make_shared<Excitation>(
+      0, Tools::toProjection(vKinc, SphericalP<t_complex>{0e0, 1e0, 0e0}), vKinc, nHarmonics);
+  excitation->populate();
+  geometry->update(excitation);
+
+  Vector<t_complex> expected_sca, expected_int;
+  solver::PreconditionedMatrix(geometry, excitation).solve(expected_sca, expected_int);
+
+  // at most two scatterers per tile, three panels, and a cache smaller than a panel
+  solver::Parameters parameters;
+  parameters.method = "out-of-core";
+  parameters.tile_size = 36;
+  parameters.cache_tiles = 2;
+  solver::OutOfCore const solver(geometry, excitation, mpi::Communicator(), parameters);
+  CHECK(solver.tiles() == 3);
+  CHECK(solver.io_bytes() > 0);
+
+  Vector<t_complex> sca, internal;
+  solver.solve(sca, internal);
+  CHECK(sca.isApprox(expected_sca, 1e-10));
+  CHECK(internal.isApprox(expected_int, 1e-10));
+
+  SECTION("Factory") {
+    Run run;
+    run.geometry = geometry;
+    run.excitation = excitation;
+    run.solver_params = parameters;
+    CHECK(std::dynamic_pointer_cast<solver::OutOfCore>(solver::factory(run)));
+
+    run.solver_params.method = "out-of-cores";
+    CHECK_THROWS_AS(solver::factory(run), std::runtime_error);
+  }
+}
@@ -310,21 +310,36 @@ TEST_CASE("MPI vs serial FMM") {
     CHECK(transpose_parallel_out.isApprox(transpose_serial_output));
   }
 
+  SECTION("Several columns at once") {
+    mpi::FastMatrixMultiply parallel(wavenumber, scatterers, world);
+    // by default, the distribution balances the cost of the couplings
+    auto const owned = parallel.distribution().array() == world.rank();
+    auto const balanced_input = split(scatterers, owned, serial_input);
+    CHECK(parallel(balanced_input).isApprox(split(scatterers, owned, serial(serial_input))));
+    Matrix<t_complex> input(balanced_input.size(), 3);
+    input << balanced_input, 2e0 * balanced_input, balanced_input.conjugate();
+    Matrix<t_complex> output;
+    parallel(input, output);
+    REQUIRE(output.cols() == 3);
+    for(t_uint i(0); i < 3; ++i)
+      CHECK(output.col(i).isApprox(parallel(Vector<t_complex>(input.col(i)))));
+  }
+
   SECTION("Conjugate operation") {
     mpi::FastMatrixMultiply parallel(wavenumber, scatterers, world);
 
-    auto const expected =
-        split(scatterers, distribution.array() == world.rank(), serial.conjugate(serial_input));
-    auto const actual = parallel.conjugate(parallel_input);
+    auto const owned = parallel.distribution().array() == world.rank();
+    auto const expected = split(scatterers, owned, serial.conjugate(serial_input));
+    auto const actual = parallel.conjugate(split(scatterers, owned, serial_input));
     CHECK(actual.isApprox(expected));
   }
 
   SECTION("Adjoint operation") {
     mpi::FastMatrixMultiply parallel(wavenumber, scatterers, world);
 
-    auto const expected =
-        split(scatterers, distribution.array() == world.rank(), serial.adjoint(serial_input));
-    auto const actual = parallel.adjoint(parallel_input);
+    auto const owned = parallel.distribution().array() == world.rank();
+    auto const expected = split(scatterers, owned, serial.adjoint(serial_input));
+    auto const actual = parallel.adjoint(split(scatterers, owned, serial_input));
     CHECK(actual.isApprox(expected));
   }
 }
@@ -356,6 +371,9 @@ TEST_CASE("FMM solver vs serial solver") {
   solver.belos_parameters()->set("Maximum Iterations", 4000);
   solver.belos_parameters()->set("Convergence Tolerance", 1.0e-10);
   solver.solve(parallel.scatter_coef, parallel.internal_coef);
+  REQUIRE(solver.telemetry().size() == 1);
+  CHECK(solver.telemetry().front().converged);
+  CHECK(solver.telemetry().front().apply > 0);
 
   optimet::Result serial(geometry, excitation);
   optimet::solver::PreconditionedMatrix const serial_solver(geometry, excitation, world);
@@ -371,6 +389,140 @@ TEST_CASE("FMM solver vs serial solver") {
   CHECK(parallel.internal_coef.isApprox(serial.internal_coef, internal_tol));
 }
 
+TEST_CASE("s-step GMRES FMM solver") {
+  using namespace optimet;
+  auto const nHarmonics = 5;
+  auto geometry = std::make_shared<Geometry>();
+  for(t_uint i(0); i < 5; ++i)
+    geometry->pushObject(
+        {{static_cast<t_real>(i) * 1.5 * 2e-6, 0, 0}, {5e0, 1.1e0}, 0.5 * 2e-6, nHarmonics});
+  auto const wavelength = 14960e-9;
+  Spherical<t_real> const vKinc{2 * consPi / wavelength, 90 * consPi / 180.0, 90 * consPi / 180.0};
+  auto const excitation = std::make_shared<Excitation>(
+      0, Tools::toProjection(vKinc, SphericalP<t_complex>{0e0, 1e0, 0e0}), vKinc, nHarmonics);
+  excitation->populate();
+  geometry->update(excitation);
+
+  optimet::mpi::Communicator world;
+  solver::Parameters parameters;
+  parameters.sstep = 4;
+  auto belos_parameters = Teuchos::rcp(new Teuchos::ParameterList);
+  belos_parameters->set("Solver", "s-step GMRES");
+  belos_parameters->set<int>("Num Blocks", 100);
+  belos_parameters->set("Maximum Iterations", 4000);
+  belos_parameters->set("Convergence Tolerance", 1.0e-10);
+  optimet::Result parallel(geometry, excitation);
+  optimet::solver::FMMBelos const solver(geometry, excitation, world, belos_parameters,
+                                         std::numeric_limits<t_int>::max(), parameters);
+  solver.solve(parallel.scatter_coef, parallel.internal_coef);
+  CHECK(solver.iterations() > 0);
+  REQUIRE(solver.telemetry().size() == 1);
+  CHECK(solver.telemetry().front().iterations == solver.iterations());
+  CHECK(solver.telemetry().front().residuals.size() == solver.iterations() + 1);
+  CHECK(solver.telemetry().front().apply > 0);
+
+  optimet::Result serial(geometry, excitation);
+  optimet::solver::PreconditionedMatrix(geometry, excitation, world)
+      .solve(serial.scatter_coef, serial.internal_coef);
+  auto const tolerance = 1e-6 * std::max(1., serial.scatter_coef.array().abs().maxCoeff());
+  CHECK(parallel.scatter_coef.isApprox(serial.scatter_coef, tolerance));
+}
+
+TEST_CASE("Block FMM solver over several incident waves") {
+  using namespace optimet;
+  auto const nHarmonics = 4;
+  auto geometry = std::make_shared<Geometry>();
+  for(t_uint i(0); i < 4; ++i)
+    geometry->pushObject(
+        {{static_cast<t_real>(i) * 1.5 * 2e-6, 0, 0}, {5e0, 1.1e0}, 0.5 * 2e-6, nHarmonics});
+
+  auto const wavelength = 14960e-9;
+  Spherical<t_real> const vKinc{2 * consPi / wavelength, 90 * consPi / 180.0, 90 * consPi / 180.0};
+  auto const excitation = std::make_shared<Excitation>(
+      0, Tools::toProjection(vKinc, SphericalP<t_complex>{0e0, 1e0, 0e0}), vKinc, nHarmonics);
+  excitation->populate();
+  for(auto const theta : {30e0, 60e0}) {
+    Spherical<t_real> const direction{0, theta * consPi / 180.0, 45 * consPi / 180.0};
+    excitation->add_wave(direction,
+                         Tools::toProjection(direction, SphericalP<t_complex>{0e0, 0e0, 1e0}));
+  }
+  geometry->update(excitation);
+
+  optimet::mpi::Communicator world;
+  optimet::solver::FMMBelos solver(geometry, excitation, world);
+  solver.belos_parameters()->set("Solver", "GMRES");
+  solver.belos_parameters()->set<int>("Num Blocks", 100);
+  solver.belos_parameters()->set("Maximum Iterations", 4000);
+  solver.belos_parameters()->set("Convergence Tolerance", 1.0e-10);
+  Matrix<t_complex> scattered, internal;
+  solver.solve_waves(scattered, internal);
+  REQUIRE(scattered.cols() == 3);
+  REQUIRE(internal.cols() == 3);
+
+  for(t_uint i(0); i < 3; ++i) {
+    auto const wave = std::make_shared<Excitation>(excitation->wave(i));
+    Vector<t_complex> expected_sca, expected_int;
+    optimet::solver::PreconditionedMatrix(geometry, wave, world)
+        .solve(expected_sca, expected_int);
+    auto const tolerance = 1e-6 * std::max(1., expected_sca.array().abs().maxCoeff());
+    CHECK(scattered.col(i).isApprox(expected_sca, tolerance));
+  }
+}
+
+TEST_CASE("Block-Jacobi preconditioned FMM solver") {
+  using namespace optimet;
+  auto const nHarmonics = 5;
+  auto geometry = std::make_shared<Geometry>();
+  for(t_uint i(0); i < 6; ++i)
+    geometry->pushObject(
+        {{static_cast<t_real>(i) * 1.1 * 2e-6, 0, 0}, {5e0, 1.1e0}, 0.5 * 2e-6, nHarmonics});
+  auto const wavelength = 14960e-9;
+  Spherical<t_real> const vKinc{2 * consPi / wavelength, 90 * consPi / 180.0, 90 * consPi / 180.0};
+  auto const excitation = std::make_shared<Excitation>(
+      0, Tools::toProjection(vKinc, SphericalP<t_complex>{0e0, 1e0, 0e0}), vKinc, nHarmonics);
+  excitation->populate();
+  geometry->update(excitation);
+
+  optimet::mpi::Communicator world;
+  auto const belos_parameters = [] {
+    auto result = Teuchos::rcp(new Teuchos::ParameterList);
+    result->set("Solver", "GMRES");
+    result->set<int>("Num Blocks", 500);
+    result->set("Maximum Iterations", 4000);
+    result->set("Convergence Tolerance", 1.0e-10);
+    return result;
+  };
+  optimet::Result unpreconditioned(geometry, excitation);
+  optimet::solver::FMMBelos const reference(geometry, excitation, world, belos_parameters());
+  reference.solve(unpreconditioned.scatter_coef, unpreconditioned.internal_coef);
+
+  // two spheres per cluster
+  solver::Parameters parameters;
+  parameters.preconditioner = "block-jacobi";
+  parameters.preconditioner_size = 140;
+  optimet::Result preconditioned(geometry, excitation);
+  optimet::solver::FMMBelos const solver(geometry, excitation, world, belos_parameters(),
+                                         std::numeric_limits<t_int>::max(), parameters);
+  REQUIRE(solver.preconditioner());
+  solver.solve(preconditioned.scatter_coef, preconditioned.internal_coef);
+
+  CHECK(solver.iterations() <= reference.iterations());
+  auto const tol = 1e-6 * std::max(1., unpreconditioned.scatter_coef.array().abs().maxCoeff());
+  CHECK(preconditioned.scatter_coef.isApprox(unpreconditioned.scatter_coef, tol));
+
+  SECTION("p-multigrid") {
+    parameters.preconditioner = "p-multigrid";
+    parameters.coarse_nmax = 2;
+    optimet::Result multigrid(geometry, excitation);
+    optimet::solver::FMMBelos const solver(geometry, excitation, world, belos_parameters(),
+                                           std::numeric_limits<t_int>::max(), parameters);
+    REQUIRE(solver.preconditioner());
+    solver.solve(multigrid.scatter_coef, multigrid.internal_coef);
+    CHECK(solver.iterations() <= reference.iterations());
+    CHECK(multigrid.scatter_coef.isApprox(unpreconditioned.scatter_coef, tol));
+  }
+}
+
 TEST_CASE("Parallel matrix vs serial matrix") {
   using namespace optimet;
   mpi::Communicator const world;
@@ -396,8 +548,7 @@ TEST_CASE("Parallel matrix vs serial matrix") {
   auto const diags = std::max<int>(1, geometry->objects.size() / 2 - 2);
   mpi::FastMatrixMultiply parallel(geometry->bground, excitation->wavenumber(), geometry->objects,
                                    diags, world);
-  auto const distribution =
-      mpi::details::vector_distribution(geometry->objects.size(), world.size());
+  auto const &distribution = parallel.distribution();
   auto const size = serial.cols();
 
   for(t_int i(0); i < size; ++i) {
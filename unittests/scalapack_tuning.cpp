@@ -0,0 +1,91 @@
+// (C) University College London 2017
+// This file is part of Optimet, licensed under the terms of the GNU Public License
+//
+// Optimet is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Optimet is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Optimet. If not, see <http://www.gnu.org/licenses/>.
+
+#include "catch.hpp"
+#include <cstdio>
+
+#include "Types.h"
+#include "mpi/Communicator.h"
+#include "scalapack/Tuning.h"
+
+using namespace optimet;
+
+TEST_CASE("Candidate layouts") {
+  auto const candidates = scalapack::tuning_candidates(256, 6);
+  CHECK(candidates.size() > 0);
+  for(auto const &candidate : candidates) {
+    CHECK(candidate.grid.rows * candidate.grid.cols <= 6);
+    CHECK(candidate.block_size * std::max(candidate.grid.rows, candidate.grid.cols) <= 256);
+  }
+  // too small for any block but the smallest
+  for(auto const &candidate : scalapack::tuning_candidates(2, 4))
+    CHECK(candidate.block_size == 16);
+}
+
+TEST_CASE("Tuning file") {
+  mpi::Communicator const world;
+  std::string const filename = "scalapack_tuning_test.tuning";
+  if(world.is_root()) {
+    std::remove(filename.c_str());
+    scalapack::Parameters parameters(32, {1, 2});
+    scalapack::write_tuning(filename, 100, 2, scalapack::Workload::factorization, parameters);
+    scalapack::write_tuning(filename, 100, 2, scalapack::Workload::multiplication,
+                            scalapack::Parameters(16, {2, 1}));
+    parameters.block_size = 128;
+    scalapack::write_tuning(filename, 100, 2, scalapack::Workload::factorization, parameters);
+
+    scalapack::Parameters result;
+    CHECK(scalapack::read_tuning(filename, 100, 2, scalapack::Workload::factorization, result));
+    CHECK(result.block_size == 128);
+    CHECK(result.grid.rows == 1);
+    CHECK(result.grid.cols == 2);
+    CHECK(scalapack::read_tuning(filename, 100, 2, scalapack::Workload::multiplication, result));
+    CHECK(result.block_size == 16);
+    CHECK(result.grid.rows == 2);
+    CHECK(not scalapack::read_tuning(filename, 101, 2, scalapack::Workload::factorization,
+                                     result));
+    std::remove(filename.c_str());
+  }
+  world.barrier();
+}
+
+TEST_CASE("Autotune") {
+  mpi::Communicator const world;
+  scalapack::Parameters parameters;
+  parameters.tuning_file = "scalapack_autotune_test.tuning";
+  parameters.trial_size = 64;
+  if(world.is_root())
+    std::remove(parameters.tuning_file.c_str());
+  world.barrier();
+
+  auto const tuned =
+      scalapack::autotune(200, scalapack::Workload::factorization, world, parameters);
+  CHECK(tuned.grid.rows * tuned.grid.cols <= world.size());
+  CHECK(tuned.grid.rows * tuned.grid.cols > 0);
+  CHECK(world.broadcast(tuned.block_size) == tuned.block_size);
+  CHECK(world.broadcast(tuned.grid.rows) == tuned.grid.rows);
+
+  // second call reads the cached value
+  auto const cached =
+      scalapack::autotune(200, scalapack::Workload::factorization, world, parameters);
+  CHECK(cached.block_size == tuned.block_size);
+  CHECK(cached.grid.rows == tuned.grid.rows);
+  CHECK(cached.grid.cols == tuned.grid.cols);
+
+  world.barrier();
+  if(world.is_root())
+    std::remove(parameters.tuning_file.c_str());
+}
@@ -18,9 +18,13 @@
 #include <iostream>
 
 #include "Aliases.h"
+#include "AuxCoefficients.h"
+#include "Coupling.h"
 #include "Geometry.h"
 #include "Scatterer.h"
 #include "PreconditionedMatrix.h"
+#include "PreconditionedMatrixSolver.h"
+#include "Threads.h"
 #include "Tools.h"
 #include "Types.h"
 #include "constants.h"
@@ -117,3 +121,294 @@ TEST_CASE("Two spheres") {
     CHECK(AB.diagonal().isApprox(BA.diagonal()));
   }
 }
+
+TEST_CASE("Scattering matrix blocks") {
+  auto geometry = std::make_shared<Geometry>();
+  auto const nHarmonics = 3;
+  geometry->pushObject({{0, 0, 0}, {1.5e0, 1.0e0}, 0.5, nHarmonics});
+  geometry->pushObject({{1.5, 0.5, 0.2}, {2.0e0, 1.0e0}, 0.6, nHarmonics});
+  geometry->pushObject({{3.0, 1.2, 2.2}, {2.5e0, 1.0e0}, 0.4, nHarmonics});
+
+  Spherical<t_real> const vKinc{2 * consPi / 1.5, 0.3, 0.2};
+  auto const excitation = std::make_shared<Excitation>(
+      0, Tools::toProjection(vKinc, SphericalP<t_complex>{0e0, 1e0, 0e0}), vKinc, nHarmonics);
+  excitation->populate();
+  geometry->update(excitation);
+
+  auto const S = preconditioned_scattering_matrix(*geometry, excitation);
+  auto const n = nHarmonics * (nHarmonics + 2);
+  // each block computed independently from the coupling coefficients
+  for(t_uint i(0); i < geometry->objects.size(); ++i)
+    for(t_uint j(0); j < geometry->objects.size(); ++j) {
+      auto const &first = geometry->objects[i];
+      auto const &second = geometry->objects[j];
+      Matrix<t_complex> expected = Matrix<t_complex>::Identity(2 * n, 2 * n);
+      if(i != j) {
+        Coupling const AB(first.vR - second.vR, excitation->waveK, nHarmonics);
+        expected << AB.diagonal.transpose(), AB.offdiagonal.transpose(),
+            AB.offdiagonal.transpose(), AB.diagonal.transpose();
+        Vector<t_complex> const factor = -second.getTLocal(excitation->omega(), geometry->bground);
+        expected = expected * factor.asDiagonal();
+      }
+      CHECK(S.block(2 * n * i, 2 * n * j, 2 * n, 2 * n).isApprox(expected, 1e-10));
+    }
+}
+
+TEST_CASE("Threaded assembly") {
+  auto geometry = std::make_shared<Geometry>();
+  auto const nHarmonics = 2;
+  for(t_int i(0); i < 48; ++i) {
+    Eigen::Matrix<t_real, 3, 1> const x(1.2 * (i % 4), 1.2 * ((i / 4) % 4), 1.2 * (i / 16));
+    geometry->pushObject(
+        {Spherical<t_real>::toSpherical(x), {1.8e0, 1.0e0}, 0.5, static_cast<t_uint>(nHarmonics)});
+  }
+  Spherical<t_real> const vKinc{2 * consPi / 1.5, 0.3, 0.2};
+  auto const excitation = std::make_shared<Excitation>(
+      0, Tools::toProjection(vKinc, SphericalP<t_complex>{0e0, 1e0, 0e0}), vKinc, nHarmonics);
+  excitation->populate();
+  geometry->update(excitation);
+
+  // the Bessel functions are not reentrant, so threads must not corrupt one another's values
+  auto const threads = dense_threads();
+  dense_threads(1);
+  Matrix<t_complex> const serial = preconditioned_scattering_matrix(*geometry, excitation);
+  Matrix<t_complex> const symmetric = symmetric_scattering_matrix(*geometry, excitation).unpack();
+  dense_threads(8);
+  Matrix<t_complex> const threaded = preconditioned_scattering_matrix(*geometry, excitation);
+  Matrix<t_complex> const threaded_symmetric =
+      symmetric_scattering_matrix(*geometry, excitation).unpack();
+  dense_threads(threads);
+  CHECK(threaded == serial);
+  CHECK(threaded_symmetric == symmetric);
+
+  // exceptions thrown by an iteration reach the caller
+  CHECK_THROWS_AS(parallel_for(16,
+                               [](t_int i) {
+                                 if(i == 5)
+                                   throw std::runtime_error("iteration 5");
+                               }),
+                  std::runtime_error);
+}
+
+TEST_CASE("Plane-wave local expansion") {
+  auto const nHarmonics = 2;
+  auto const nLarge = 20;
+  Spherical<t_real> const vKinc{2 * consPi / 1.3, 0.7, 1.1};
+  SphericalP<t_complex> const Eaux{0e0, 1e0, 0.3};
+  Excitation excitation(0, Tools::toProjection(vKinc, Eaux), vKinc, nLarge);
+  excitation.populate();
+
+  Spherical<t_real> const position(1.7, 2.1, -0.4);
+  auto const n = Tools::iteratorMax(nHarmonics);
+  Vector<t_complex> actual(2 * n);
+  excitation.getIncLocal(position, actual.data(), nHarmonics);
+
+  // translation-addition theorem converges towards the exact phase shift
+  Coupling const coupling(position, excitation.waveK, nLarge, false);
+  Vector<t_complex> const a = coupling.diagonal.transpose() * excitation.dataIncAp +
+                              coupling.offdiagonal.transpose() * excitation.dataIncBp;
+  Vector<t_complex> const b = coupling.offdiagonal.transpose() * excitation.dataIncAp +
+                              coupling.diagonal.transpose() * excitation.dataIncBp;
+  CHECK(actual.head(n).isApprox(a.head(n), 1e-5));
+  CHECK(actual.tail(n).isApprox(b.head(n), 1e-5));
+}
+
+TEST_CASE("Second harmonic local sources") {
+  Geometry geometry;
+  auto const nHarmonics = 3;
+  geometry.pushObject({{0, 0, 0}, {1.1e0, 1.0e0}, 0.5, nHarmonics});
+  geometry.pushObject({{1.5, 0.3, 0}, {1.1e0, 1.0e0}, 0.5, nHarmonics});
+  geometry.pushObject({{1.5, 1.2, 2.1}, {1.1e0, 1.0e0}, 0.5, nHarmonics});
+  for(auto &object : geometry.objects)
+    Eigen::Map<Vector<t_complex>>(object.sourceCoef.data(), object.sourceCoef.size()) =
+        Vector<t_complex>::Random(object.sourceCoef.size());
+
+  auto const wavelength = 2.0;
+  Spherical<t_real> const vKinc{2 * consPi / wavelength, 0, 0};
+  SphericalP<t_complex> const Eaux{0e0, 1e0, 0e0};
+  auto const excitation =
+      std::make_shared<Excitation>(0, Tools::toProjection(vKinc, Eaux), vKinc, nHarmonics);
+
+  // Near each object, the field radiated by the sources of the others must match the regular
+  // expansion with the local sources. Harmonics beyond nMax contribute O((kr)^nMax).
+  auto const n = Tools::iteratorMax(nHarmonics);
+  auto const r = 1e-2 / std::abs(excitation->waveK);
+  AuxCoefficientsWorkspace workspace(nHarmonics);
+  for(t_uint i(0); i < geometry.objects.size(); ++i) {
+    Vector<t_complex> local(2 * n);
+    geometry.getSourceLocal(i, excitation, nHarmonics, local.data());
+
+    for(auto const &offset : {Spherical<t_real>(r, 0.3, 0.4), Spherical<t_real>(r, 2.0, -1.0)}) {
+      Eigen::Matrix<t_real, 3, 1> const point =
+          geometry.objects[i].vR.toEigenCartesian() + offset.toEigenCartesian();
+      Eigen::Matrix<t_complex, 3, 1> radiated = Eigen::Matrix<t_complex, 3, 1>::Zero();
+      for(t_uint j(0); j < geometry.objects.size(); ++j) {
+        if(i == j)
+          continue;
+        Eigen::Matrix<t_real, 3, 1> const x = point - geometry.objects[j].vR.toEigenCartesian();
+        workspace.compute(Spherical<t_real>::toSpherical(x), excitation->waveK, false);
+        Eigen::Map<Vector<t_complex> const> const source(geometry.objects[j].sourceCoef.data(),
+                                                         2 * n);
+        radiated += workspace.M() * source.head(n) + workspace.N() * source.tail(n);
+      }
+      workspace.compute(offset, excitation->waveK, true);
+      Eigen::Matrix<t_complex, 3, 1> const expanded =
+          workspace.M() * local.head(n) + workspace.N() * local.tail(n);
+      CHECK(expanded.isApprox(radiated, 1e-6));
+    }
+  }
+}
+
+TEST_CASE("Dense solver factorizations") {
+  auto geometry = std::make_shared<Geometry>();
+  auto const nHarmonics = 3;
+  geometry->pushObject({{0, 0, 0}, {1.5e0, 1.0e0}, 0.5, nHarmonics});
+  geometry->pushObject({{1.5, 0.5, 0.2}, {2.0e0, 1.0e0}, 0.6, nHarmonics});
+
+  auto const wavelength = 1.5;
+  Spherical<t_real> const vKinc{2 * consPi / wavelength, 0.3, 0.2};
+  auto const excitation = std::make_shared<Excitation>(
+      0, Tools::toProjection(vKinc, SphericalP<t_complex>{0e0, 1e0, 0e0}), vKinc, nHarmonics);
+  excitation->populate();
+  geometry->update(excitation);
+  auto const other = std::make_shared<Excitation>(
+      0, Tools::toProjection(vKinc, SphericalP<t_complex>{0e0, 0e0, 1e0}), vKinc, nHarmonics);
+  other->populate();
+
+  solver::PreconditionedMatrix lu(geometry, excitation);
+  solver::PreconditionedMatrix const qr(geometry, excitation, mpi::Communicator(),
+                                        solver::Factorization::QR);
+  CHECK(lu.factorization() == solver::Factorization::LU);
+  CHECK(qr.factorization() == solver::Factorization::QR);
+
+  Vector<t_complex> lu_sca, lu_int, qr_sca, qr_int;
+  lu.solve(lu_sca, lu_int);
+  qr.solve(qr_sca, qr_int);
+  CHECK(lu_sca.isApprox(qr_sca, 1e-10));
+  CHECK(lu_int.isApprox(qr_int, 1e-10));
+
+  SECTION("Factorization is reused") {
+    Vector<t_complex> sca, internal;
+    lu.solve(sca, internal);
+    CHECK(sca.isApprox(lu_sca));
+    lu.factorization(solver::Factorization::QR);
+    lu.solve(sca, internal);
+    CHECK(sca.isApprox(qr_sca, 1e-10));
+  }
+
+  SECTION("Mixed-precision refinement") {
+    solver::PreconditionedMatrix const mixed(geometry, excitation, mpi::Communicator(),
+                                             solver::Factorization::MIXED);
+    Vector<t_complex> sca, internal;
+    mixed.solve(sca, internal);
+    CHECK(not mixed.refinement_stalled());
+    CHECK(sca.isApprox(lu_sca, 1e-8));
+    CHECK(internal.isApprox(lu_int, 1e-8));
+
+    solver::PreconditionedMatrix const fallback(
+        geometry, excitation, mpi::Communicator(),
+        solver::Parameters(solver::Factorization::MIXED, 1e-20, 2));
+    fallback.solve(sca, internal);
+    CHECK(fallback.refinement_stalled());
+    CHECK(sca.isApprox(lu_sca));
+  }
+
+  SECTION("Complex-symmetric LDLT") {
+    auto const M = symmetric_scattering_matrix(*geometry, excitation);
+    Matrix<t_complex> expected = preconditioned_scattering_matrix(*geometry, excitation);
+    auto const scaling = symmetric_scaling(*geometry, excitation);
+    expected = scaling.asDiagonal() * expected * scaling.cwiseInverse().asDiagonal();
+    reciprocity_permutation(expected, nHarmonics);
+    CHECK(expected.isApprox(expected.transpose(), 1e-10));
+    Matrix<t_complex> const lower = M.unpack();
+    CHECK(lower.isApprox(Matrix<t_complex>(expected.triangularView<Eigen::Lower>()), 1e-10));
+
+    solver::PreconditionedMatrix const ldlt(geometry, excitation, mpi::Communicator(),
+                                            solver::Factorization::LDLT);
+    Vector<t_complex> sca, internal;
+    ldlt.solve(sca, internal);
+    CHECK(sca.isApprox(lu_sca, 1e-10));
+    CHECK(internal.isApprox(lu_int, 1e-10));
+  }
+
+  SECTION("Multiple right-hand-sides") {
+    Matrix<t_complex> Q(lu_sca.size(), 2);
+    Q.col(0) = source_vector(*geometry, excitation);
+    Q.col(1) = source_vector(*geometry, other);
+    Matrix<t_complex> sca, internal;
+    lu.solve(Q, sca, internal);
+    REQUIRE(sca.cols() == 2);
+    CHECK(sca.col(0).isApprox(lu_sca));
+    CHECK(internal.col(0).isApprox(lu_int));
+
+    lu.update(geometry, other);
+    Vector<t_complex> other_sca, other_int;
+    lu.solve(other_sca, other_int);
+    CHECK(sca.col(1).isApprox(other_sca));
+    CHECK(internal.col(1).isApprox(other_int));
+  }
+}
+
+TEST_CASE("Scatterers with different number of harmonics") {
+  auto geometry = std::make_shared<Geometry>();
+  geometry->pushObject({{0, 0, 0}, {1.5e0, 1.0e0}, 0.5, 3});
+  geometry->pushObject({{1.5, 0.5, 0.2}, {2.0e0, 1.0e0}, 0.3, 1});
+  geometry->pushObject({{3.0, 1.0, 0.4}, {1.8e0, 1.0e0}, 0.4, 2});
+
+  auto const wavelength = 1.5;
+  Spherical<t_real> const vKinc{2 * consPi / wavelength, 0.3, 0.2};
+  auto const excitation = std::make_shared<Excitation>(
+      0, Tools::toProjection(vKinc, SphericalP<t_complex>{0e0, 1e0, 0e0}), vKinc, 3);
+  excitation->populate();
+  geometry->update(excitation);
+
+  auto const offsets = scatterer_offsets(geometry->objects.begin(), geometry->objects.end());
+  CHECK(offsets == std::vector<t_uint>({0, 30, 36, 52}));
+  CHECK(geometry->scatterer_size() == 52);
+
+  // each scatterer's local incident field is truncated at its own nMax
+  auto const Q = source_vector(*geometry, excitation);
+  REQUIRE(Q.size() == 52);
+  for(t_uint i(0); i < geometry->objects.size(); ++i) {
+    auto const nMax = geometry->objects[i].nMax;
+    Vector<t_complex> expected(2 * nMax * (nMax + 2));
+    excitation->getIncLocal(geometry->objects[i].vR, expected.data(), nMax);
+    CHECK(Q.segment(offsets[i], offsets[i + 1] - offsets[i]).isApprox(expected));
+  }
+
+  // the matrix is that of the largest nMax, restricted to the harmonics of each scatterer
+  auto uniform = std::make_shared<Geometry>();
+  for(auto const &object : geometry->objects)
+    uniform->pushObject({object.vR, object.elmag, object.radius, 3});
+  uniform->update(excitation);
+  auto const S = preconditioned_scattering_matrix(*geometry, excitation);
+  auto const S_uniform = preconditioned_scattering_matrix(*uniform, excitation);
+  for(t_uint i(0); i < geometry->objects.size(); ++i)
+    for(t_uint j(0); j < geometry->objects.size(); ++j) {
+      auto const ni = offsets[i + 1] - offsets[i], nj = offsets[j + 1] - offsets[j];
+      auto const expected = S_uniform.block(30 * i, 30 * j, 30, 30);
+      auto const actual = S.block(offsets[i], offsets[j], ni, nj);
+      CHECK(actual.topLeftCorner(ni / 2, nj / 2).isApprox(expected.topLeftCorner(ni / 2, nj / 2)));
+      CHECK(actual.bottomRightCorner(ni / 2, nj / 2)
+                .isApprox(expected.block(15, 15, ni / 2, nj / 2)));
+      CHECK(actual.topRightCorner(ni / 2, nj / 2).isApprox(expected.block(0, 15, ni / 2, nj / 2)));
+    }
+
+  solver::PreconditionedMatrix const lu(geometry, excitation);
+  solver::PreconditionedMatrix const ldlt(geometry, excitation, mpi::Communicator(),
+                                          solver::Factorization::LDLT);
+  Vector<t_complex> lu_sca, lu_int, ldlt_sca, ldlt_int;
+  lu.solve(lu_sca, lu_int);
+  ldlt.solve(ldlt_sca, ldlt_int);
+  CHECK(lu_sca.size() == 52);
+  CHECK(ldlt_sca.isApprox(lu_sca, 1e-10));
+  CHECK(ldlt_int.isApprox(lu_int, 1e-10));
+
+  // padding with zeros up to the largest nMax
+  auto const padded = uniform_coefficients(lu_sca, 3, geometry->objects);
+  REQUIRE(padded.size() == 90);
+  CHECK(padded.segment(30, 3).isApprox(lu_sca.segment(30, 3)));
+  CHECK(padded.segment(33, 12).isZero());
+  CHECK(padded.segment(45, 3).isApprox(lu_sca.segment(33, 3)));
+  CHECK(padded.segment(48, 12).isZero());
+}
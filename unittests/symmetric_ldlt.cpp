@@ -0,0 +1,56 @@
+// (C) University College London 2017
+// This file is part of Optimet, licensed under the terms of the GNU Public License
+//
+// Optimet is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Optimet is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Optimet. If not, see <http://www.gnu.org/licenses/>.
+
+#include "catch.hpp"
+
+#include "SymmetricLDLT.h"
+#include "Types.h"
+
+using namespace optimet;
+
+TEST_CASE("Complex-symmetric LDLT") {
+  for(t_uint const n : {1, 2, 5, 32, 101})
+    for(bool const zero_diagonal : {false, true}) {
+      if(n == 1 and zero_diagonal)
+        continue;
+      Matrix<t_complex> A = Matrix<t_complex>::Random(n, n);
+      A = (A + A.transpose()).eval();
+      // forces 2x2 pivots
+      if(zero_diagonal)
+        A.diagonal().fill(0);
+      // only the lower triangle should be referenced
+      Matrix<t_complex> lower = A;
+      lower.triangularView<Eigen::StrictlyUpper>().setConstant(1e12);
+
+      SymmetricLDLT const ldlt(lower);
+      CHECK(ldlt.info() == 0);
+      Matrix<t_complex> const B = Matrix<t_complex>::Random(n, 3);
+      Matrix<t_complex> const X = ldlt.solve(B);
+      CHECK((A * X).isApprox(B, 1e-10));
+
+      // packed storage only keeps the lower triangle
+      auto const packed = PackedLower::lower_triangle(lower);
+      CHECK(packed.unpack().isApprox(Matrix<t_complex>(A.triangularView<Eigen::Lower>())));
+      CHECK(SymmetricLDLT(packed).solve(B).isApprox(X));
+    }
+}
+
+TEST_CASE("Singular complex-symmetric LDLT") {
+  Matrix<t_complex> A = Matrix<t_complex>::Zero(3, 3);
+  A(0, 0) = 1;
+  A(1, 1) = 2;
+  CHECK(SymmetricLDLT(A).info() == 3);
+}